@@ -0,0 +1,309 @@
+/**
+ * @file
+ * @brief Regresion por grupos: un ajuste por cada clave en una sola pasada
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+*/
+
+#ifndef AGRUPADA_H
+#define AGRUPADA_H
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "paralelo.h"
+#include "regresion.h"
+#include "sistemas.h"
+
+using std::span;
+using std::vector;
+using std::uint64_t;
+using std::invalid_argument;
+
+namespace regresion {
+
+    /**
+     * @brief Tabla hash plana (direccionamiento abierto, sondeo lineal) de clave a acumulador
+    */
+    class tabla_acumuladores {
+        public:
+            /**
+             * @brief Crea una tabla vacia
+             * @param capacidad_inicial Cantidad de grupos que se espera almacenar
+            */
+            explicit tabla_acumuladores(size_t capacidad_inicial = 16){
+                size_t capacidad = 16;
+                while (capacidad < 2 * capacidad_inicial){
+                    capacidad *= 2;
+                }
+                reservar(capacidad);
+            }
+
+            /**
+             * @brief Acumulador de la clave, creado si no existe
+             * @param clave Clave del grupo
+            */
+            acumulador &operator[](uint64_t clave){
+                if (2 * (cantidad + 1) > ocupado.size()){
+                    reservar(2 * ocupado.size());
+                }
+                size_t mascara = ocupado.size() - 1;
+                size_t i = dispersar(clave) & mascara;
+                while (ocupado[i]){
+                    if (claves[i] == clave){
+                        return acumuladores[i];
+                    }
+                    i = (i + 1) & mascara;
+                }
+                ocupado[i] = 1;
+                claves[i] = clave;
+                acumuladores[i] = acumulador();
+                cantidad++;
+                return acumuladores[i];
+            }
+
+            /**
+             * @brief Suma los acumuladores de otra tabla
+             * @param otra Tabla a combinar
+            */
+            void combinar(const tabla_acumuladores &otra){
+                for (size_t i = 0; i < otra.ocupado.size(); i++){
+                    if (otra.ocupado[i]){
+                        (*this)[otra.claves[i]].combinar(otra.acumuladores[i]);
+                    }
+                }
+            }
+
+            /**
+             * @brief Cantidad de grupos
+            */
+            size_t size() const {
+                return cantidad;
+            }
+
+            /**
+             * @brief Recorre los grupos en el orden interno de la tabla
+             * @param f Funcion que recibe la clave y el acumulador
+            */
+            template <typename F>
+            void para_cada(F f) const {
+                for (size_t i = 0; i < ocupado.size(); i++){
+                    if (ocupado[i]){
+                        f(claves[i], acumuladores[i]);
+                    }
+                }
+            }
+
+        private:
+            vector<unsigned char> ocupado; /*!< Indica si la casilla tiene una clave */
+            vector<uint64_t> claves; /*!< Claves */
+            vector<acumulador> acumuladores; /*!< Sumas de cada grupo */
+            size_t cantidad = 0; /*!< Cantidad de grupos */
+
+            /** @brief Mezcla de la clave (SplitMix64) */
+            static uint64_t dispersar(uint64_t z){
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                return z ^ (z >> 31);
+            }
+
+            /** @brief Cambia la capacidad (potencia de 2) y reubica los grupos */
+            void reservar(size_t capacidad){
+                vector<unsigned char> ocupado_ant;
+                vector<uint64_t> claves_ant;
+                vector<acumulador> acumuladores_ant;
+                ocupado_ant.swap(ocupado);
+                claves_ant.swap(claves);
+                acumuladores_ant.swap(acumuladores);
+
+                ocupado.assign(capacidad, 0);
+                claves.resize(capacidad);
+                acumuladores.resize(capacidad);
+                cantidad = 0;
+
+                size_t mascara = capacidad - 1;
+                for (size_t j = 0; j < ocupado_ant.size(); j++){
+                    if (ocupado_ant[j]){
+                        size_t i = dispersar(claves_ant[j]) & mascara;
+                        while (ocupado[i]){
+                            i = (i + 1) & mascara;
+                        }
+                        ocupado[i] = 1;
+                        claves[i] = claves_ant[j];
+                        acumuladores[i] = acumuladores_ant[j];
+                        cantidad++;
+                    }
+                }
+            }
+    };
+
+    /**
+     * @brief Modelo a ajustar en cada grupo
+    */
+    enum class modelo_grupo {
+        lineal,    /*!< y = b0 + b1 * x, como lineal_simple */
+        cuadratica /*!< y = a0 + a1 * x + a2 * x^2, como cuadratica */
+    };
+
+    /**
+     * @brief Resultado por columnas de la regresion por grupos, ordenado por clave
+     *
+     * Para el modelo lineal c0 = b0, c1 = b1 y c2 = 0; para el cuadratico
+     * c0 = a0, c1 = a1 y c2 = a2.
+    */
+    struct tabla_grupos {
+        modelo_grupo modelo = modelo_grupo::lineal; /*!< Modelo ajustado */
+        vector<uint64_t> clave; /*!< Clave del grupo */
+        vector<size_t> n; /*!< Numero de datos */
+        vector<double> c0; /*!< Termino independiente */
+        vector<double> c1; /*!< Coeficiente de x */
+        vector<double> c2; /*!< Coeficiente de x^2 */
+        vector<double> st; /*!< Sumatoria de la diferencia cuadratica entre el valor medido y el promedio */
+        vector<double> sy; /*!< Desviacion estandar */
+        vector<double> sr; /*!< Sumatoria de la diferencia cuadratica entre cada y con el y estimado */
+        vector<double> syx; /*!< Error estandar de aproximacion */
+        vector<double> r2; /*!< Coeficiente de determinacion */
+
+        /**
+         * @brief Cantidad de grupos
+         */
+        size_t size() const {
+            return clave.size();
+        }
+
+        /**
+         * @brief Cambia la cantidad de grupos
+         */
+        void resize(size_t tamano){
+            clave.resize(tamano);
+            n.resize(tamano);
+            c0.resize(tamano);
+            c1.resize(tamano);
+            c2.resize(tamano);
+            st.resize(tamano);
+            sy.resize(tamano);
+            sr.resize(tamano);
+            syx.resize(tamano);
+            r2.resize(tamano);
+        }
+    };
+
+    /**
+     * @brief Ajusta un modelo por cada clave distinta
+     * @param claves Clave del grupo de cada fila
+     * @param x Variable independiente de cada fila
+     * @param y Variable dependiente de cada fila
+     * @param modelo Modelo a ajustar
+     * @return Tabla de coeficientes y estadisticas, ordenada por clave
+     *
+     * Una sola pasada: las filas se dividen en un bloque contiguo por hilo
+     * y cada bloque acumula sus sumas en su propia tabla hash; las tablas se
+     * combinan una vez, en orden de bloque. La memoria es una tabla por hilo,
+     * sin importar el numero de filas. Combinar en otro orden o con otra
+     * cantidad de hilos solo cambia el redondeo de las sumas. Luego cada
+     * grupo se resuelve en paralelo a partir de sus sumas.
+    */
+    inline tabla_grupos ajustar_grupos(span<const uint64_t> claves, span<const double> x,
+                                       span<const double> y, modelo_grupo modelo = modelo_grupo::lineal){
+        if (claves.size() != x.size() || x.size() != y.size()){
+            throw invalid_argument("claves, x e y deben tener el mismo tamano");
+        }
+        const size_t filas = x.size();
+        // Con pocas filas no vale la pena repartirlas: cada bloque tiene al menos 65536
+        const size_t bloques = std::clamp<size_t>(filas / 65536, 1, paralelo::grupo_compartido().tamano());
+
+        vector<tabla_acumuladores> tablas(bloques);
+        paralelo::para_cada(bloques, [&](size_t bloque){
+            tabla_acumuladores &tabla = tablas[bloque];
+            size_t fin = filas * (bloque + 1) / bloques;
+            for (size_t i = filas * bloque / bloques; i < fin; i++){
+                tabla[claves[i]].agregar(x[i], y[i]);
+            }
+        });
+
+        tabla_acumuladores total = std::move(tablas[0]);
+        for (size_t bloque = 1; bloque < bloques; bloque++){
+            total.combinar(tablas[bloque]);
+            tablas[bloque] = tabla_acumuladores();
+        }
+
+        // Ordenar los grupos por clave
+        vector<uint64_t> orden_claves;
+        vector<const acumulador *> orden_acc;
+        orden_claves.reserve(total.size());
+        orden_acc.reserve(total.size());
+        total.para_cada([&](uint64_t clave, const acumulador &acc){
+            orden_claves.push_back(clave);
+            orden_acc.push_back(&acc);
+        });
+        vector<size_t> indices(orden_claves.size());
+        for (size_t i = 0; i < indices.size(); i++){
+            indices[i] = i;
+        }
+        std::sort(indices.begin(), indices.end(), [&](size_t a, size_t b){
+            return orden_claves[a] < orden_claves[b];
+        });
+
+        tabla_grupos res;
+        res.modelo = modelo;
+        res.resize(indices.size());
+
+        // Las ecuaciones normales cuadraticas de cada tarea se resuelven juntas en un lote intercalado
+        const size_t grupos_tarea = 1024;
+        paralelo::para_cada((indices.size() + grupos_tarea - 1) / grupos_tarea, [&](size_t tarea){
+            size_t inicio = tarea * grupos_tarea;
+            size_t fin = std::min(indices.size(), inicio + grupos_tarea);
+            size_t cantidad = fin - inicio;
+
+            vector<double> a, b;
+            if (modelo == modelo_grupo::cuadratica){
+                a.resize(9 * cantidad);
+                b.resize(3 * cantidad);
+                for (size_t g = inicio; g < fin; g++){
+                    orden_acc[indices[g]]->llenar_cuadratica(a.data(), b.data(), cantidad, g - inicio);
+                }
+                util::resolver_lote(3, cantidad, a, b);
+            }
+
+            for (size_t g = inicio; g < fin; g++){
+                const acumulador &acc = *orden_acc[indices[g]];
+                res.clave[g] = orden_claves[indices[g]];
+                res.n[g] = (size_t)acc.n;
+                if (modelo == modelo_grupo::lineal){
+                    solucion_lineal sol = acc.lineal();
+                    res.c0[g] = sol.b0;
+                    res.c1[g] = sol.b1;
+                    res.c2[g] = 0.0;
+                    res.st[g] = sol.st;
+                    res.sy[g] = sol.sy;
+                    res.sr[g] = sol.sr;
+                    res.syx[g] = sol.syx;
+                    res.r2[g] = sol.r2;
+                } else {
+                    // La regresion cuadratica se calcula con al menos 4 puntos
+                    solucion_cuadratica sol;
+                    sol.n = res.n[g];
+                    if (sol.n > 3){
+                        size_t s = g - inicio;
+                        acc.completar(sol, b[s], b[cantidad + s], b[2 * cantidad + s]);
+                    }
+                    res.c0[g] = sol.a0;
+                    res.c1[g] = sol.a1;
+                    res.c2[g] = sol.a2;
+                    res.st[g] = sol.st;
+                    res.sy[g] = sol.sy;
+                    res.sr[g] = sol.sr;
+                    res.syx[g] = sol.syx;
+                    res.r2[g] = sol.r2;
+                }
+            }
+        });
+
+        return res;
+    }
+}
+
+#endif
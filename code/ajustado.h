@@ -0,0 +1,123 @@
+/**
+ * @file
+ * @brief Modelo de interpolacion ajustado e inmutable, para evaluarlo desde varios hilos
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+*/
+
+#ifndef AJUSTADO_H
+#define AJUSTADO_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#include "lagrange.h"
+#include "newton.h"
+#include "paralelo.h"
+#include "spline3.h"
+
+using std::size_t;
+using std::span;
+using std::invalid_argument;
+
+namespace interpolacion {
+
+    /**
+     * @brief Referencia compartida a un modelo ya ajustado que no se puede modificar
+     *
+     * Solo expone las operaciones const del modelo, que no escriben en cout
+     * ni cambian su estado, asi que cualquier cantidad de hilos puede evaluar
+     * la misma instancia sin bloqueos. Copiar la referencia no copia el modelo.
+     *
+     * @tparam M spline3, newton o lagrange
+    */
+    template <typename M>
+    class ajustado {
+        public:
+            /**
+             * @brief Toma posesion de un modelo ajustado
+             * @param p_modelo Modelo; se mueve
+            */
+            explicit ajustado(M &&p_modelo) : modelo(std::make_shared<const M>(std::move(p_modelo))){
+            }
+
+            /**
+             * @brief Interpola un valor
+            */
+            double interpolar(double x_int) const {
+                return modelo->interpolar(x_int);
+            }
+
+            /**
+             * @brief Interpola un lote de valores en el hilo que llama
+             * @param x_int Valores de x a interpolar
+             * @param y_int Salida: valores interpolados, del mismo tamaño que x_int
+            */
+            void evaluar(span<const double> x_int, span<double> y_int) const {
+                modelo->evaluar(x_int, y_int);
+            }
+
+            /**
+             * @brief Interpola un lote de valores repartido entre los hilos de un grupo
+             * @param x_int Valores de x a interpolar
+             * @param y_int Salida: valores interpolados, del mismo tamaño que x_int
+             * @param grano Valores por tarea
+             * @param grupo Grupo de hilos; por defecto el compartido
+             *
+             * Las tareas son tramos contiguos de grano valores y se reparten con
+             * robo de trabajo (paralelo::para_cada_con_robo). El resultado es el
+             * mismo que el de evaluar. La aceleracion depende de los nucleos y del
+             * ancho de banda de memoria de cada maquina; no se supone, se mide con
+             * la seccion "escalamiento" de benchmark.cpp.
+            */
+            void evaluar_paralelo(span<const double> x_int, span<double> y_int, size_t grano = 4096,
+                                  paralelo::grupo_hilos &grupo = paralelo::grupo_compartido()) const {
+                if (x_int.size() != y_int.size()){
+                    throw invalid_argument("x_int e y_int deben tener el mismo tamano");
+                }
+                grano = std::max<size_t>(1, grano);
+                const size_t n = x_int.size();
+                paralelo::para_cada_con_robo(grupo, (n + grano - 1) / grano, [&](size_t tarea){
+                    size_t inicio = tarea * grano;
+                    size_t cantidad = std::min(grano, n - inicio);
+                    modelo->evaluar(x_int.subspan(inicio, cantidad), y_int.subspan(inicio, cantidad));
+                });
+            }
+
+            /**
+             * @brief Modelo ajustado, solo lectura
+            */
+            const M &operator*() const {
+                return *modelo;
+            }
+
+            /**
+             * @brief Modelo ajustado, solo lectura
+            */
+            const M *operator->() const {
+                return modelo.get();
+            }
+
+        private:
+            std::shared_ptr<const M> modelo; /*!< Modelo compartido */
+    };
+
+    /**
+     * @brief Ajusta un modelo y retorna su referencia inmutable
+     * @param args Argumentos del constructor del modelo
+    */
+    template <typename M, typename... A>
+    ajustado<M> ajustar(A &&...args){
+        return ajustado<M>(M(std::forward<A>(args)...));
+    }
+
+    using spline3_ajustado = ajustado<spline3>; /*!< Trazador cubico ajustado */
+    using newton_ajustado = ajustado<newton>; /*!< Polinomio de Newton ajustado */
+    using lagrange_ajustado = ajustado<lagrange>; /*!< Polinomio de Lagrange ajustado */
+}
+
+#endif
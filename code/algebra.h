@@ -0,0 +1,426 @@
+/**
+ * @file
+ * @brief Matriz densa contigua y factorizacion LU con pivoteo parcial
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+*/
+
+#ifndef ALGEBRA_H
+#define ALGEBRA_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "arena.h"
+
+using std::size_t;
+using std::span;
+using std::vector;
+using std::invalid_argument;
+
+namespace util {
+
+    /**
+     * @brief Matriz densa de reales almacenada por filas en un solo bloque de memoria
+    */
+    class matriz {
+        public:
+            /**
+             * @brief Crea una matriz de ceros
+             * @param p_filas Numero de filas
+             * @param p_columnas Numero de columnas
+            */
+            matriz(size_t p_filas = 0, size_t p_columnas = 0)
+                : n_filas(p_filas), n_columnas(p_columnas), datos(p_filas * p_columnas, 0.0){
+            }
+
+            /** @brief Elemento (i, j) */
+            double &operator()(size_t i, size_t j){
+                return datos[i * n_columnas + j];
+            }
+
+            /** @brief Elemento (i, j) */
+            double operator()(size_t i, size_t j) const {
+                return datos[i * n_columnas + j];
+            }
+
+            /** @brief Inicio de la fila i */
+            double *fila(size_t i){
+                return datos.data() + i * n_columnas;
+            }
+
+            /** @brief Inicio de la fila i */
+            const double *fila(size_t i) const {
+                return datos.data() + i * n_columnas;
+            }
+
+            /** @brief Numero de filas */
+            size_t filas() const {
+                return n_filas;
+            }
+
+            /** @brief Numero de columnas */
+            size_t columnas() const {
+                return n_columnas;
+            }
+
+            /** @brief Todos los elementos, por filas */
+            span<double> elementos(){
+                return datos;
+            }
+
+            /** @brief Todos los elementos, por filas */
+            span<const double> elementos() const {
+                return datos;
+            }
+
+        private:
+            size_t n_filas; /*!< Numero de filas */
+            size_t n_columnas; /*!< Numero de columnas */
+            vector<double> datos; /*!< Elementos por filas */
+    };
+
+    /**
+     * @brief Factoriza en sitio P A = L U con pivoteo parcial, por bloques
+     * @param a Matriz n x n por filas; al terminar contiene L (sin la diagonal unitaria) y U
+     * @param n Orden de la matriz
+     * @param pivotes Salida de n elementos: en el paso k se intercambio la fila k con pivotes[k]
+     * @return false si algun pivote fue cero (matriz singular)
+     *
+     * Se usa la variante por bloques hacia la derecha: cada panel de BLOQUE
+     * columnas se factoriza con pivoteo parcial, luego se resuelve el bloque
+     * de U a su derecha y se actualiza el resto de la matriz con un producto
+     * de matrices recorrido por filas, que se mantiene en cache.
+    */
+    inline bool lu_en_sitio(span<double> a, size_t n, span<size_t> pivotes){
+        if (a.size() != n * n || pivotes.size() != n){
+            throw invalid_argument("Tamano invalido para la factorizacion LU");
+        }
+        const size_t BLOQUE = 48;
+        double *m = a.data();
+        bool regular = true;
+
+        for (size_t k0 = 0; k0 < n; k0 += BLOQUE){
+            const size_t k1 = std::min(n, k0 + BLOQUE);
+
+            // Factorizar el panel de columnas [k0, k1) con pivoteo parcial
+            for (size_t k = k0; k < k1; k++){
+                size_t p = k;
+                double maximo = std::fabs(m[k * n + k]);
+                for (size_t i = k + 1; i < n; i++){
+                    double v = std::fabs(m[i * n + k]);
+                    if (v > maximo){
+                        maximo = v;
+                        p = i;
+                    }
+                }
+                pivotes[k] = p;
+                if (p != k){
+                    std::swap_ranges(m + k * n, m + (k + 1) * n, m + p * n);
+                }
+                if (maximo == 0.0){
+                    regular = false;
+                    continue;
+                }
+
+                double inverso = 1.0 / m[k * n + k];
+                for (size_t i = k + 1; i < n; i++){
+                    double *fila_i = m + i * n;
+                    double l = fila_i[k] * inverso;
+                    fila_i[k] = l;
+                    const double *fila_k = m + k * n;
+                    for (size_t j = k + 1; j < k1; j++){
+                        fila_i[j] -= l * fila_k[j];
+                    }
+                }
+            }
+
+            if (k1 == n){
+                break;
+            }
+
+            // U12 = L11^-1 A12
+            for (size_t k = k0; k < k1; k++){
+                const double *fila_k = m + k * n;
+                for (size_t i = k + 1; i < k1; i++){
+                    double *fila_i = m + i * n;
+                    double l = fila_i[k];
+                    for (size_t j = k1; j < n; j++){
+                        fila_i[j] -= l * fila_k[j];
+                    }
+                }
+            }
+
+            // A22 = A22 - L21 U12
+            for (size_t i = k1; i < n; i++){
+                double *fila_i = m + i * n;
+                for (size_t k = k0; k < k1; k++){
+                    double l = fila_i[k];
+                    const double *fila_k = m + k * n;
+                    for (size_t j = k1; j < n; j++){
+                        fila_i[j] -= l * fila_k[j];
+                    }
+                }
+            }
+        }
+        return regular;
+    }
+
+    /**
+     * @brief Resuelve A x = b en O(n^2) con una factorizacion de lu_en_sitio
+     * @param lu L y U por filas, como las deja lu_en_sitio
+     * @param n Orden de la matriz
+     * @param pivotes Intercambios de filas de lu_en_sitio
+     * @param b Lado derecho; al terminar contiene la solucion
+    */
+    inline void resolver_lu(span<const double> lu, size_t n, span<const size_t> pivotes, span<double> b){
+        for (size_t k = 0; k < n; k++){
+            if (pivotes[k] != k){
+                std::swap(b[k], b[pivotes[k]]);
+            }
+        }
+        // L z = P b
+        for (size_t i = 0; i < n; i++){
+            const double *fila = lu.data() + i * n;
+            double v = b[i];
+            for (size_t j = 0; j < i; j++){
+                v -= fila[j] * b[j];
+            }
+            b[i] = v;
+        }
+        // U x = z
+        for (size_t i = n; i-- > 0;){
+            const double *fila = lu.data() + i * n;
+            double v = b[i];
+            for (size_t j = i + 1; j < n; j++){
+                v -= fila[j] * b[j];
+            }
+            b[i] = v / fila[i];
+        }
+    }
+
+    /**
+     * @brief Resuelve A x = b en sitio, con los pivotes tomados de util::temporales()
+     * @param a Matriz n x n por filas; al terminar contiene su factorizacion LU
+     * @param n Orden del sistema
+     * @param b Lado derecho; al terminar contiene la solucion
+     * @return false si la matriz es singular (b queda sin resolver)
+    */
+    inline bool resolver_en_sitio(span<double> a, size_t n, span<double> b){
+        if (b.size() != n){
+            throw invalid_argument("El lado derecho no coincide con el orden de la matriz");
+        }
+        std::pmr::vector<size_t> pivotes(n, temporales());
+        if (!lu_en_sitio(a, n, pivotes)){
+            return false;
+        }
+        resolver_lu(a, n, pivotes, b);
+        return true;
+    }
+
+    /**
+     * @brief Resuelve en O(n) un sistema tridiagonal diagonalmente dominante (algoritmo de Thomas)
+     * @param inferior Subdiagonal: inferior[i] multiplica x[i - 1]; inferior[0] no se usa
+     * @param diagonal Diagonal; se modifica
+     * @param superior Superdiagonal: superior[i] multiplica x[i + 1]; superior[n - 1] no se usa
+     * @param b Lado derecho; al terminar contiene la solucion
+     * @note Sin pivoteo: estable si la diagonal domina, como en los trazadores cubicos
+    */
+    inline void resolver_tridiagonal(span<const double> inferior, span<double> diagonal,
+                                     span<const double> superior, span<double> b){
+        const size_t n = b.size();
+        if (inferior.size() != n || diagonal.size() != n || superior.size() != n){
+            throw invalid_argument("Las diagonales no coinciden con el orden del sistema");
+        }
+        for (size_t i = 1; i < n; i++){
+            double w = inferior[i] / diagonal[i - 1];
+            diagonal[i] -= w * superior[i - 1];
+            b[i] -= w * b[i - 1];
+        }
+        for (size_t i = n; i-- > 0;){
+            double v = b[i];
+            if (i + 1 < n){
+                v -= superior[i] * b[i + 1];
+            }
+            b[i] = v / diagonal[i];
+        }
+    }
+
+    /**
+     * @brief Eliminacion de Thomas de un sistema tridiagonal, reutilizable para varios lados derechos
+     *
+     * Es la misma eliminacion de resolver_tridiagonal, hecha una vez: con la
+     * malla fija, el sistema del trazador cubico solo cambia en el lado derecho.
+    */
+    class factorizacion_tridiagonal {
+        public:
+            factorizacion_tridiagonal() = default;
+
+            /**
+             * @brief Elimina la subdiagonal
+             * @param inferior Subdiagonal: inferior[i] multiplica x[i - 1]; inferior[0] no se usa
+             * @param diagonal Diagonal
+             * @param superior Superdiagonal: superior[i] multiplica x[i + 1]; superior[n - 1] no se usa
+            */
+            factorizacion_tridiagonal(span<const double> inferior, span<const double> diagonal, span<const double> superior)
+                : factores(diagonal.size()), pivotes(diagonal.begin(), diagonal.end()), superiores(superior.begin(), superior.end()){
+                const size_t n = diagonal.size();
+                if (inferior.size() != n || superior.size() != n){
+                    throw invalid_argument("Las diagonales no coinciden con el orden del sistema");
+                }
+                for (size_t i = 1; i < n; i++){
+                    factores[i] = inferior[i] / pivotes[i - 1];
+                    pivotes[i] -= factores[i] * superiores[i - 1];
+                }
+            }
+
+            /** @brief Orden del sistema */
+            size_t orden() const {
+                return pivotes.size();
+            }
+
+            /**
+             * @brief Resuelve el sistema para un lado derecho
+             * @param b Lado derecho de orden() elementos; al terminar contiene la solucion
+            */
+            void resolver(span<double> b) const {
+                const size_t n = orden();
+                if (b.size() != n){
+                    throw invalid_argument("El lado derecho no coincide con el orden del sistema");
+                }
+                for (size_t i = 1; i < n; i++){
+                    b[i] -= factores[i] * b[i - 1];
+                }
+                for (size_t i = n; i-- > 0;){
+                    double v = b[i];
+                    if (i + 1 < n){
+                        v -= superiores[i] * b[i + 1];
+                    }
+                    b[i] = v / pivotes[i];
+                }
+            }
+
+            /**
+             * @brief Resuelve el sistema para varias columnas de una matriz guardada por filas
+             * @param b Matriz de orden() filas y ancho columnas; cada columna es un lado derecho
+             * @param ancho Columnas de la matriz
+             * @param primera Primera columna a resolver
+             * @param cuantas Columnas a resolver
+             *
+             * Recorre la matriz fila por fila: cada paso es una operacion sobre
+             * filas contiguas, que el compilador vectoriza.
+            */
+            void resolver_columnas(span<double> b, size_t ancho, size_t primera, size_t cuantas) const {
+                const size_t n = orden();
+                if (b.size() != n * ancho || primera + cuantas > ancho){
+                    throw invalid_argument("El lado derecho no coincide con el orden del sistema");
+                }
+                for (size_t i = 1; i < n; i++){
+                    double *fila = b.data() + i * ancho + primera;
+                    const double *anterior = fila - ancho;
+                    const double w = factores[i];
+                    for (size_t j = 0; j < cuantas; j++){
+                        fila[j] -= w * anterior[j];
+                    }
+                }
+                for (size_t i = n; i-- > 0;){
+                    double *fila = b.data() + i * ancho + primera;
+                    const double s = (i + 1 < n) ? superiores[i] : 0.0;
+                    const double *siguiente = (i + 1 < n) ? fila + ancho : fila;
+                    const double p = pivotes[i];
+                    for (size_t j = 0; j < cuantas; j++){
+                        fila[j] = (fila[j] - s * siguiente[j]) / p;
+                    }
+                }
+            }
+
+        private:
+            vector<double> factores; /*!< Multiplicador de la fila anterior en cada fila */
+            vector<double> pivotes; /*!< Diagonal tras la eliminacion */
+            vector<double> superiores; /*!< Superdiagonal */
+    };
+
+    /**
+     * @brief Factorizacion P A = L U reutilizable para resolver varios lados derechos
+    */
+    class factorizacion_lu {
+        public:
+            /**
+             * @brief Factoriza la matriz; si se pasa con std::move no se copia
+             * @param p_a Matriz cuadrada
+            */
+            explicit factorizacion_lu(matriz p_a) : lu(std::move(p_a)), pivotes(lu.filas()){
+                if (lu.filas() != lu.columnas()){
+                    throw invalid_argument("La matriz debe ser cuadrada");
+                }
+                regular = lu_en_sitio(lu.elementos(), lu.filas(), pivotes);
+            }
+
+            /**
+             * @brief Indica si la matriz es singular
+            */
+            bool singular() const {
+                return !regular;
+            }
+
+            /**
+             * @brief Orden de la matriz
+            */
+            size_t orden() const {
+                return lu.filas();
+            }
+
+            /**
+             * @brief Resuelve A x = b en O(n^2)
+             * @param b Lado derecho; al terminar contiene la solucion
+            */
+            void resolver(span<double> b) const {
+                const size_t n = lu.filas();
+                if (b.size() != n){
+                    throw invalid_argument("El lado derecho no coincide con el orden de la matriz");
+                }
+                if (!regular){
+                    throw invalid_argument("La matriz es singular");
+                }
+                resolver_lu(lu.elementos(), n, pivotes, b);
+            }
+
+            /**
+             * @brief Resuelve A x = b en O(n^2)
+             * @param b Lado derecho
+             * @return Solucion x
+            */
+            vector<double> resolver_copia(span<const double> b) const {
+                vector<double> x(b.begin(), b.end());
+                resolver(x);
+                return x;
+            }
+
+            /**
+             * @brief Determinante de A
+            */
+            double determinante() const {
+                double det = 1.0;
+                for (size_t k = 0; k < lu.filas(); k++){
+                    det *= lu(k, k);
+                    if (pivotes[k] != k){
+                        det = -det;
+                    }
+                }
+                return det;
+            }
+
+        private:
+            matriz lu; /*!< L y U en el mismo arreglo */
+            vector<size_t> pivotes; /*!< Intercambios de filas */
+            bool regular = true; /*!< La matriz no es singular */
+    };
+}
+
+#endif
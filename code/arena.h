@@ -0,0 +1,167 @@
+/**
+ * @file
+ * @brief Arena para los arreglos temporales de los ajustes
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Los ajustes (el sistema del trazador cubico, las diferencias divididas,
+ * los datos linealizados de las regresiones potencia y exponencial) piden
+ * sus arreglos temporales a util::temporales(). Fuera de un usar_temporales
+ * es el asignador global. Dentro, es el recurso indicado, normalmente una
+ * arena: reservar solo avanza un puntero, liberar no hace nada, y al
+ * terminar un lote de ajustes reiniciar() la deja vacia en O(1) conservando
+ * sus bloques, asi que el siguiente lote no vuelve a pedir memoria.
+ *
+ * @code
+ * util::arena arena;
+ * for (auto &lote : lotes){
+ *     util::usar_temporales uso(arena);
+ *     ajustar(lote);
+ *     arena.reiniciar();
+ * }
+ * @endcode
+*/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+using std::size_t;
+using std::vector;
+
+namespace util {
+
+    /**
+     * @brief Recurso de memoria que reserva avanzando un puntero sobre bloques propios
+     *
+     * No es seguro entre hilos: cada hilo usa su propia arena.
+    */
+    class arena : public std::pmr::memory_resource {
+        public:
+            /**
+             * @brief Crea una arena vacia; el primer bloque se reserva con el primer uso
+             * @param p_capacidad_inicial Bytes del primer bloque; cada bloque nuevo duplica el anterior
+            */
+            explicit arena(size_t p_capacidad_inicial = 1 << 16)
+                : capacidad_inicial(std::max<size_t>(p_capacidad_inicial, 64)){
+            }
+
+            arena(const arena &) = delete;
+            arena &operator=(const arena &) = delete;
+
+            ~arena(){
+                for (const bloque &b : bloques){
+                    std::pmr::new_delete_resource()->deallocate(b.inicio, b.tamano, alignof(std::max_align_t));
+                }
+            }
+
+            /**
+             * @brief Libera en O(1) todo lo reservado, sin devolver los bloques
+            */
+            void reiniciar(){
+                actual = 0;
+                usado = 0;
+            }
+
+            /** @brief Bytes pedidos al asignador global */
+            size_t capacidad() const {
+                size_t total = 0;
+                for (const bloque &b : bloques){
+                    total += b.tamano;
+                }
+                return total;
+            }
+
+            /** @brief Veces que se pidio un bloque al asignador global */
+            size_t reservas() const {
+                return bloques.size();
+            }
+
+        private:
+            /** @brief Bloque pedido al asignador global */
+            struct bloque {
+                std::byte *inicio; /*!< Primer byte */
+                size_t tamano; /*!< Bytes del bloque */
+            };
+
+            size_t capacidad_inicial; /*!< Bytes del primer bloque */
+            vector<bloque> bloques; /*!< Bloques en el orden en que se pidieron */
+            size_t actual = 0; /*!< Bloque en uso */
+            size_t usado = 0; /*!< Bytes ocupados del bloque en uso */
+
+            void *do_allocate(size_t bytes, size_t alineacion) override {
+                while (true){
+                    if (actual < bloques.size()){
+                        const bloque &b = bloques[actual];
+                        std::uintptr_t base = (std::uintptr_t)b.inicio;
+                        std::uintptr_t p = (base + usado + alineacion - 1) & ~(std::uintptr_t)(alineacion - 1);
+                        if (p + bytes <= base + b.tamano){
+                            usado = (size_t)(p + bytes - base);
+                            return (void *)p;
+                        }
+                        // No cabe: pasar al siguiente bloque ya reservado, o pedir uno nuevo
+                        actual++;
+                        usado = 0;
+                        continue;
+                    }
+                    size_t tamano = bloques.empty() ? capacidad_inicial : 2 * bloques.back().tamano;
+                    tamano = std::max(tamano, bytes + alineacion);
+                    void *inicio = std::pmr::new_delete_resource()->allocate(tamano, alignof(std::max_align_t));
+                    bloques.push_back(bloque{(std::byte *)inicio, tamano});
+                }
+            }
+
+            void do_deallocate(void *, size_t, size_t) override {
+            }
+
+            bool do_is_equal(const std::pmr::memory_resource &otro) const noexcept override {
+                return this == &otro;
+            }
+    };
+
+    /** @brief Recurso de los temporales del hilo actual; nullptr para el asignador global */
+    inline std::pmr::memory_resource *&recurso_temporales(){
+        thread_local std::pmr::memory_resource *recurso = nullptr;
+        return recurso;
+    }
+
+    /**
+     * @brief Recurso del que los ajustes toman sus arreglos temporales en este hilo
+    */
+    inline std::pmr::memory_resource *temporales(){
+        std::pmr::memory_resource *recurso = recurso_temporales();
+        return (recurso != nullptr) ? recurso : std::pmr::new_delete_resource();
+    }
+
+    /**
+     * @brief Usa un recurso para los temporales de los ajustes de este hilo mientras exista
+     *
+     * Se puede anidar; al destruirse restaura el recurso anterior.
+    */
+    class usar_temporales {
+        public:
+            /**
+             * @param recurso Recurso, por ejemplo una arena; debe existir mientras exista el objeto
+            */
+            explicit usar_temporales(std::pmr::memory_resource &recurso) : anterior(recurso_temporales()){
+                recurso_temporales() = &recurso;
+            }
+
+            usar_temporales(const usar_temporales &) = delete;
+            usar_temporales &operator=(const usar_temporales &) = delete;
+
+            ~usar_temporales(){
+                recurso_temporales() = anterior;
+            }
+
+        private:
+            std::pmr::memory_resource *anterior; /*!< Recurso a restaurar */
+    };
+}
+
+#endif
@@ -0,0 +1,363 @@
+/**
+ * @file
+ * @brief Microbenchmarks de construccion y consulta de cada metodo numerico
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Uso: benchmark [n_max] [tiempo_minimo_ms]
+ *
+ * Mide el costo de construir cada modelo y de cada consulta (interpolar o
+ * predecir un punto) para tamaños de 10 a n_max (por defecto 10^6) sobre
+ * mallas uniforme, agrupada y aleatoria. Cada medicion repite la operacion,
+ * duplicando las repeticiones, hasta superar tiempo_minimo_ms. El resultado
+ * se escribe en JSON por la salida estandar: ns/op, asignaciones/op y
+ * bytes/op, contados reemplazando el operator new global.
+ *
+ * Los metodos de costo cubico o cuadratico por consulta se limitan a los
+ * tamaños indicados en "limites".
+ *
+ * La seccion "escalamiento" mide evaluar_paralelo de un trazador cubico
+ * ajustado sobre 2^22 consultas con 1, 2, 4, ... hilos, hasta los que
+ * reporta std::thread::hardware_concurrency, y la aceleracion respecto a 1.
+ * La aceleracion solo se puede juzgar en una maquina con varios nucleos:
+ * con un solo hilo disponible la seccion tiene un unico punto y no dice
+ * nada del escalamiento, y se avisa por la salida de error.
+ *
+ * Compilar con optimizaciones, por ejemplo:
+ * g++ -std=c++20 -O3 -fno-trapping-math -DNDEBUG -pthread benchmark.cpp -o benchmark
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ajustado.h"
+#include "cubica_local.h"
+#include "instrumentacion.h"
+#include "lagrange.h"
+#include "newton.h"
+#include "paralelo.h"
+#include "regresion.h"
+#include "remuestreo.h"
+#include "spline3.h"
+#include "tabla_uniforme.h"
+#include "util.h"
+
+using std::cout;
+using std::endl;
+using std::span;
+using std::string;
+using std::vector;
+
+namespace {
+    std::atomic<size_t> asignaciones{0}; /*!< Llamadas a operator new */
+    std::atomic<size_t> bytes_asignados{0}; /*!< Bytes pedidos a operator new */
+    volatile double sumidero = 0.0; /*!< Evita que el compilador elimine las operaciones medidas */
+}
+
+/** @brief Suma una asignacion a las cuentas del benchmark */
+static void contar_asignacion(std::size_t tamano){
+    asignaciones.fetch_add(1, std::memory_order_relaxed);
+    bytes_asignados.fetch_add(tamano, std::memory_order_relaxed);
+}
+
+// std::pmr::new_delete_resource (los temporales de los ajustes fuera de una arena) usa la version alineada
+INSTRUMENTACION_REEMPLAZAR_NEW_CON(contar_asignacion);
+
+/**
+ * @brief Resultado de una medicion
+*/
+struct medicion {
+    double ns_op = 0.0; /*!< Nanosegundos por operacion */
+    double asignaciones_op = 0.0; /*!< Asignaciones de memoria por operacion */
+    double bytes_op = 0.0; /*!< Bytes asignados por operacion */
+    size_t repeticiones = 0; /*!< Operaciones de la ultima ronda */
+};
+
+/**
+ * @brief Mide f(i) para i = 0, 1, ..., duplicando las repeticiones hasta superar el tiempo minimo
+ * @param f Operacion a medir; recibe el numero de repeticion
+ * @param tiempo_minimo_ns Duracion minima de la ronda que se reporta
+ * @return Promedios de la ultima ronda
+*/
+template <typename F>
+medicion medir(F f, double tiempo_minimo_ns){
+    using reloj = std::chrono::steady_clock;
+    medicion m;
+    for (size_t repeticiones = 1;; repeticiones *= 2){
+        size_t asignaciones_ini = asignaciones.load(std::memory_order_relaxed);
+        size_t bytes_ini = bytes_asignados.load(std::memory_order_relaxed);
+        auto inicio = reloj::now();
+        for (size_t i = 0; i < repeticiones; i++){
+            f(i);
+        }
+        double ns = std::chrono::duration<double, std::nano>(reloj::now() - inicio).count();
+        m.repeticiones = repeticiones;
+        m.ns_op = ns / (double)repeticiones;
+        m.asignaciones_op = (double)(asignaciones.load(std::memory_order_relaxed) - asignaciones_ini) / (double)repeticiones;
+        m.bytes_op = (double)(bytes_asignados.load(std::memory_order_relaxed) - bytes_ini) / (double)repeticiones;
+        if (ns >= tiempo_minimo_ns){
+            return m;
+        }
+    }
+}
+
+/**
+ * @brief Genera n abscisas estrictamente crecientes en [1, 11]
+ * @param tipo "uniforme", "agrupada" (puntos concentrados en 8 grupos) o "aleatoria"
+ * @param n Numero de puntos
+ * @param semilla Semilla del generador
+*/
+vector<double> generar_malla(const string &tipo, size_t n, uint64_t semilla){
+    vector<double> x(n);
+    std::mt19937_64 gen(semilla);
+    std::uniform_real_distribution<double> uniforme(0.0, 1.0);
+
+    if (tipo == "uniforme"){
+        for (size_t i = 0; i < n; i++){
+            x[i] = 1.0 + 10.0 * (double)i / (double)(n - 1);
+        }
+        return x;
+    }
+
+    if (tipo == "agrupada"){
+        const size_t grupos = 8;
+        std::normal_distribution<double> normal(0.0, 0.01);
+        for (size_t i = 0; i < n; i++){
+            double centro = ((double)(i % grupos) + 0.5) / (double)grupos;
+            x[i] = std::clamp(centro + normal(gen), 0.0, 1.0);
+        }
+    } else {
+        for (size_t i = 0; i < n; i++){
+            x[i] = uniforme(gen);
+        }
+    }
+
+    // Ordenar y separar los puntos repetidos para que la malla sea estrictamente creciente
+    std::sort(x.begin(), x.end());
+    for (size_t i = 0; i < n; i++){
+        x[i] = 1.0 + 10.0 * x[i];
+        if (i > 0 && x[i] <= x[i - 1]){
+            x[i] = std::nextafter(x[i - 1], INFINITY);
+        }
+    }
+    return x;
+}
+
+/**
+ * @brief Escribe una medicion como objeto JSON
+*/
+void escribir(bool &primero, const string &metodo, const string &malla, size_t n,
+              const string &fase, const medicion &m){
+    cout << (primero ? "\n" : ",\n")
+         << "    {\"metodo\": \"" << metodo << "\", \"malla\": \"" << malla
+         << "\", \"n\": " << n << ", \"fase\": \"" << fase
+         << "\", \"ns_op\": " << m.ns_op
+         << ", \"asignaciones_op\": " << m.asignaciones_op
+         << ", \"bytes_op\": " << m.bytes_op
+         << ", \"repeticiones\": " << m.repeticiones << "}";
+    primero = false;
+}
+
+int main(int argc, char *argv[]){
+    size_t n_max = (argc > 1) ? (size_t)std::strtoull(argv[1], nullptr, 10) : 1000000;
+    double tiempo_minimo_ns = 1e6 * ((argc > 2) ? std::strtod(argv[2], nullptr) : 50.0);
+
+    // Tamaños maximos de los metodos con costo superlineal
+    const size_t limite_newton = 1000;    // O(n^2) al construir y al consultar
+    const size_t limite_lagrange = 1000;  // O(n^2) al consultar
+    const size_t limite_gauss = 1000;     // O(n^3)
+    const size_t limite_tabla = 1000;     // Con datos con ruido, el error de 1e-6 pide mas celdas al crecer n
+
+    const size_t consultas = 1024;
+    const string mallas[] = {"uniforme", "agrupada", "aleatoria"};
+
+    cout.precision(6);
+    cout << "{\n  \"compilador\": \"" << __VERSION__ << "\",\n"
+#ifdef __OPTIMIZE__
+         << "  \"optimizado\": true,\n"
+#else
+         << "  \"optimizado\": false,\n"
+#endif
+         << "  \"tiempo_minimo_ms\": " << tiempo_minimo_ns / 1e6 << ",\n"
+         << "  \"limites\": {\"newton\": " << limite_newton
+         << ", \"lagrange\": " << limite_lagrange << ", \"gauss\": " << limite_gauss
+         << ", \"tabla_uniforme\": " << limite_tabla << "},\n"
+         << "  \"resultados\": [";
+
+    bool primero = true;
+    for (size_t n = 10; n <= n_max; n *= 10){
+        for (const string &malla : mallas){
+            vector<double> x = generar_malla(malla, n, 20231106 + n);
+            vector<double> y(n);
+            std::mt19937_64 gen(n);
+            std::uniform_real_distribution<double> ruido(0.99, 1.01);
+            for (size_t i = 0; i < n; i++){
+                y[i] = std::exp(0.3 * x[i]) * ruido(gen);
+            }
+
+            // Puntos de consulta dentro del rango de los datos, en orden aleatorio
+            vector<double> q(consultas);
+            std::uniform_real_distribution<double> rango(x.front(), x.back());
+            for (double &v : q){
+                v = rango(gen);
+            }
+            vector<double> salida(consultas);
+
+            auto interpolante = [&](const string &nombre, auto construir){
+                escribir(primero, nombre, malla, n, "construccion", medir([&](size_t){
+                    auto modelo = construir();
+                    sumidero = sumidero + modelo.interpolar(x[0]);
+                }, tiempo_minimo_ns));
+                auto modelo = construir();
+                escribir(primero, nombre, malla, n, "consulta", medir([&](size_t i){
+                    sumidero = sumidero + modelo.interpolar(q[i % consultas]);
+                }, tiempo_minimo_ns));
+            };
+
+            auto ajuste = [&](const string &nombre, auto construir){
+                escribir(primero, nombre, malla, n, "construccion", medir([&](size_t){
+                    auto sol = construir().calcular();
+                    double p;
+                    sol.predecir(span<const double>(x.data(), 1), span<double>(&p, 1));
+                    sumidero = sumidero + p;
+                }, tiempo_minimo_ns));
+                auto sol = construir().calcular();
+                medicion m = medir([&](size_t){
+                    sol.predecir(q, salida);
+                    sumidero = sumidero + salida[0];
+                }, tiempo_minimo_ns);
+                m.ns_op /= (double)consultas;
+                m.asignaciones_op /= (double)consultas;
+                m.bytes_op /= (double)consultas;
+                escribir(primero, nombre, malla, n, "consulta", m);
+            };
+
+            if (n <= limite_newton){
+                interpolante("newton", [&]{ return interpolacion::newton(util::prestado, x, y); });
+            }
+            if (n <= limite_lagrange){
+                interpolante("lagrange", [&]{ return interpolacion::lagrange(util::prestado, x, y); });
+            }
+            {
+                interpolante("spline3", [&]{ return interpolacion::spline3(util::prestado, x, y); });
+
+                // Recorrido ordenado con un cursor, como al graficar
+                interpolacion::spline3 trazador(util::prestado, x, y);
+                interpolacion::spline3::cursor cursor = trazador.crear_cursor();
+                const double paso = (x.back() - x.front()) / (double)consultas;
+                escribir(primero, "spline3", malla, n, "barrido", medir([&](size_t i){
+                    sumidero = sumidero + cursor(x.front() + paso * (double)(i % consultas));
+                }, tiempo_minimo_ns));
+
+                // Tabla uniforme compilada con error de 1e-6: consulta sin busqueda
+                if (n <= limite_tabla){
+                    interpolacion::tabla_uniforme tabla = interpolacion::compilar(trazador, 1e-6);
+                    escribir(primero, "tabla_uniforme", malla, n, "consulta", medir([&](size_t i){
+                        sumidero = sumidero + tabla.interpolar(q[i % consultas]);
+                    }, tiempo_minimo_ns));
+                }
+            }
+
+            // Cubicas locales: sin sistema, ajuste O(n) para cualquier n
+            interpolante("pchip", [&]{ return interpolacion::pchip(util::prestado, x, y); });
+            interpolante("akima", [&]{ return interpolacion::akima(util::prestado, x, y); });
+
+            {
+                // Remuestreo con trazador cubico sobre una malla uniforme: ajuste y recorrido juntos
+                remuestreo::malla_uniforme uniforme{x.front(), (x.back() - x.front()) / (double)(consultas - 1)};
+                medicion m = medir([&](size_t){
+                    remuestreo::remuestrear(x, y, uniforme, salida, remuestreo::metodo::spline3);
+                    sumidero = sumidero + salida[0];
+                }, tiempo_minimo_ns);
+                m.ns_op /= (double)consultas;
+                m.asignaciones_op /= (double)consultas;
+                m.bytes_op /= (double)consultas;
+                escribir(primero, "remuestreo_spline3", malla, n, "remuestreo", m);
+            }
+
+            ajuste("lineal_simple", [&]{ return regresion::lineal_simple(util::prestado, x, y); });
+            ajuste("potencia", [&]{ return regresion::potencia(util::prestado, x, y); });
+            ajuste("exponencial", [&]{ return regresion::exponencial(util::prestado, x, y); });
+            ajuste("cuadratica", [&]{ return regresion::cuadratica(util::prestado, x, y); });
+
+            if (n <= limite_gauss){
+                // Sistema denso diagonalmente dominante que depende de la malla
+                vector<vector<double>> m(n, vector<double>(n + 1));
+                for (size_t i = 0; i < n; i++){
+                    for (size_t j = 0; j < n; j++){
+                        m[i][j] = 1.0 / (1.0 + std::fabs(x[i] - x[j]));
+                    }
+                    m[i][i] += (double)n;
+                    m[i][n] = y[i];
+                }
+                escribir(primero, "gauss", malla, n, "resolucion", medir([&](size_t){
+                    vector<double> s = util::gauss(m);
+                    sumidero = sumidero + s[0];
+                }, tiempo_minimo_ns));
+            }
+        }
+    }
+
+    cout << "\n  ],\n  \"escalamiento\": [";
+
+    {
+        // Un solo modelo compartido, evaluado sin bloqueos desde grupos de distinto tamaño
+        const size_t n = 1000;
+        const size_t n_consultas = 1 << 22;
+        vector<double> x = generar_malla("uniforme", n, 1);
+        vector<double> y(n);
+        for (size_t i = 0; i < n; i++){
+            y[i] = std::exp(0.3 * x[i]);
+        }
+        auto modelo = interpolacion::ajustar<interpolacion::spline3>(std::move(x), std::move(y));
+        vector<double> q(n_consultas), salida(n_consultas);
+        std::mt19937_64 gen(n_consultas);
+        std::uniform_real_distribution<double> rango(1.0, 11.0);
+        for (double &v : q){
+            v = rango(gen);
+        }
+        std::sort(q.begin(), q.end());
+
+        // 1, 2, 4, ... y el total de hilos disponibles
+        size_t maximo = std::max(1u, std::thread::hardware_concurrency());
+        vector<size_t> tamanos;
+        for (size_t hilos = 1; hilos < maximo; hilos *= 2){
+            tamanos.push_back(hilos);
+        }
+        tamanos.push_back(maximo);
+        if (maximo == 1){
+            std::cerr << "Solo hay un hilo disponible: \"escalamiento\" no mide la aceleracion" << endl;
+        }
+
+        double ns_un_hilo = 0.0;
+        for (size_t hilos : tamanos){
+            paralelo::grupo_hilos grupo(hilos);
+            medicion m = medir([&](size_t){
+                modelo.evaluar_paralelo(q, salida, 4096, grupo);
+                sumidero = sumidero + salida[0];
+            }, tiempo_minimo_ns);
+            double ns_punto = m.ns_op / (double)n_consultas;
+            if (hilos == 1){
+                ns_un_hilo = ns_punto;
+            }
+            cout << (hilos == 1 ? "\n" : ",\n") << "    {\"metodo\": \"spline3\", \"n\": " << n
+                 << ", \"consultas\": " << n_consultas << ", \"hilos\": " << hilos
+                 << ", \"ns_punto\": " << ns_punto << ", \"aceleracion\": " << ns_un_hilo / ns_punto << "}";
+        }
+    }
+
+    cout << "\n  ]\n}" << endl;
+    return 0;
+}
@@ -0,0 +1,387 @@
+/**
+ * @file
+ * @brief Formato binario de datos y modelos ajustados, para cargarlos mapeados en memoria
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Un archivo es un encabezado de 128 bytes seguido de hasta 4 columnas de
+ * reales de 64 bits, todo little-endian. Cada columna empieza en un
+ * desplazamiento multiplo de 64, asi que mapeada en memoria ya es un
+ * arreglo de double alineado y se usa sin leerla ni copiarla:
+ *
+ * | tipo        | columnas                                            |
+ * |-------------|-----------------------------------------------------|
+ * | datos       | x[n], y[n]                                          |
+ * | spline3     | x[n], y[n], f2[n] (segundas derivadas)              |
+ * | newton      | x[n], y[n], b[n] (coeficientes; tambien Lagrange)   |
+ * | lineal      | b0, b1, st, sy, sr, syx, r2, n                      |
+ * | potencia    | c, a y despues los 8 valores de la regresion lineal |
+ * | exponencial | c, a y despues los 8 valores de la regresion lineal |
+ * | cuadratica  | a0, a1, a2, st, sr, sy, syx, r2, n                  |
+ *
+ * Los modelos que se crean desde un archivo mapeado toman prestados sus
+ * datos: el archivo_mapeado debe existir mientras existan los modelos.
+*/
+
+#ifndef BINARIO_H
+#define BINARIO_H
+
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "datos.h"
+#include "lagrange.h"
+#include "mapeo.h"
+#include "newton.h"
+#include "regresion.h"
+#include "spline3.h"
+
+using std::size_t;
+using std::span;
+using std::string;
+using std::vector;
+using std::uint16_t;
+using std::uint32_t;
+using std::uint64_t;
+using std::runtime_error;
+using std::invalid_argument;
+
+namespace binario {
+
+    static_assert(std::endian::native == std::endian::little, "El formato supone un procesador little-endian");
+
+    const uint32_t MAGIA = 0x42544E49; /*!< "INTB" */
+    const uint16_t VERSION = 1; /*!< Version del formato */
+    const size_t ALINEACION = 64; /*!< Alineacion de cada columna en el archivo */
+    const uint32_t MAX_COLUMNAS = 4; /*!< Columnas que caben en el encabezado */
+
+    /**
+     * @brief Contenido del archivo
+    */
+    enum class tipo : uint16_t {
+        datos = 1,
+        spline3 = 2,
+        newton = 3,
+        lineal = 4,
+        potencia = 5,
+        exponencial = 6,
+        cuadratica = 7
+    };
+
+    /**
+     * @brief Nombre del tipo, igual al del metodo en el modo por lotes
+    */
+    inline const char *nombre_tipo(tipo t){
+        switch (t){
+            case tipo::datos: return "datos";
+            case tipo::spline3: return "spline3";
+            case tipo::newton: return "newton";
+            case tipo::lineal: return "lineal";
+            case tipo::potencia: return "potencia";
+            case tipo::exponencial: return "exponencial";
+            case tipo::cuadratica: return "cuadratica";
+        }
+        return "desconocido";
+    }
+
+    /**
+     * @brief Encabezado al inicio del archivo
+    */
+    struct encabezado {
+        uint32_t magia; /*!< MAGIA */
+        uint16_t version; /*!< VERSION */
+        uint16_t contenido; /*!< tipo */
+        uint64_t n; /*!< Cantidad de datos con que se ajusto el modelo */
+        uint32_t columnas; /*!< Columnas usadas */
+        uint32_t reservado; /*!< 0 */
+        uint64_t desplazamiento[MAX_COLUMNAS]; /*!< Inicio de cada columna en bytes, multiplo de ALINEACION */
+        uint64_t longitud[MAX_COLUMNAS]; /*!< Reales de cada columna */
+        uint8_t relleno[40]; /*!< 0, hasta completar 128 bytes */
+    };
+    static_assert(sizeof(encabezado) == 128, "El encabezado ocupa 128 bytes");
+
+    /**
+     * @brief Escribe un archivo con las columnas dadas
+     * @param ruta Ruta del archivo; si existe se reemplaza
+     * @param t Tipo de contenido
+     * @param n Cantidad de datos
+     * @param columnas Columnas, en el orden del tipo
+    */
+    inline void escribir(const string &ruta, tipo t, uint64_t n, std::initializer_list<span<const double>> columnas){
+        if (columnas.size() > MAX_COLUMNAS){
+            throw invalid_argument("Demasiadas columnas");
+        }
+        encabezado e{};
+        e.magia = MAGIA;
+        e.version = VERSION;
+        e.contenido = (uint16_t)t;
+        e.n = n;
+        e.columnas = (uint32_t)columnas.size();
+        uint64_t pos = sizeof(encabezado);
+        size_t i = 0;
+        for (span<const double> c : columnas){
+            pos = (pos + ALINEACION - 1) / ALINEACION * ALINEACION;
+            e.desplazamiento[i] = pos;
+            e.longitud[i] = c.size();
+            pos += c.size() * sizeof(double);
+            i++;
+        }
+
+        FILE *archivo = std::fopen(ruta.c_str(), "wb");
+        if (archivo == nullptr){
+            throw runtime_error("No se pudo crear " + ruta);
+        }
+        const char ceros[ALINEACION] = {};
+        bool ok = std::fwrite(&e, sizeof(e), 1, archivo) == 1;
+        pos = sizeof(encabezado);
+        i = 0;
+        for (span<const double> c : columnas){
+            ok = ok && std::fwrite(ceros, 1, e.desplazamiento[i] - pos, archivo) == e.desplazamiento[i] - pos;
+            ok = ok && std::fwrite(c.data(), sizeof(double), c.size(), archivo) == c.size();
+            pos = e.desplazamiento[i] + c.size() * sizeof(double);
+            i++;
+        }
+        ok = (std::fclose(archivo) == 0) && ok;
+        if (!ok){
+            std::remove(ruta.c_str());
+            throw runtime_error("No se pudo escribir " + ruta);
+        }
+    }
+
+    /** @brief Guarda los datos (x, y) */
+    inline void guardar_datos(const string &ruta, span<const double> x, span<const double> y){
+        if (x.size() != y.size()){
+            throw invalid_argument("x e y deben tener el mismo tamano");
+        }
+        escribir(ruta, tipo::datos, x.size(), {x, y});
+    }
+
+    /** @brief Guarda un trazador cubico ajustado */
+    inline void guardar(const string &ruta, const interpolacion::spline3 &m){
+        escribir(ruta, tipo::spline3, m.datos_x().size(), {m.datos_x(), m.datos_y(), m.segundas_derivadas()});
+    }
+
+    /** @brief Guarda un polinomio de Newton ajustado */
+    inline void guardar(const string &ruta, const interpolacion::newton &m){
+        escribir(ruta, tipo::newton, m.datos_x().size(), {m.datos_x(), m.datos_y(), m.coeficientes()});
+    }
+
+    /** @brief Guarda un polinomio de Lagrange ajustado; se guarda como Newton, con los mismos coeficientes */
+    inline void guardar(const string &ruta, const interpolacion::lagrange &m){
+        escribir(ruta, tipo::newton, m.datos_x().size(), {m.datos_x(), m.datos_y(), m.coeficientes()});
+    }
+
+    /** @brief Valores de una regresion lineal, en el orden del formato */
+    inline vector<double> valores(const regresion::solucion_lineal &s){
+        return {s.b0, s.b1, s.st, s.sy, s.sr, s.syx, s.r2, (double)s.n};
+    }
+
+    /** @brief Guarda una regresion lineal */
+    inline void guardar(const string &ruta, const regresion::solucion_lineal &s){
+        vector<double> v = valores(s);
+        escribir(ruta, tipo::lineal, s.n, {v});
+    }
+
+    /** @brief Guarda una regresion potencial */
+    inline void guardar(const string &ruta, const regresion::solucion_potencia &s){
+        vector<double> v = {s.c, s.a};
+        vector<double> l = valores(s.lineal);
+        v.insert(v.end(), l.begin(), l.end());
+        escribir(ruta, tipo::potencia, s.lineal.n, {v});
+    }
+
+    /** @brief Guarda una regresion exponencial */
+    inline void guardar(const string &ruta, const regresion::solucion_exponencial &s){
+        vector<double> v = {s.c, s.a};
+        vector<double> l = valores(s.lineal);
+        v.insert(v.end(), l.begin(), l.end());
+        escribir(ruta, tipo::exponencial, s.lineal.n, {v});
+    }
+
+    /** @brief Guarda una regresion cuadratica */
+    inline void guardar(const string &ruta, const regresion::solucion_cuadratica &s){
+        vector<double> v = {s.a0, s.a1, s.a2, s.st, s.sr, s.sy, s.syx, s.r2, (double)s.n};
+        escribir(ruta, tipo::cuadratica, s.n, {v});
+    }
+
+    /**
+     * @brief Archivo binario mapeado en memoria, de solo lectura
+     *
+     * Abrirlo valida el encabezado y que las columnas esten dentro del
+     * archivo; no lee las columnas, que el sistema carga por paginas a
+     * medida que se usan. En Windows el archivo se lee completo a memoria.
+    */
+    class archivo_mapeado {
+        public:
+            /**
+             * @brief Mapea el archivo
+             * @param ruta Ruta del archivo
+            */
+            explicit archivo_mapeado(const string &ruta) : archivo(ruta){
+                base = (const unsigned char *)archivo.contenido().data();
+                tamano = archivo.size();
+                validar(ruta);
+            }
+
+            archivo_mapeado(const archivo_mapeado &) = delete;
+            archivo_mapeado &operator=(const archivo_mapeado &) = delete;
+
+            /** @brief Tipo de contenido */
+            tipo contenido() const {
+                return (tipo)e.contenido;
+            }
+
+            /** @brief Cantidad de datos con que se ajusto el modelo */
+            uint64_t n() const {
+                return e.n;
+            }
+
+            /**
+             * @brief Columna i, sin copiarla
+            */
+            span<const double> columna(size_t i) const {
+                if (i >= e.columnas){
+                    throw invalid_argument("El archivo no tiene la columna " + std::to_string(i));
+                }
+                return span<const double>((const double *)(base + e.desplazamiento[i]), e.longitud[i]);
+            }
+
+        private:
+            util::archivo_en_memoria archivo; /*!< Archivo mapeado */
+            const unsigned char *base = nullptr; /*!< Inicio del archivo en memoria */
+            size_t tamano = 0; /*!< Bytes del archivo */
+            encabezado e{}; /*!< Copia del encabezado */
+
+            void validar(const string &ruta){
+                if (tamano < sizeof(encabezado)){
+                    throw invalid_argument(ruta + " no es un archivo binario de interpolacion");
+                }
+                std::memcpy(&e, base, sizeof(e));
+                if (e.magia != MAGIA){
+                    throw invalid_argument(ruta + " no es un archivo binario de interpolacion");
+                }
+                if (e.version != VERSION){
+                    throw invalid_argument(ruta + ": version " + std::to_string(e.version) + " no soportada");
+                }
+                if (e.columnas > MAX_COLUMNAS){
+                    throw invalid_argument(ruta + ": encabezado invalido");
+                }
+                for (uint32_t i = 0; i < e.columnas; i++){
+                    if (e.desplazamiento[i] % ALINEACION != 0 || e.desplazamiento[i] > tamano
+                        || e.longitud[i] > (tamano - e.desplazamiento[i]) / sizeof(double)){
+                        throw invalid_argument(ruta + ": la columna " + std::to_string(i) + " sale del archivo");
+                    }
+                }
+            }
+    };
+
+    /**
+     * @brief Verifica el tipo y las columnas del archivo
+    */
+    inline void exigir(const archivo_mapeado &a, tipo t, uint32_t columnas, uint64_t longitud){
+        if (a.contenido() != t){
+            throw invalid_argument(string("El archivo contiene ") + nombre_tipo(a.contenido()) + ", no "
+                                   + nombre_tipo(t));
+        }
+        for (uint32_t i = 0; i < columnas; i++){
+            if (a.columna(i).size() != longitud){
+                throw invalid_argument("Las columnas del archivo no tienen el tamano esperado");
+            }
+        }
+    }
+
+    /** @brief Datos (x, y) del archivo, sin copiarlos */
+    inline std::pair<span<const double>, span<const double>> cargar_datos(const archivo_mapeado &a){
+        exigir(a, tipo::datos, 2, a.n());
+        return {a.columna(0), a.columna(1)};
+    }
+
+    /** @brief Trazador cubico ajustado, sin resolver el sistema ni copiar los datos */
+    inline interpolacion::spline3 cargar_spline3(const archivo_mapeado &a){
+        exigir(a, tipo::spline3, 3, a.n());
+        return interpolacion::spline3(util::prestado, a.columna(0), a.columna(1), util::datos(util::prestado, a.columna(2)));
+    }
+
+    /** @brief Polinomio de Newton ajustado, sin calcular los coeficientes ni copiar los datos */
+    inline interpolacion::newton cargar_newton(const archivo_mapeado &a){
+        exigir(a, tipo::newton, 3, a.n());
+        return interpolacion::newton(util::prestado, a.columna(0), a.columna(1), util::datos(util::prestado, a.columna(2)));
+    }
+
+    /** @brief Polinomio de Lagrange ajustado, desde un archivo de Newton */
+    inline interpolacion::lagrange cargar_lagrange(const archivo_mapeado &a){
+        exigir(a, tipo::newton, 3, a.n());
+        return interpolacion::lagrange(util::prestado, a.columna(0), a.columna(1), util::datos(util::prestado, a.columna(2)));
+    }
+
+    /** @brief Regresion lineal desde sus valores en el orden del formato */
+    inline regresion::solucion_lineal lineal_desde(span<const double> v){
+        regresion::solucion_lineal s;
+        s.b0 = v[0]; s.b1 = v[1]; s.st = v[2]; s.sy = v[3]; s.sr = v[4]; s.syx = v[5]; s.r2 = v[6];
+        s.n = (size_t)v[7];
+        return s;
+    }
+
+    /** @brief Regresion lineal guardada */
+    inline regresion::solucion_lineal cargar_lineal(const archivo_mapeado &a){
+        exigir(a, tipo::lineal, 1, 8);
+        return lineal_desde(a.columna(0));
+    }
+
+    /** @brief Regresion potencial guardada */
+    inline regresion::solucion_potencia cargar_potencia(const archivo_mapeado &a){
+        exigir(a, tipo::potencia, 1, 10);
+        span<const double> v = a.columna(0);
+        regresion::solucion_potencia s;
+        s.c = v[0];
+        s.a = v[1];
+        s.lineal = lineal_desde(v.subspan(2));
+        return s;
+    }
+
+    /** @brief Regresion exponencial guardada */
+    inline regresion::solucion_exponencial cargar_exponencial(const archivo_mapeado &a){
+        exigir(a, tipo::exponencial, 1, 10);
+        span<const double> v = a.columna(0);
+        regresion::solucion_exponencial s;
+        s.c = v[0];
+        s.a = v[1];
+        s.lineal = lineal_desde(v.subspan(2));
+        return s;
+    }
+
+    /** @brief Regresion cuadratica guardada */
+    inline regresion::solucion_cuadratica cargar_cuadratica(const archivo_mapeado &a){
+        exigir(a, tipo::cuadratica, 1, 9);
+        span<const double> v = a.columna(0);
+        regresion::solucion_cuadratica s;
+        s.a0 = v[0]; s.a1 = v[1]; s.a2 = v[2]; s.st = v[3]; s.sr = v[4]; s.sy = v[5]; s.syx = v[6]; s.r2 = v[7];
+        s.n = (size_t)v[8];
+        return s;
+    }
+
+    /**
+     * @brief Indica si el archivo empieza con la marca del formato binario
+    */
+    inline bool es_binario(const string &ruta){
+        FILE *archivo = std::fopen(ruta.c_str(), "rb");
+        if (archivo == nullptr){
+            return false;
+        }
+        uint32_t magia = 0;
+        bool ok = std::fread(&magia, sizeof(magia), 1, archivo) == 1 && magia == MAGIA;
+        std::fclose(archivo);
+        return ok;
+    }
+}
+
+#endif
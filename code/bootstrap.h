@@ -0,0 +1,309 @@
+/**
+ * @file
+ * @brief Intervalos de confianza bootstrap para los coeficientes de regresion
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+*/
+
+#ifndef BOOTSTRAP_H
+#define BOOTSTRAP_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "paralelo.h"
+#include "regresion.h"
+
+using std::cout;
+using std::endl;
+using std::span;
+using std::vector;
+using std::uint64_t;
+using std::invalid_argument;
+
+namespace regresion {
+
+    /**
+     * @brief Generador de numeros aleatorios basado en contador (SplitMix64)
+     *
+     * El numero k de la secuencia es una funcion pura de (clave, k), de modo
+     * que cada remuestra tiene su propia secuencia independiente y el
+     * resultado no depende del hilo que la calcula.
+    */
+    struct generador_contador{
+        uint64_t clave; /*!< Identificador de la secuencia */
+        uint64_t contador = 0; /*!< Posicion dentro de la secuencia */
+
+        /**
+         * @brief Crea la secuencia numero flujo a partir de una semilla
+         * @param semilla Semilla global
+         * @param flujo Numero de secuencia
+         */
+        generador_contador(uint64_t semilla, uint64_t flujo)
+            : clave(mezclar(semilla ^ mezclar(flujo + 0x632BE59BD9B4E019ULL))){
+        }
+
+        /**
+         * @brief Siguiente numero de 64 bits
+         */
+        uint64_t operator()(){
+            return mezclar(clave + (++contador) * 0x9E3779B97F4A7C15ULL);
+        }
+
+        /**
+         * @brief Siguiente indice uniforme en [0, n)
+         * @param n Cantidad de indices
+         */
+        size_t indice(size_t n){
+            return (size_t)(((unsigned __int128)(*this)() * n) >> 64);
+        }
+
+        /**
+         * @brief Funcion de mezcla de SplitMix64
+         */
+        static uint64_t mezclar(uint64_t z){
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+    };
+
+    /**
+     * @brief Intervalo de confianza de un coeficiente
+    */
+    struct intervalo{
+        double estimado = NAN; /*!< Valor calculado con todos los datos */
+        double inferior = NAN; /*!< Limite inferior */
+        double superior = NAN; /*!< Limite superior */
+        double error_estandar = NAN; /*!< Desviacion estandar de las remuestras */
+    };
+
+    /**
+     * @brief Intervalos de confianza de la recta de regresion
+    */
+    struct intervalos_lineal{
+        intervalo b0; /*!< Termino independiente */
+        intervalo b1; /*!< Coeficiente de x */
+        size_t remuestras = 0; /*!< Numero de remuestras */
+        double nivel = 0.0; /*!< Nivel de confianza */
+
+        /**
+         * @brief Imprimir los intervalos
+         */
+        void imprimir(){
+            cout << "Intervalos de confianza bootstrap (" << nivel * 100.0 << "%, "
+                 << remuestras << " remuestras)" << endl
+                 << "b0 = " << b0.estimado << "  [" << b0.inferior << ", " << b0.superior << "]" << endl
+                 << "b1 = " << b1.estimado << "  [" << b1.inferior << ", " << b1.superior << "]" << endl;
+        }
+    };
+
+    /**
+     * @brief Intervalos de confianza del polinomio de regresion cuadratica
+    */
+    struct intervalos_cuadratica{
+        intervalo a0; /*!< Termino independiente */
+        intervalo a1; /*!< Coeficiente de x */
+        intervalo a2; /*!< Coeficiente de x^2 */
+        size_t remuestras = 0; /*!< Numero de remuestras */
+        double nivel = 0.0; /*!< Nivel de confianza */
+
+        /**
+         * @brief Imprimir los intervalos
+         */
+        void imprimir(){
+            cout << "Intervalos de confianza bootstrap (" << nivel * 100.0 << "%, "
+                 << remuestras << " remuestras)" << endl
+                 << "a0 = " << a0.estimado << "  [" << a0.inferior << ", " << a0.superior << "]" << endl
+                 << "a1 = " << a1.estimado << "  [" << a1.inferior << ", " << a1.superior << "]" << endl
+                 << "a2 = " << a2.estimado << "  [" << a2.inferior << ", " << a2.superior << "]" << endl;
+        }
+    };
+
+    /**
+     * @brief Remuestreo bootstrap de pares (x, y)
+     *
+     * Cada remuestra es una tarea del grupo de hilos compartido. Cada hilo
+     * reutiliza su propio buffer de indices, y los ajustes se hacen sumando
+     * x[indice], y[indice] sin copiar los datos. Los intervalos se calculan
+     * con el metodo de percentiles.
+    */
+    class bootstrap{
+        public:
+            /**
+             * @brief Crea una instancia del remuestreo
+             * @param p_x Variable independiente (no se copia)
+             * @param p_y Variable dependiente (no se copia)
+             * @param p_semilla Semilla de las secuencias aleatorias
+             */
+            bootstrap(span<const double> p_x, span<const double> p_y, uint64_t p_semilla = 20231106)
+                : x(p_x), y(p_y), semilla(p_semilla){
+                if (x.size() != y.size()){
+                    throw invalid_argument("x e y deben tener el mismo tamano");
+                }
+            }
+
+            /**
+             * @brief Intervalos de confianza de b0 y b1
+             * @param remuestras Numero de remuestras B
+             * @param nivel Nivel de confianza, por ejemplo 0.95
+             * @return Intervalos de confianza
+             */
+            intervalos_lineal lineal(size_t remuestras, double nivel = 0.95) const {
+                vector<double> b0(remuestras), b1(remuestras);
+
+                remuestrear(remuestras, [&](size_t r, const acumulador &acc){
+                    solucion_lineal sol = acc.lineal();
+                    b0[r] = sol.b0;
+                    b1[r] = sol.b1;
+                });
+
+                acumulador total = acumular_todo();
+                solucion_lineal sol = total.lineal();
+
+                intervalos_lineal res;
+                res.remuestras = remuestras;
+                res.nivel = nivel;
+                res.b0 = calcular_intervalo(sol.b0, b0, nivel);
+                res.b1 = calcular_intervalo(sol.b1, b1, nivel);
+                return res;
+            }
+
+            /**
+             * @brief Intervalos de confianza de a0, a1 y a2
+             * @param remuestras Numero de remuestras B
+             * @param nivel Nivel de confianza, por ejemplo 0.95
+             * @return Intervalos de confianza
+             */
+            intervalos_cuadratica cuadratica(size_t remuestras, double nivel = 0.95) const {
+                vector<double> a0(remuestras), a1(remuestras), a2(remuestras);
+
+                remuestrear(remuestras, [&](size_t r, const acumulador &acc){
+                    solucion_cuadratica sol = acc.cuadratica();
+                    a0[r] = sol.a0;
+                    a1[r] = sol.a1;
+                    a2[r] = sol.a2;
+                });
+
+                acumulador total = acumular_todo();
+                solucion_cuadratica sol = total.cuadratica();
+
+                intervalos_cuadratica res;
+                res.remuestras = remuestras;
+                res.nivel = nivel;
+                res.a0 = calcular_intervalo(sol.a0, a0, nivel);
+                res.a1 = calcular_intervalo(sol.a1, a1, nivel);
+                res.a2 = calcular_intervalo(sol.a2, a2, nivel);
+                return res;
+            }
+
+        private:
+            span<const double> x; /*!< Variable independiente */
+            span<const double> y; /*!< Variable dependiente */
+            uint64_t semilla; /*!< Semilla de las secuencias aleatorias */
+
+            /**
+             * @brief Ejecuta las remuestras en paralelo
+             * @param remuestras Numero de remuestras
+             * @param ajustar Recibe el numero de remuestra y las sumas de la remuestra
+             */
+            template <typename F>
+            void remuestrear(size_t remuestras, F ajustar) const {
+                const size_t n = x.size();
+                // Cada tarea hace un tramo contiguo de remuestras con su propio arreglo de indices.
+                // No se indexa por hilo: dentro de una tarea de otro grupo de hilos, el indice del
+                // hilo que llega puede superar el tamaño del grupo compartido
+                const size_t tareas = std::min(remuestras, 4 * paralelo::grupo_compartido().tamano());
+                if (tareas == 0){
+                    return;
+                }
+                const size_t por_tarea = (remuestras + tareas - 1) / tareas;
+
+                paralelo::para_cada(tareas, [&](size_t tarea){
+                    const size_t inicio = tarea * por_tarea;
+                    const size_t fin = std::min(remuestras, inicio + por_tarea);
+                    vector<size_t> idx(n);
+
+                    for (size_t r = inicio; r < fin; r++){
+                        generador_contador generador(semilla, r);
+                        for (size_t i = 0; i < n; i++){
+                            idx[i] = generador.indice(n);
+                        }
+
+                        acumulador acc;
+                        for (size_t i = 0; i < n; i++){
+                            acc.agregar(x[idx[i]], y[idx[i]]);
+                        }
+                        ajustar(r, acc);
+                    }
+                });
+            }
+
+            /**
+             * @brief Sumas de todos los datos
+             */
+            acumulador acumular_todo() const {
+                acumulador acc;
+                for (size_t i = 0; i < x.size(); i++){
+                    acc.agregar(x[i], y[i]);
+                }
+                return acc;
+            }
+
+            /**
+             * @brief Intervalo de percentiles de las estimaciones de las remuestras
+             * @param estimado Valor calculado con todos los datos
+             * @param valores Estimaciones de las remuestras (se reordenan)
+             * @param nivel Nivel de confianza
+             */
+            static intervalo calcular_intervalo(double estimado, vector<double> &valores, double nivel){
+                intervalo res;
+                res.estimado = estimado;
+
+                // Descartar las remuestras degeneradas (por ejemplo, todas con el mismo x)
+                valores.erase(std::remove_if(valores.begin(), valores.end(),
+                                             [](double v){ return !std::isfinite(v); }),
+                              valores.end());
+                if (valores.empty()){
+                    return res;
+                }
+                std::sort(valores.begin(), valores.end());
+
+                double alfa = (1.0 - nivel) / 2.0;
+                res.inferior = percentil(valores, alfa);
+                res.superior = percentil(valores, 1.0 - alfa);
+
+                double prom = 0.0;
+                for (double v : valores){
+                    prom += v;
+                }
+                prom /= (double)valores.size();
+                double suma = 0.0;
+                for (double v : valores){
+                    suma += (v - prom) * (v - prom);
+                }
+                res.error_estandar = (valores.size() > 1) ? sqrt(suma / (double)(valores.size() - 1)) : NAN;
+                return res;
+            }
+
+            /**
+             * @brief Percentil con interpolacion lineal sobre valores ordenados
+             */
+            static double percentil(const vector<double> &ordenados, double q){
+                double pos = q * (double)(ordenados.size() - 1);
+                size_t i = (size_t)pos;
+                if (i + 1 >= ordenados.size()){
+                    return ordenados.back();
+                }
+                double t = pos - (double)i;
+                return ordenados[i] + t * (ordenados[i + 1] - ordenados[i]);
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,450 @@
+/**
+ * @file
+ * @brief Cache de modelos ajustados, direccionada por el contenido de los datos
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * La clave de cada modelo es un hash de 64 bits de (metodo, x, y), ademas
+ * de la cantidad de datos. Se guarda solo el estado ajustado: las segundas
+ * derivadas del trazador cubico, los coeficientes de Newton o la solucion
+ * de la regresion; x e y los aporta quien consulta. Un acierto construye
+ * el modelo sin llamar a calcular_f2, calcular_coeficientes ni calcular.
+ *
+ * La memoria se limita por bytes y se desaloja el estado usado hace mas
+ * tiempo (LRU). Opcionalmente cada estado se guarda tambien en un
+ * directorio, para que otros procesos lo reutilicen; los archivos guardan
+ * los reales tal como estan en memoria y solo sirven en la misma maquina.
+*/
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "datos.h"
+#include "lagrange.h"
+#include "newton.h"
+#include "regresion.h"
+#include "spline3.h"
+
+using std::size_t;
+using std::span;
+using std::string;
+using std::vector;
+using std::uint64_t;
+
+namespace util {
+
+    /**
+     * @brief Hash no criptografico de 64 bits de un arreglo de reales (el de XXH64)
+     * @param valores Reales; se usan sus bits, asi que 0.0 y -0.0 son distintos
+     * @param semilla Valor inicial; permite encadenar varios arreglos
+     * @return Hash de los valores
+    */
+    inline uint64_t hash_reales(span<const double> valores, uint64_t semilla = 0){
+        const uint64_t P1 = 11400714785074694791ULL;
+        const uint64_t P2 = 14029467366897019727ULL;
+        const uint64_t P3 = 1609587929392839161ULL;
+        const uint64_t P4 = 9650029242287828579ULL;
+        const uint64_t P5 = 2870177450012600261ULL;
+        auto ronda = [&](uint64_t acc, uint64_t v){
+            return std::rotl(acc + v * P2, 31) * P1;
+        };
+        auto mezclar = [&](uint64_t h, uint64_t acc){
+            return (h ^ ronda(0, acc)) * P1 + P4;
+        };
+
+        const size_t n = valores.size();
+        size_t i = 0;
+        uint64_t h;
+        if (n >= 4){
+            // Cuatro acumuladores independientes, para no encadenar las multiplicaciones
+            uint64_t v1 = semilla + P1 + P2, v2 = semilla + P2, v3 = semilla, v4 = semilla - P1;
+            for (; i + 4 <= n; i += 4){
+                v1 = ronda(v1, std::bit_cast<uint64_t>(valores[i]));
+                v2 = ronda(v2, std::bit_cast<uint64_t>(valores[i + 1]));
+                v3 = ronda(v3, std::bit_cast<uint64_t>(valores[i + 2]));
+                v4 = ronda(v4, std::bit_cast<uint64_t>(valores[i + 3]));
+            }
+            h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+            h = mezclar(mezclar(mezclar(mezclar(h, v1), v2), v3), v4);
+        } else {
+            h = semilla + P5;
+        }
+        h += (uint64_t)n * sizeof(double);
+        for (; i < n; i++){
+            h = std::rotl(h ^ ronda(0, std::bit_cast<uint64_t>(valores[i])), 27) * P1 + P4;
+        }
+
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+
+    /**
+     * @brief Aciertos y fallos de la cache de modelos
+    */
+    struct estadisticas_cache {
+        uint64_t aciertos = 0; /*!< Estados encontrados en memoria */
+        uint64_t aciertos_disco = 0; /*!< Estados leidos del directorio */
+        uint64_t fallos = 0; /*!< Estados que hubo que calcular */
+        uint64_t desalojos = 0; /*!< Estados descartados por falta de espacio */
+        size_t entradas = 0; /*!< Estados en memoria */
+        size_t bytes = 0; /*!< Memoria ocupada por los estados */
+
+        /**
+         * @brief Fraccion de consultas que no tuvieron que ajustar el modelo
+        */
+        double tasa_aciertos() const {
+            uint64_t total = aciertos + aciertos_disco + fallos;
+            return total > 0 ? (double)(aciertos + aciertos_disco) / (double)total : 0.0;
+        }
+    };
+
+    /**
+     * @brief Cache LRU de estados ajustados, segura entre hilos
+     *
+     * Si dos hilos piden a la vez el mismo estado que no esta en la cache,
+     * ambos lo calculan; el resultado es el mismo.
+    */
+    class cache_modelos {
+        public:
+            /**
+             * @brief Crea una cache vacia
+             * @param p_capacidad Bytes maximos de estados en memoria
+             * @param p_directorio Directorio existente para guardar los estados; vacio para no usar disco
+            */
+            explicit cache_modelos(size_t p_capacidad = size_t(256) << 20, string p_directorio = "")
+                : capacidad(p_capacidad), directorio(std::move(p_directorio)){
+            }
+
+            /**
+             * @brief Trazador cubico de los datos; solo resuelve el sistema si no esta en la cache
+             * @param x Variable independiente, ordenada; se mueve al modelo
+             * @param y Variable dependiente; se mueve al modelo
+            */
+            interpolacion::spline3 ajustar_spline3(vector<double> &&x, vector<double> &&y){
+                vector<double> f2 = obtener("spline3", x, y, x.size(), [&]{
+                    interpolacion::spline3 modelo(prestado, x, y);
+                    span<const double> f2 = modelo.segundas_derivadas();
+                    return vector<double>(f2.begin(), f2.end());
+                });
+                return interpolacion::spline3(std::move(x), std::move(y), datos(std::move(f2)));
+            }
+
+            /**
+             * @brief Trazador cubico que toma prestados los datos; solo resuelve el sistema si no esta en la cache
+             * @param x Variable independiente, ordenada; debe existir mientras exista el modelo
+             * @param y Variable dependiente; debe existir mientras exista el modelo
+            */
+            interpolacion::spline3 ajustar_spline3(prestado_t, span<const double> x, span<const double> y){
+                vector<double> f2 = obtener("spline3", x, y, x.size(), [&]{
+                    interpolacion::spline3 modelo(prestado, x, y);
+                    span<const double> f2 = modelo.segundas_derivadas();
+                    return vector<double>(f2.begin(), f2.end());
+                });
+                return interpolacion::spline3(prestado, x, y, datos(std::move(f2)));
+            }
+
+            /**
+             * @brief Polinomio de Newton de los datos; solo calcula los coeficientes si no estan en la cache
+             * @param x Variable independiente; se mueve al modelo
+             * @param y Variable dependiente; se mueve al modelo
+            */
+            interpolacion::newton ajustar_newton(vector<double> &&x, vector<double> &&y){
+                vector<double> b = obtener("newton", x, y, x.size(), [&]{
+                    return interpolacion::newton::calcular_coeficientes(x, y);
+                });
+                return interpolacion::newton(std::move(x), std::move(y), datos(std::move(b)));
+            }
+
+            /**
+             * @brief Polinomio de Newton que toma prestados los datos
+             * @param x Variable independiente; debe existir mientras exista el modelo
+             * @param y Variable dependiente; debe existir mientras exista el modelo
+            */
+            interpolacion::newton ajustar_newton(prestado_t, span<const double> x, span<const double> y){
+                vector<double> b = obtener("newton", x, y, x.size(), [&]{
+                    return interpolacion::newton::calcular_coeficientes(x, y);
+                });
+                return interpolacion::newton(prestado, x, y, datos(std::move(b)));
+            }
+
+            /**
+             * @brief Interpolante de Lagrange de los datos; comparte los coeficientes con Newton
+             * @param x Variable independiente; se mueve al modelo
+             * @param y Variable dependiente; se mueve al modelo
+            */
+            interpolacion::lagrange ajustar_lagrange(vector<double> &&x, vector<double> &&y){
+                vector<double> b = obtener("newton", x, y, x.size(), [&]{
+                    return interpolacion::newton::calcular_coeficientes(x, y);
+                });
+                return interpolacion::lagrange(std::move(x), std::move(y), datos(std::move(b)));
+            }
+
+            /**
+             * @brief Interpolante de Lagrange que toma prestados los datos
+             * @param x Variable independiente; debe existir mientras exista el modelo
+             * @param y Variable dependiente; debe existir mientras exista el modelo
+            */
+            interpolacion::lagrange ajustar_lagrange(prestado_t, span<const double> x, span<const double> y){
+                vector<double> b = obtener("newton", x, y, x.size(), [&]{
+                    return interpolacion::newton::calcular_coeficientes(x, y);
+                });
+                return interpolacion::lagrange(prestado, x, y, datos(std::move(b)));
+            }
+
+            /**
+             * @brief Regresion lineal de los datos; solo la calcula si no esta en la cache
+            */
+            regresion::solucion_lineal ajustar_lineal(span<const double> x, span<const double> y){
+                return solucion<regresion::solucion_lineal>("lineal", x, y, [&]{
+                    return regresion::lineal_simple(prestado, x, y).calcular();
+                });
+            }
+
+            /**
+             * @brief Regresion potencial de los datos; solo la calcula si no esta en la cache
+            */
+            regresion::solucion_potencia ajustar_potencia(span<const double> x, span<const double> y){
+                return solucion<regresion::solucion_potencia>("potencia", x, y, [&]{
+                    return regresion::potencia(prestado, x, y).calcular();
+                });
+            }
+
+            /**
+             * @brief Regresion exponencial de los datos; solo la calcula si no esta en la cache
+            */
+            regresion::solucion_exponencial ajustar_exponencial(span<const double> x, span<const double> y){
+                return solucion<regresion::solucion_exponencial>("exponencial", x, y, [&]{
+                    return regresion::exponencial(prestado, x, y).calcular();
+                });
+            }
+
+            /**
+             * @brief Regresion cuadratica de los datos; solo la calcula si no esta en la cache
+            */
+            regresion::solucion_cuadratica ajustar_cuadratica(span<const double> x, span<const double> y){
+                return solucion<regresion::solucion_cuadratica>("cuadratica", x, y, [&]{
+                    return regresion::cuadratica(prestado, x, y).calcular();
+                });
+            }
+
+            /**
+             * @brief Aciertos, fallos y ocupacion actuales
+            */
+            estadisticas_cache estadisticas() const {
+                std::lock_guard<std::mutex> guarda(mutex);
+                estadisticas_cache e = contadores;
+                e.entradas = entradas.size();
+                e.bytes = ocupados;
+                return e;
+            }
+
+            /**
+             * @brief Descarta los estados en memoria; los del directorio se conservan
+            */
+            void vaciar(){
+                std::lock_guard<std::mutex> guarda(mutex);
+                indice.clear();
+                entradas.clear();
+                ocupados = 0;
+            }
+
+        private:
+            /** @brief Identifica un estado ajustado */
+            struct clave {
+                string metodo; /*!< Metodo que produce el estado */
+                uint64_t n; /*!< Cantidad de datos */
+                uint64_t hash; /*!< hash_reales de metodo, x e y */
+
+                bool operator==(const clave &) const = default;
+            };
+
+            struct hash_clave {
+                size_t operator()(const clave &k) const {
+                    return (size_t)k.hash;
+                }
+            };
+
+            struct entrada {
+                clave k; /*!< Clave del estado */
+                vector<double> estado; /*!< Estado ajustado */
+            };
+
+            static constexpr uint32_t MAGIA = 0x43544E49; /*!< "INTC", inicio de los archivos de estado */
+            static constexpr uint32_t VERSION = 1; /*!< Version de los archivos de estado */
+
+            size_t capacidad; /*!< Bytes maximos en memoria */
+            string directorio; /*!< Directorio de estados; vacio si no se usa */
+            mutable std::mutex mutex; /*!< Protege la lista, el indice y los contadores */
+            std::list<entrada> entradas; /*!< De la mas reciente a la mas antigua */
+            std::unordered_map<clave, std::list<entrada>::iterator, hash_clave> indice; /*!< Entrada de cada clave */
+            size_t ocupados = 0; /*!< Bytes de los estados en memoria */
+            estadisticas_cache contadores; /*!< Aciertos, fallos y desalojos */
+
+            static clave calcular_clave(const char *metodo, span<const double> x, span<const double> y){
+                // El nombre del metodo se usa como semilla (FNV-1a)
+                uint64_t semilla = 14695981039346656037ULL;
+                for (const char *c = metodo; *c != '\0'; c++){
+                    semilla = (semilla ^ (unsigned char)*c) * 1099511628211ULL;
+                }
+                return clave{metodo, (uint64_t)x.size(), hash_reales(y, hash_reales(x, semilla))};
+            }
+
+            /**
+             * @brief Estado de la clave: de la memoria, del directorio o calculado
+             * @param tamano Reales que debe tener el estado
+             * @param calcular Funcion que ajusta el modelo y retorna su estado
+             *
+             * Un estado guardado de otro tamaño (por ejemplo, escrito por otra
+             * version de la estructura) se descarta y cuenta como un fallo: se
+             * recalcula y reemplaza al guardado.
+            */
+            template <typename F>
+            vector<double> obtener(const char *metodo, span<const double> x, span<const double> y, size_t tamano, F calcular){
+                clave k = calcular_clave(metodo, x, y);
+                {
+                    std::lock_guard<std::mutex> guarda(mutex);
+                    auto it = indice.find(k);
+                    if (it != indice.end()){
+                        if (it->second->estado.size() == tamano){
+                            entradas.splice(entradas.begin(), entradas, it->second);
+                            contadores.aciertos++;
+                            return it->second->estado;
+                        }
+                        ocupados -= it->second->estado.size() * sizeof(double);
+                        entradas.erase(it->second);
+                        indice.erase(it);
+                    }
+                }
+
+                vector<double> estado;
+                if (leer_disco(k, estado) && estado.size() == tamano){
+                    std::lock_guard<std::mutex> guarda(mutex);
+                    contadores.aciertos_disco++;
+                    insertar(k, estado);
+                    return estado;
+                }
+
+                estado = calcular();
+                escribir_disco(k, estado);
+                std::lock_guard<std::mutex> guarda(mutex);
+                contadores.fallos++;
+                insertar(k, estado);
+                return estado;
+            }
+
+            /**
+             * @brief Solucion de regresion guardada como los bytes de la estructura
+            */
+            template <typename S, typename F>
+            S solucion(const char *metodo, span<const double> x, span<const double> y, F calcular){
+                static_assert(std::is_trivially_copyable_v<S>, "La solucion debe poder copiarse byte a byte");
+                const size_t tamano = (sizeof(S) + sizeof(double) - 1) / sizeof(double);
+                vector<double> estado = obtener(metodo, x, y, tamano, [&]{
+                    S sol = calcular();
+                    vector<double> bytes(tamano);
+                    std::memcpy(bytes.data(), &sol, sizeof(S));
+                    return bytes;
+                });
+                S sol;
+                std::memcpy((void *)&sol, estado.data(), sizeof(S));
+                return sol;
+            }
+
+            /** @brief Agrega el estado como el mas reciente y desaloja los mas antiguos; requiere el mutex */
+            void insertar(const clave &k, const vector<double> &estado){
+                size_t bytes = estado.size() * sizeof(double);
+                if (bytes > capacidad || indice.count(k) > 0){
+                    return;
+                }
+                entradas.push_front(entrada{k, estado});
+                indice[k] = entradas.begin();
+                ocupados += bytes;
+                while (ocupados > capacidad){
+                    entrada &vieja = entradas.back();
+                    ocupados -= vieja.estado.size() * sizeof(double);
+                    indice.erase(vieja.k);
+                    entradas.pop_back();
+                    contadores.desalojos++;
+                }
+            }
+
+            string ruta(const clave &k) const {
+                char nombre[64];
+                std::snprintf(nombre, sizeof(nombre), "/%s-%llu-%016llx.estado", k.metodo.c_str(),
+                              (unsigned long long)k.n, (unsigned long long)k.hash);
+                return directorio + nombre;
+            }
+
+            /**
+             * @brief Lee el estado del directorio
+             * @return false si no se usa disco, el archivo no existe o no corresponde a la clave
+            */
+            bool leer_disco(const clave &k, vector<double> &estado) const {
+                if (directorio.empty()){
+                    return false;
+                }
+                FILE *archivo = std::fopen(ruta(k).c_str(), "rb");
+                if (archivo == nullptr){
+                    return false;
+                }
+                uint64_t cabecera[4];
+                bool ok = std::fread(cabecera, sizeof(cabecera), 1, archivo) == 1
+                       && cabecera[0] == ((uint64_t)VERSION << 32 | MAGIA) && cabecera[1] == k.n
+                       && cabecera[2] == k.hash && cabecera[3] <= (uint64_t(1) << 40);
+                if (ok){
+                    estado.resize(cabecera[3]);
+                    ok = std::fread(estado.data(), sizeof(double), estado.size(), archivo) == estado.size();
+                }
+                std::fclose(archivo);
+                return ok;
+            }
+
+            /**
+             * @brief Guarda el estado en el directorio; los errores solo hacen que no se guarde
+             *
+             * Se escribe en un archivo temporal que luego se renombra, para que
+             * otro proceso nunca lea un estado a medio escribir.
+            */
+            void escribir_disco(const clave &k, const vector<double> &estado) const {
+                if (directorio.empty()){
+                    return;
+                }
+                string destino = ruta(k);
+                uint64_t sufijo = std::hash<std::thread::id>{}(std::this_thread::get_id())
+                                ^ (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+                string temporal = destino + "." + std::to_string(sufijo) + ".tmp";
+                FILE *archivo = std::fopen(temporal.c_str(), "wb");
+                if (archivo == nullptr){
+                    return;
+                }
+                uint64_t cabecera[4] = {(uint64_t)VERSION << 32 | MAGIA, k.n, k.hash, (uint64_t)estado.size()};
+                bool ok = std::fwrite(cabecera, sizeof(cabecera), 1, archivo) == 1
+                       && std::fwrite(estado.data(), sizeof(double), estado.size(), archivo) == estado.size();
+                ok = (std::fclose(archivo) == 0) && ok;
+                if (!ok || std::rename(temporal.c_str(), destino.c_str()) != 0){
+                    std::remove(temporal.c_str());
+                }
+            }
+    };
+}
+
+#endif
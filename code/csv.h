@@ -0,0 +1,392 @@
+/**
+ * @file
+ * @brief Lectura de columnas de archivos CSV y TSV grandes, mapeados en memoria y por bloques en paralelo
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * El archivo se mapea en memoria (mapeo.h) y se divide en bloques que
+ * terminan en un salto de linea; cada bloque se recorre en un hilo y los
+ * valores se convierten con std::from_chars directamente sobre el texto
+ * mapeado, sin copiar lineas ni campos. La cantidad de bloques solo depende
+ * del tamaño del archivo y los resultados parciales se combinan en orden,
+ * asi que el resultado es el mismo con cualquier cantidad de hilos.
+ *
+ * Formato:
+ * - El separador se detecta en la primera linea por prioridad, no por
+ *   posicion: tabulador si hay alguno; si no, coma; si no, punto y coma; si no
+ *   hay ninguno, los campos se separan por espacios. Asi "1,5\t2,5" se separa
+ *   por tabuladores aunque la coma aparezca antes.
+ * - Si la primera linea tiene algun campo no numerico, es el encabezado.
+ * - Las lineas vacias y las que empiezan con # se ignoran.
+ * - Los campos pueden tener espacios y comillas alrededor. Las comillas no
+ *   protegen separadores dentro del campo.
+ * - Las filas con el campo de x o de y vacio se omiten y se cuentan.
+*/
+
+#ifndef CSV_H
+#define CSV_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "instrumentacion.h"
+#include "mapeo.h"
+#include "paralelo.h"
+#include "regresion.h"
+
+using std::size_t;
+using std::span;
+using std::string;
+using std::string_view;
+using std::vector;
+using std::invalid_argument;
+
+namespace util {
+
+    /**
+     * @brief Archivo CSV o TSV de solo lectura, del que se leen pares de columnas numericas
+    */
+    class csv {
+        public:
+            /**
+             * @brief Mapea el archivo y lee el encabezado
+             * @param ruta Ruta del archivo
+             * @param p_separador Separador de campos; '\0' para detectarlo, ' ' para separar por espacios
+            */
+            explicit csv(const string &ruta, char p_separador = '\0') : archivo(ruta), separador(p_separador){
+                span<const char> texto = archivo.contenido();
+                inicio_datos = texto.data();
+                fin_datos = texto.data() + texto.size();
+                archivo.lectura_secuencial();
+                leer_encabezado();
+            }
+
+            /**
+             * @brief Nombres de las columnas; vacio si el archivo no tiene encabezado
+            */
+            const vector<string> &nombres() const {
+                return encabezado;
+            }
+
+            /**
+             * @brief Indice de la columna con el nombre dado
+            */
+            size_t columna(const string &nombre) const {
+                auto it = std::find(encabezado.begin(), encabezado.end(), nombre);
+                if (it == encabezado.end()){
+                    throw invalid_argument("El archivo no tiene la columna " + nombre);
+                }
+                return (size_t)(it - encabezado.begin());
+            }
+
+            /**
+             * @brief Filas omitidas por tener un campo vacio en la ultima lectura
+            */
+            size_t omitidas() const {
+                return n_omitidas;
+            }
+
+            /**
+             * @brief Recorre los pares (x, y) por bloques en paralelo
+             * @tparam S Estado parcial de cada bloque
+             * @param cx Columna de x
+             * @param cy Columna de y
+             * @param agregar Funcion agregar(S &estado, double x, double y), llamada en el orden del archivo dentro de cada bloque
+             * @return Estados de los bloques, en el orden del archivo
+            */
+            template <typename S, typename F>
+            vector<S> por_bloques(size_t cx, size_t cy, F agregar){
+                const size_t n_bloques = bloques(fin_datos - inicio_datos);
+                vector<const char *> limites(n_bloques + 1);
+                const size_t bytes = fin_datos - inicio_datos;
+                for (size_t b = 0; b < n_bloques; b++){
+                    limites[b] = siguiente_linea(inicio_datos + bytes / n_bloques * b);
+                }
+                limites[n_bloques] = fin_datos;
+
+                vector<S> estados(n_bloques);
+                vector<size_t> omitidas_bloque(n_bloques, 0);
+                vector<resultado> errores(n_bloques);
+                paralelo::para_cada(n_bloques, [&](size_t b){
+                    errores[b] = recorrer(limites[b], std::max(limites[b], limites[b + 1]), cx, cy,
+                                          omitidas_bloque[b], [&](double x, double y){ agregar(estados[b], x, y); });
+                });
+
+                // El primer error del archivo, sin importar que hilo lo encontro primero
+                for (const resultado &r : errores){
+                    if (r.posicion != nullptr){
+                        lanzar(r);
+                    }
+                }
+                n_omitidas = 0;
+                for (size_t o : omitidas_bloque){
+                    n_omitidas += o;
+                }
+                return estados;
+            }
+
+            /**
+             * @brief Acumula las sumas de la regresion de y sobre x sin guardar los datos
+             * @param cx Columna de x
+             * @param cy Columna de y
+            */
+            regresion::acumulador acumular(size_t cx = 0, size_t cy = 1){
+                MEDIR("csv::acumular");
+                vector<regresion::acumulador> parciales = por_bloques<regresion::acumulador>(cx, cy,
+                    [](regresion::acumulador &acc, double x, double y){ acc.agregar(x, y); });
+                regresion::acumulador total;
+                for (const regresion::acumulador &acc : parciales){
+                    total.combinar(acc);
+                }
+                return total;
+            }
+
+            /**
+             * @brief Agrega los pares (x, y) a los vectores, en el orden del archivo
+             * @param cx Columna de x
+             * @param cy Columna de y
+             * @param x Salida: variable independiente
+             * @param y Salida: variable dependiente
+            */
+            void leer(size_t cx, size_t cy, vector<double> &x, vector<double> &y){
+                MEDIR("csv::leer");
+                struct columnas {
+                    vector<double> x, y;
+                };
+                vector<columnas> partes = por_bloques<columnas>(cx, cy, [](columnas &c, double vx, double vy){
+                    c.x.push_back(vx);
+                    c.y.push_back(vy);
+                });
+
+                vector<size_t> destino(partes.size() + 1, x.size());
+                for (size_t b = 0; b < partes.size(); b++){
+                    destino[b + 1] = destino[b] + partes[b].x.size();
+                }
+                x.resize(destino.back());
+                y.resize(destino.back());
+                paralelo::para_cada(partes.size(), [&](size_t b){
+                    std::copy(partes[b].x.begin(), partes[b].x.end(), x.begin() + destino[b]);
+                    std::copy(partes[b].y.begin(), partes[b].y.end(), y.begin() + destino[b]);
+                    partes[b] = columnas();
+                });
+            }
+
+        private:
+            static constexpr size_t BLOQUE = size_t(4) << 20; /*!< Bytes aproximados por bloque */
+            static constexpr size_t MAX_BLOQUES = 256; /*!< Maximo de bloques por archivo */
+
+            /** @brief Resultado de recorrer un bloque */
+            struct resultado {
+                const char *posicion = nullptr; /*!< Campo con el error; nullptr si no hubo */
+                const char *fin = nullptr; /*!< Fin del campo con el error */
+                size_t columna = 0; /*!< Columna que falta, si posicion == fin */
+            };
+
+            archivo_en_memoria archivo; /*!< Archivo mapeado */
+            char separador; /*!< Separador de campos; ' ' si se separan por espacios */
+            vector<string> encabezado; /*!< Nombres de las columnas */
+            const char *inicio_datos = nullptr; /*!< Primera linea de datos */
+            const char *fin_datos = nullptr; /*!< Fin del archivo */
+            size_t n_omitidas = 0; /*!< Filas omitidas en la ultima lectura */
+
+            static size_t bloques(size_t bytes){
+                return std::clamp<size_t>(bytes / BLOQUE, 1, MAX_BLOQUES);
+            }
+
+            static bool es_blanco(char c){
+                return c == ' ' || c == '\t' || c == '\r';
+            }
+
+            /** @brief Inicio de la linea siguiente a p, o p si p ya es inicio de linea */
+            const char *siguiente_linea(const char *p) const {
+                if (p == archivo.contenido().data() || p[-1] == '\n'){
+                    return p;
+                }
+                const void *salto = std::memchr(p, '\n', fin_datos - p);
+                return salto ? (const char *)salto + 1 : fin_datos;
+            }
+
+            /** @brief Quita espacios, \r y comillas alrededor del campo */
+            static string_view recortar(const char *a, const char *b){
+                while (a < b && (es_blanco(*a) || *a == '"')){
+                    a++;
+                }
+                while (b > a && (es_blanco(b[-1]) || b[-1] == '"')){
+                    b--;
+                }
+                return string_view(a, b - a);
+            }
+
+            /** @brief Convierte un campo recortado; acepta un + inicial */
+            static bool convertir(string_view campo, double &v){
+                const char *a = campo.data();
+                const char *b = a + campo.size();
+                if (a < b && *a == '+'){
+                    a++;
+                }
+                auto [ptr, ec] = std::from_chars(a, b, v);
+                return ec == std::errc() && ptr == b;
+            }
+
+            /**
+             * @brief Fin del campo que empieza en p; si se separa por espacios, el primer blanco
+            */
+            const char *fin_campo(const char *p, const char *fin_linea) const {
+                if (separador == ' '){
+                    while (p < fin_linea && !es_blanco(*p)){
+                        p++;
+                    }
+                    return p;
+                }
+                const void *s = std::memchr(p, separador, fin_linea - p);
+                return s ? (const char *)s : fin_linea;
+            }
+
+            /**
+             * @brief Inicio del campo que sigue al que termina en p; nullptr si la linea no tiene mas campos
+            */
+            const char *siguiente_campo(const char *p, const char *fin_linea) const {
+                if (p == fin_linea){
+                    return nullptr;
+                }
+                if (separador == ' '){
+                    while (p < fin_linea && es_blanco(*p)){
+                        p++;
+                    }
+                    return (p == fin_linea) ? nullptr : p;
+                }
+                return p + 1;
+            }
+
+            /**
+             * @brief Recorre las lineas de un bloque
+             * @param omitidas Salida: filas omitidas del bloque
+             * @param f Funcion f(x, y) para cada fila valida
+             * @return Primer error del bloque
+            */
+            template <typename F>
+            resultado recorrer(const char *p, const char *fin, size_t cx, size_t cy, size_t &omitidas, F f) const {
+                const size_t ultima = std::max(cx, cy);
+                while (p < fin){
+                    const void *salto = std::memchr(p, '\n', fin - p);
+                    const char *fin_linea = salto ? (const char *)salto : fin;
+                    const char *siguiente = salto ? fin_linea + 1 : fin;
+                    while (p < fin_linea && es_blanco(*p)){
+                        p++;
+                    }
+                    if (p == fin_linea || *p == '#'){
+                        p = siguiente;
+                        continue;
+                    }
+
+                    double vx = 0.0, vy = 0.0;
+                    bool vacio = false;
+                    const char *c = p;
+                    for (size_t j = 0; j <= ultima; j++){
+                        if (c == nullptr){
+                            return resultado{fin_linea, fin_linea, j};
+                        }
+                        const char *fc = fin_campo(c, fin_linea);
+                        if (j == cx || j == cy){
+                            string_view campo = recortar(c, fc);
+                            if (campo.empty()){
+                                vacio = true;
+                            } else if (!convertir(campo, j == cx ? vx : vy)){
+                                return resultado{campo.data(), campo.data() + campo.size(), 0};
+                            }
+                            if (cx == cy){
+                                vy = vx;
+                            }
+                        }
+                        c = siguiente_campo(fc, fin_linea);
+                    }
+
+                    if (vacio){
+                        omitidas++;
+                    } else {
+                        f(vx, vy);
+                    }
+                    p = siguiente;
+                }
+                return resultado{};
+            }
+
+            /**
+             * @brief Lanza el error con el numero de linea, que solo se calcula aqui
+            */
+            [[noreturn]] void lanzar(const resultado &r) const {
+                const char *inicio = archivo.contenido().data();
+                size_t linea = 1 + (size_t)std::count(inicio, r.posicion, '\n');
+                if (r.posicion == r.fin){
+                    throw invalid_argument("La linea " + std::to_string(linea) + " no tiene la columna "
+                                           + std::to_string(r.columna));
+                }
+                throw invalid_argument("Valor invalido en la linea " + std::to_string(linea) + ": "
+                                       + string(r.posicion, r.fin));
+            }
+
+            /**
+             * @brief Detecta el separador y, si la primera linea no es numerica, la toma como encabezado
+            */
+            void leer_encabezado(){
+                // Primera linea que no es comentario ni esta vacia
+                const char *p = inicio_datos;
+                const char *fin_linea = p;
+                while (p < fin_datos){
+                    const void *salto = std::memchr(p, '\n', fin_datos - p);
+                    fin_linea = salto ? (const char *)salto : fin_datos;
+                    const char *q = p;
+                    while (q < fin_linea && es_blanco(*q)){
+                        q++;
+                    }
+                    if (q < fin_linea && *q != '#'){
+                        break;
+                    }
+                    p = salto ? fin_linea + 1 : fin_datos;
+                }
+                if (p == fin_datos){
+                    return;
+                }
+
+                if (separador == '\0'){
+                    separador = ' ';
+                    for (char s : {'\t', ',', ';'}){
+                        if (std::memchr(p, s, fin_linea - p) != nullptr){
+                            separador = s;
+                            break;
+                        }
+                    }
+                }
+
+                vector<string> campos;
+                bool numerica = true;
+                const char *c = p;
+                while (separador == ' ' && c < fin_linea && es_blanco(*c)){
+                    c++;
+                }
+                while (c != nullptr){
+                    const char *fc = fin_campo(c, fin_linea);
+                    string_view campo = recortar(c, fc);
+                    double v;
+                    if (!campo.empty() && !convertir(campo, v)){
+                        numerica = false;
+                    }
+                    campos.emplace_back(campo);
+                    c = siguiente_campo(fc, fin_linea);
+                }
+                if (!numerica){
+                    encabezado = std::move(campos);
+                    inicio_datos = (fin_linea < fin_datos) ? fin_linea + 1 : fin_datos;
+                }
+            }
+    };
+}
+
+#endif
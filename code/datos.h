@@ -0,0 +1,179 @@
+/**
+ * @file
+ * @brief Arreglo de datos propio o prestado para los constructores de los modelos
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+*/
+
+#ifndef DATOS_H
+#define DATOS_H
+
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using std::size_t;
+using std::span;
+using std::vector;
+
+namespace util {
+
+    /**
+     * @brief Marca para construir un modelo que toma prestados los datos sin copiarlos
+    */
+    struct prestado_t {
+        explicit prestado_t() = default;
+    };
+
+    /** @brief Valor de la marca de prestamo: modelo(util::prestado, x, y) */
+    inline constexpr prestado_t prestado{};
+
+    /**
+     * @brief Arreglo de reales, propio o prestado, de solo lectura salvo por modificables()
+     *
+     * Asignaciones de memoria de cada forma de construirlo:
+     * - desde una vista (span, o un vector como lvalue): 1, se copian los datos
+     * - desde un vector como rvalue: 0, se mueve el vector
+     * - prestado: 0, solo guarda la vista; los datos deben existir mientras se use
+     * Copiar un arreglo propio copia los datos; copiar uno prestado copia la vista.
+     *
+     * @tparam T Tipo de los reales: double o float
+    */
+    template <typename T>
+    class basic_datos {
+        public:
+            basic_datos() = default;
+
+            /** @brief Copia los datos de la vista */
+            explicit basic_datos(span<const T> v) : propio(v.begin(), v.end()), vista(propio){
+            }
+
+            /** @brief Toma posesion del vector sin copiarlo */
+            explicit basic_datos(vector<T> &&v) : propio(std::move(v)), vista(propio){
+            }
+
+            /** @brief Toma prestada la vista sin copiar los datos */
+            basic_datos(prestado_t, span<const T> v) : vista(v), es_prestado(true){
+            }
+
+            basic_datos(const basic_datos &otro) : propio(otro.propio), vista(otro.vista), es_prestado(otro.es_prestado){
+                if (!es_prestado){
+                    vista = propio;
+                }
+            }
+
+            basic_datos(basic_datos &&otro) noexcept
+                : propio(std::move(otro.propio)), vista(otro.vista), es_prestado(otro.es_prestado){
+                if (!es_prestado){
+                    vista = propio;
+                }
+                otro.vista = span<const T>();
+            }
+
+            basic_datos &operator=(const basic_datos &otro){
+                if (this != &otro){
+                    basic_datos copia(otro);
+                    *this = std::move(copia);
+                }
+                return *this;
+            }
+
+            basic_datos &operator=(basic_datos &&otro) noexcept {
+                if (this != &otro){
+                    propio = std::move(otro.propio);
+                    es_prestado = otro.es_prestado;
+                    vista = es_prestado ? otro.vista : span<const T>(propio);
+                    otro.vista = span<const T>();
+                }
+                return *this;
+            }
+
+            /** @brief Elemento i */
+            T operator[](size_t i) const {
+                return vista[i];
+            }
+
+            /** @brief Cantidad de datos */
+            size_t size() const {
+                return vista.size();
+            }
+
+            /** @brief Indica si no hay datos */
+            bool empty() const {
+                return vista.empty();
+            }
+
+            /** @brief Puntero al primer dato */
+            const T *data() const {
+                return vista.data();
+            }
+
+            /** @brief Inicio del arreglo */
+            const T *begin() const {
+                return vista.data();
+            }
+
+            /** @brief Fin del arreglo */
+            const T *end() const {
+                return vista.data() + vista.size();
+            }
+
+            /** @brief Indica si los datos son prestados */
+            bool prestados() const {
+                return es_prestado;
+            }
+
+            /** @brief Vista de los datos */
+            operator span<const T>() const {
+                return vista;
+            }
+
+            /**
+             * @brief Datos para modificarlos en su lugar
+             * @note Si son prestados primero los copia (una asignacion) y pasan a ser propios
+            */
+            span<T> modificables(){
+                if (es_prestado){
+                    propio.assign(vista.begin(), vista.end());
+                    vista = propio;
+                    es_prestado = false;
+                }
+                return propio;
+            }
+
+        private:
+            vector<T> propio; /*!< Datos propios (vacio si son prestados) */
+            span<const T> vista; /*!< Vista de los datos, propios o prestados */
+            bool es_prestado = false; /*!< Los datos son prestados */
+    };
+
+    using datos = basic_datos<double>; /*!< Arreglo de double, el tipo de los modelos por defecto */
+
+    /**
+     * @brief Copia una vista convirtiendo cada valor a T
+     * @param v Valores
+     * @return Vector con los valores convertidos
+    */
+    template <typename T, typename U>
+    vector<T> convertir(span<const U> v){
+        return vector<T>(v.begin(), v.end());
+    }
+
+    /**
+     * @brief Convierte un vector a T; si ya es de tipo T lo mueve sin copiarlo
+     * @param v Valores; se mueven
+     * @return Vector con los valores convertidos
+    */
+    template <typename T, typename U>
+    vector<T> convertir(vector<U> &&v){
+        if constexpr (std::is_same_v<T, U>){
+            return std::move(v);
+        } else {
+            return convertir<T>(span<const U>(v));
+        }
+    }
+}
+
+#endif
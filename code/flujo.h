@@ -0,0 +1,317 @@
+/**
+ * @file
+ * @brief Lectura y escritura de reales por bloques, sin depender del locale
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Los reales se convierten con std::from_chars y std::to_chars, que siempre
+ * usan el punto decimal y no reservan memoria, y el archivo se lee y se
+ * escribe en bloques grandes en lugar de un valor por llamada.
+*/
+
+#ifndef FLUJO_H
+#define FLUJO_H
+
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+using std::size_t;
+using std::span;
+using std::string;
+using std::vector;
+using std::invalid_argument;
+
+namespace util {
+
+    /**
+     * @brief Lector de reales separados por espacios, comas o punto y coma
+     *
+     * Las lineas que empiezan con # se ignoran.
+    */
+    class lector_reales {
+        public:
+            /**
+             * @brief Crea un lector sobre un archivo abierto; no lo cierra
+             * @param p_archivo Archivo de entrada
+             * @param capacidad Tamaño del bloque de lectura en bytes
+            */
+            explicit lector_reales(FILE *p_archivo, size_t capacidad = 1 << 20)
+                : archivo(p_archivo), bloque(capacidad){
+            }
+
+            /**
+             * @brief Lee el siguiente real
+             * @param v Salida: valor leido
+             * @return false si se llego al fin del archivo
+            */
+            bool siguiente(double &v){
+                if (!saltar_separadores()){
+                    return false;
+                }
+                size_t longitud = longitud_token(); // Puede mover los datos del bloque
+                const char *inicio = bloque.data() + pos;
+                const char *fin = inicio + longitud;
+                auto [ptr, ec] = std::from_chars(inicio, fin, v);
+                if (ec != std::errc() || ptr != fin){
+                    throw invalid_argument("Valor invalido en la linea " + std::to_string(linea) + ": "
+                                           + string(inicio, fin));
+                }
+                pos += fin - inicio;
+                inicio_linea = false;
+                return true;
+            }
+
+            /**
+             * @brief Llena destino con los siguientes reales
+             * @param destino Arreglo de salida
+             * @return Cantidad de reales leidos; menor que destino.size() solo al fin del archivo
+            */
+            size_t leer(span<double> destino){
+                size_t k = 0;
+                while (k < destino.size()){
+                    // Camino rapido: el valor termina dentro del bloque, sin comentarios ni relleno
+                    const char *p = bloque.data() + pos;
+                    const char *e = bloque.data() + fin_datos;
+                    while (p < e && es_separador(*p)){
+                        if (*p == '\n'){
+                            linea++;
+                            inicio_linea = true;
+                        }
+                        p++;
+                    }
+                    pos = p - bloque.data();
+                    if (p < e && *p != '#'){
+                        auto [ptr, ec] = std::from_chars(p, e, destino[k]);
+                        if (ec == std::errc() && ptr < e && es_separador(*ptr)){
+                            pos = ptr - bloque.data();
+                            inicio_linea = false;
+                            k++;
+                            continue;
+                        }
+                    }
+                    // Camino general: fin del bloque, comentario o valor invalido
+                    if (!siguiente(destino[k])){
+                        break;
+                    }
+                    k++;
+                }
+                return k;
+            }
+
+            /**
+             * @brief Si el primer valor no es numerico, descarta la primera linea (encabezado)
+            */
+            void omitir_encabezado(){
+                if (!saltar_separadores()){
+                    return;
+                }
+                size_t longitud = longitud_token(); // Puede mover los datos del bloque
+                const char *inicio = bloque.data() + pos;
+                const char *fin = inicio + longitud;
+                double v;
+                auto [ptr, ec] = std::from_chars(inicio, fin, v);
+                if (ec != std::errc() || ptr != fin){
+                    saltar_linea();
+                }
+            }
+
+        private:
+            FILE *archivo; /*!< Archivo de entrada */
+            vector<char> bloque; /*!< Datos leidos */
+            size_t pos = 0; /*!< Siguiente caracter sin procesar */
+            size_t fin_datos = 0; /*!< Fin de los datos validos del bloque */
+            bool agotado = false; /*!< Se llego al fin del archivo */
+            size_t linea = 1; /*!< Linea actual, para los mensajes de error */
+            bool inicio_linea = true; /*!< No se ha leido ningun valor en la linea actual */
+
+            /**
+             * @brief Conserva los datos no procesados al inicio del bloque y lee mas
+             * @return false si no se pudo leer nada
+            */
+            bool llenar(){
+                if (agotado){
+                    return false;
+                }
+                size_t resto = fin_datos - pos;
+                if (resto == bloque.size()){
+                    // Un solo valor no cabe en el bloque
+                    bloque.resize(2 * bloque.size());
+                }
+                std::memmove(bloque.data(), bloque.data() + pos, resto);
+                pos = 0;
+                fin_datos = resto;
+                size_t leidos = std::fread(bloque.data() + fin_datos, 1, bloque.size() - fin_datos, archivo);
+                fin_datos += leidos;
+                if (leidos == 0){
+                    agotado = true;
+                }
+                return leidos > 0;
+            }
+
+            static bool es_separador(char c){
+                return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',' || c == ';';
+            }
+
+            /** @brief Descarta hasta el fin de la linea actual */
+            void saltar_linea(){
+                while (true){
+                    if (pos == fin_datos && !llenar()){
+                        return;
+                    }
+                    const char *inicio = bloque.data() + pos;
+                    const void *salto = std::memchr(inicio, '\n', fin_datos - pos);
+                    if (salto != nullptr){
+                        pos += (const char *)salto - inicio;
+                        return;
+                    }
+                    pos = fin_datos;
+                }
+            }
+
+            /**
+             * @brief Avanza hasta el inicio del siguiente valor
+             * @return false si se llego al fin del archivo
+            */
+            bool saltar_separadores(){
+                while (true){
+                    if (pos == fin_datos && !llenar()){
+                        return false;
+                    }
+                    char c = bloque[pos];
+                    if (c == '\n'){
+                        linea++;
+                        pos++;
+                        inicio_linea = true;
+                    } else if (es_separador(c)){
+                        pos++;
+                    } else if (c == '#' && inicio_linea){
+                        saltar_linea();
+                    } else {
+                        return true;
+                    }
+                }
+            }
+
+            /**
+             * @brief Longitud del valor que empieza en pos; lee mas datos si el valor llega al fin del bloque
+            */
+            size_t longitud_token(){
+                size_t k = pos;
+                while (true){
+                    while (k < fin_datos && !es_separador(bloque[k])){
+                        k++;
+                    }
+                    if (k < fin_datos || agotado){
+                        return k - pos;
+                    }
+                    size_t avance = k - pos;
+                    if (!llenar()){
+                        return avance;
+                    }
+                    k = pos + avance;
+                }
+            }
+    };
+
+    /**
+     * @brief Agrega los reales al texto, uno por linea, en la representacion mas corta que se lee de vuelta igual
+     * @param valores Reales a formatear
+     * @param texto Texto al que se agregan
+    */
+    inline void formatear(span<const double> valores, vector<char> &texto){
+        // El real mas largo ocupa 24 caracteres, mas el salto de linea
+        size_t usado = texto.size();
+        texto.resize(usado + 25 * valores.size());
+        char *fin = texto.data() + texto.size();
+        for (double v : valores){
+            char *inicio = texto.data() + usado;
+            auto [ptr, ec] = std::to_chars(inicio, fin, v);
+            *ptr = '\n';
+            usado += ptr + 1 - inicio;
+        }
+        texto.resize(usado);
+    }
+
+    /**
+     * @brief Escritor de reales, uno por linea, en la representacion mas corta que se lee de vuelta igual
+    */
+    class escritor_reales {
+        public:
+            /**
+             * @brief Crea un escritor sobre un archivo abierto; no lo cierra
+             * @param p_archivo Archivo de salida
+             * @param capacidad Tamaño del bloque de escritura en bytes
+            */
+            explicit escritor_reales(FILE *p_archivo, size_t capacidad = 1 << 20)
+                : archivo(p_archivo), bloque(capacidad < 64 ? 64 : capacidad){
+            }
+
+            escritor_reales(const escritor_reales &) = delete;
+            escritor_reales &operator=(const escritor_reales &) = delete;
+
+            ~escritor_reales(){
+                vaciar();
+            }
+
+            /**
+             * @brief Escribe un real seguido de un salto de linea
+            */
+            void escribir(double v){
+                // El real mas largo ocupa 24 caracteres
+                if (bloque.size() - usado < 32){
+                    vaciar();
+                }
+                char *inicio = bloque.data() + usado;
+                auto [ptr, ec] = std::to_chars(inicio, bloque.data() + bloque.size() - 1, v);
+                *ptr = '\n';
+                usado += ptr + 1 - inicio;
+            }
+
+            /**
+             * @brief Escribe los reales, uno por linea
+            */
+            void escribir(span<const double> valores){
+                for (double v : valores){
+                    escribir(v);
+                }
+            }
+
+            /**
+             * @brief Escribe texto ya formateado
+            */
+            void escribir_texto(span<const char> texto){
+                if (texto.size() > bloque.size() - usado){
+                    vaciar();
+                    if (texto.size() > bloque.size()){
+                        std::fwrite(texto.data(), 1, texto.size(), archivo);
+                        return;
+                    }
+                }
+                std::memcpy(bloque.data() + usado, texto.data(), texto.size());
+                usado += texto.size();
+            }
+
+            /**
+             * @brief Escribe en el archivo lo que haya en el bloque
+            */
+            void vaciar(){
+                if (usado > 0){
+                    std::fwrite(bloque.data(), 1, usado, archivo);
+                    usado = 0;
+                }
+            }
+
+        private:
+            FILE *archivo; /*!< Archivo de salida */
+            vector<char> bloque; /*!< Texto pendiente de escribir */
+            size_t usado = 0; /*!< Bytes ocupados del bloque */
+    };
+}
+
+#endif
@@ -0,0 +1,450 @@
+/**
+ * @file
+ * @brief Instrumentacion opcional: llamadas, latencias y asignaciones por metodo
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Solo se activa al compilar con -DINSTRUMENTAR. Sin esa macro, MEDIR y
+ * CONTAR se expanden a nada y no queda ningun costo en los metodos.
+ *
+ * Con la macro activa:
+ * - MEDIR("nombre") mide el bloque donde aparece: cantidad de llamadas,
+ *   tiempo total, histograma de latencias (p50, p90, p99, p99.9, maximo) y
+ *   asignaciones de memoria del hilo durante el bloque, incluidos los
+ *   bloques medidos que contiene.
+ * - CONTAR("nombre", cantidad) suma a un contador.
+ * - Las consultas de un punto (interpolar) no abren bloques medidos: el
+ *   bloque costaria tanto como la consulta. Se miden los lotes (evaluar),
+ *   los ajustes y las construcciones.
+ * - instrumentacion::volcar(archivo) escribe todo en JSON en cualquier momento.
+ * - Si la variable de entorno INTERPOLACION_METRICAS tiene una ruta (o -
+ *   para la salida de errores), el JSON se escribe ahi al terminar el programa.
+ *
+ * Las asignaciones solo se cuentan si el programa escribe una vez, fuera de
+ * toda funcion, "INSTRUMENTACION_REEMPLAZAR_NEW;". Esa macro reemplaza los
+ * operator new y delete globales, incluidas las versiones alineadas que usa
+ * std::pmr::new_delete_resource. Un programa que ademas lleve su propia
+ * cuenta (como benchmark.cpp) usa "INSTRUMENTACION_REEMPLAZAR_NEW_CON(f);",
+ * que llama a f(tamano) en cada asignacion y existe aun sin -DINSTRUMENTAR.
+*/
+
+#ifndef INSTRUMENTACION_H
+#define INSTRUMENTACION_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace instrumentacion {
+
+    /** @brief Cuenta adicional vacia de INSTRUMENTACION_REEMPLAZAR_NEW */
+    inline void sin_cuenta_adicional(std::size_t){
+    }
+}
+
+#ifdef INSTRUMENTAR
+
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <string>
+
+namespace instrumentacion {
+
+    inline thread_local uint64_t asignaciones_hilo = 0; /*!< Llamadas a operator new del hilo */
+    inline thread_local uint64_t bytes_hilo = 0; /*!< Bytes pedidos a operator new por el hilo */
+    inline std::atomic<bool> cuenta_asignaciones{false}; /*!< Se reemplazo el operator new */
+
+    /**
+     * @brief Histograma de latencias en nanosegundos con error relativo menor al 3 %
+     *
+     * Como en HdrHistogram, los valores menores que 64 tienen una cubeta cada
+     * uno y cada potencia de dos por encima se divide en 32 cubetas iguales.
+     * Registrar un valor es un incremento atomico, sin bloqueos.
+    */
+    class histograma {
+        public:
+            static constexpr size_t SUBCUBETAS = 32; /*!< Cubetas por potencia de dos */
+            static constexpr size_t CUBETAS = 2 * SUBCUBETAS + 58 * SUBCUBETAS; /*!< Cubre todo uint64_t */
+
+            /**
+             * @brief Registra un valor
+            */
+            void registrar(uint64_t v){
+                cuentas[indice(v)].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            /**
+             * @brief Valor por debajo del cual esta la fraccion q de los registros
+             * @param q Fraccion entre 0 y 1
+             * @return Punto medio de la cubeta correspondiente; 0 si no hay registros
+            */
+            uint64_t percentil(double q) const {
+                uint64_t total = 0;
+                for (const std::atomic<uint64_t> &c : cuentas){
+                    total += c.load(std::memory_order_relaxed);
+                }
+                if (total == 0){
+                    return 0;
+                }
+                uint64_t objetivo = (uint64_t)(q * (double)(total - 1)) + 1;
+                uint64_t acumulado = 0;
+                for (size_t i = 0; i < CUBETAS; i++){
+                    acumulado += cuentas[i].load(std::memory_order_relaxed);
+                    if (acumulado >= objetivo){
+                        return valor(i);
+                    }
+                }
+                return valor(CUBETAS - 1);
+            }
+
+            /**
+             * @brief Borra los registros
+            */
+            void reiniciar(){
+                for (std::atomic<uint64_t> &c : cuentas){
+                    c.store(0, std::memory_order_relaxed);
+                }
+            }
+
+        private:
+            std::atomic<uint64_t> cuentas[CUBETAS] = {}; /*!< Registros por cubeta */
+
+            static size_t indice(uint64_t v){
+                if (v < 2 * SUBCUBETAS){
+                    return (size_t)v;
+                }
+                size_t e = (size_t)std::bit_width(v) - 6; // v >> e queda en [32, 64)
+                return 2 * SUBCUBETAS + (e - 1) * SUBCUBETAS + (size_t)((v >> e) - SUBCUBETAS);
+            }
+
+            static uint64_t valor(size_t i){
+                if (i < 2 * SUBCUBETAS){
+                    return i;
+                }
+                size_t e = (i - 2 * SUBCUBETAS) / SUBCUBETAS + 1;
+                uint64_t sub = (i - 2 * SUBCUBETAS) % SUBCUBETAS + SUBCUBETAS;
+                return (sub << e) + ((uint64_t)1 << (e - 1));
+            }
+    };
+
+    /**
+     * @brief Estadisticas de un bloque medido
+    */
+    struct metrica {
+        std::string nombre; /*!< Nombre del bloque, por ejemplo "spline3::evaluar" */
+        std::atomic<uint64_t> llamadas{0}; /*!< Veces que se ejecuto */
+        std::atomic<uint64_t> total_ns{0}; /*!< Tiempo acumulado */
+        std::atomic<uint64_t> maximo_ns{0}; /*!< Llamada mas lenta */
+        std::atomic<uint64_t> asignaciones{0}; /*!< Llamadas a operator new dentro del bloque */
+        std::atomic<uint64_t> bytes{0}; /*!< Bytes pedidos dentro del bloque */
+        histograma latencias; /*!< Distribucion de la duracion de cada llamada */
+
+        explicit metrica(std::string p_nombre) : nombre(std::move(p_nombre)){
+        }
+    };
+
+    /**
+     * @brief Contador de eventos
+    */
+    struct contador {
+        std::string nombre; /*!< Nombre del contador */
+        std::atomic<uint64_t> valor{0}; /*!< Suma acumulada */
+
+        explicit contador(std::string p_nombre) : nombre(std::move(p_nombre)){
+        }
+    };
+
+    /**
+     * @brief Registro de todas las metricas y contadores del programa
+     *
+     * Nunca se destruye, para que los hilos que sigan midiendo al terminar el
+     * programa no usen metricas destruidas. Las direcciones de las metricas
+     * no cambian, asi que cada sitio de medicion busca la suya una sola vez.
+    */
+    class registro {
+        public:
+            /**
+             * @brief Registro global; la primera llamada programa el volcado al terminar
+            */
+            static registro &global(){
+                static registro *r = [](){
+                    registro *nuevo = new registro();
+                    std::atexit(al_terminar);
+                    return nuevo;
+                }();
+                return *r;
+            }
+
+            /**
+             * @brief Metrica con el nombre dado; la crea si no existe
+            */
+            metrica &obtener_metrica(const char *nombre){
+                std::lock_guard<std::mutex> guarda(mutex);
+                for (metrica &m : metricas){
+                    if (m.nombre == nombre){
+                        return m;
+                    }
+                }
+                // Lo que se reserva aqui no se cuenta en el bloque que se esta midiendo
+                uint64_t asignaciones = asignaciones_hilo, bytes = bytes_hilo;
+                metrica &nuevo = metricas.emplace_back(nombre);
+                asignaciones_hilo = asignaciones;
+                bytes_hilo = bytes;
+                return nuevo;
+            }
+
+            /**
+             * @brief Contador con el nombre dado; lo crea si no existe
+            */
+            contador &obtener_contador(const char *nombre){
+                std::lock_guard<std::mutex> guarda(mutex);
+                for (contador &c : contadores){
+                    if (c.nombre == nombre){
+                        return c;
+                    }
+                }
+                // Lo que se reserva aqui no se cuenta en el bloque que se esta midiendo
+                uint64_t asignaciones = asignaciones_hilo, bytes = bytes_hilo;
+                contador &nuevo = contadores.emplace_back(nombre);
+                asignaciones_hilo = asignaciones;
+                bytes_hilo = bytes;
+                return nuevo;
+            }
+
+            /**
+             * @brief Escribe las metricas y contadores en JSON
+             * @param archivo Archivo de salida
+            */
+            void volcar(FILE *archivo){
+                std::lock_guard<std::mutex> guarda(mutex);
+                std::fprintf(archivo, "{\n  \"cuenta_asignaciones\": %s,\n  \"metricas\": [",
+                             cuenta_asignaciones.load() ? "true" : "false");
+                bool primero = true;
+                for (const metrica &m : metricas){
+                    uint64_t llamadas = m.llamadas.load(std::memory_order_relaxed);
+                    uint64_t total = m.total_ns.load(std::memory_order_relaxed);
+                    std::fprintf(archivo,
+                                 "%s\n    {\"nombre\": \"%s\", \"llamadas\": %llu, \"total_ns\": %llu, "
+                                 "\"media_ns\": %.1f, \"p50_ns\": %llu, \"p90_ns\": %llu, \"p99_ns\": %llu, "
+                                 "\"p999_ns\": %llu, \"maximo_ns\": %llu, \"asignaciones\": %llu, \"bytes\": %llu}",
+                                 primero ? "" : ",", m.nombre.c_str(), (unsigned long long)llamadas,
+                                 (unsigned long long)total, llamadas > 0 ? (double)total / (double)llamadas : 0.0,
+                                 (unsigned long long)m.latencias.percentil(0.5),
+                                 (unsigned long long)m.latencias.percentil(0.9),
+                                 (unsigned long long)m.latencias.percentil(0.99),
+                                 (unsigned long long)m.latencias.percentil(0.999),
+                                 (unsigned long long)m.maximo_ns.load(std::memory_order_relaxed),
+                                 (unsigned long long)m.asignaciones.load(std::memory_order_relaxed),
+                                 (unsigned long long)m.bytes.load(std::memory_order_relaxed));
+                    primero = false;
+                }
+                std::fprintf(archivo, "\n  ],\n  \"contadores\": [");
+                primero = true;
+                for (const contador &c : contadores){
+                    std::fprintf(archivo, "%s\n    {\"nombre\": \"%s\", \"valor\": %llu}", primero ? "" : ",",
+                                 c.nombre.c_str(), (unsigned long long)c.valor.load(std::memory_order_relaxed));
+                    primero = false;
+                }
+                std::fprintf(archivo, "\n  ]\n}\n");
+                std::fflush(archivo);
+            }
+
+            /**
+             * @brief Pone en cero todas las metricas y contadores
+            */
+            void reiniciar(){
+                std::lock_guard<std::mutex> guarda(mutex);
+                for (metrica &m : metricas){
+                    m.llamadas.store(0, std::memory_order_relaxed);
+                    m.total_ns.store(0, std::memory_order_relaxed);
+                    m.maximo_ns.store(0, std::memory_order_relaxed);
+                    m.asignaciones.store(0, std::memory_order_relaxed);
+                    m.bytes.store(0, std::memory_order_relaxed);
+                    m.latencias.reiniciar();
+                }
+                for (contador &c : contadores){
+                    c.valor.store(0, std::memory_order_relaxed);
+                }
+            }
+
+        private:
+            std::mutex mutex; /*!< Protege las listas al registrar y volcar */
+            std::deque<metrica> metricas; /*!< Metricas; deque no mueve los elementos */
+            std::deque<contador> contadores; /*!< Contadores */
+
+            registro() = default;
+
+            static void al_terminar(){
+                const char *ruta = std::getenv("INTERPOLACION_METRICAS");
+                if (ruta == nullptr || *ruta == '\0'){
+                    return;
+                }
+                if (std::string(ruta) == "-"){
+                    global().volcar(stderr);
+                    return;
+                }
+                FILE *archivo = std::fopen(ruta, "w");
+                if (archivo != nullptr){
+                    global().volcar(archivo);
+                    std::fclose(archivo);
+                }
+            }
+    };
+
+    /**
+     * @brief Escribe las metricas y contadores en JSON
+     * @param archivo Archivo de salida
+    */
+    inline void volcar(FILE *archivo){
+        registro::global().volcar(archivo);
+    }
+
+    /**
+     * @brief Pone en cero todas las metricas y contadores
+    */
+    inline void reiniciar(){
+        registro::global().reiniciar();
+    }
+
+    /**
+     * @brief Mide el tiempo y las asignaciones entre su construccion y su destruccion
+    */
+    class cronometro {
+        public:
+            explicit cronometro(metrica &p_m)
+                : m(p_m), asignaciones(asignaciones_hilo), bytes(bytes_hilo),
+                  inicio(std::chrono::steady_clock::now()){
+            }
+
+            cronometro(const cronometro &) = delete;
+            cronometro &operator=(const cronometro &) = delete;
+
+            ~cronometro(){
+                uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - inicio).count();
+                m.llamadas.fetch_add(1, std::memory_order_relaxed);
+                m.total_ns.fetch_add(ns, std::memory_order_relaxed);
+                m.asignaciones.fetch_add(asignaciones_hilo - asignaciones, std::memory_order_relaxed);
+                m.bytes.fetch_add(bytes_hilo - bytes, std::memory_order_relaxed);
+                uint64_t maximo = m.maximo_ns.load(std::memory_order_relaxed);
+                while (ns > maximo && !m.maximo_ns.compare_exchange_weak(maximo, ns, std::memory_order_relaxed)){
+                }
+                m.latencias.registrar(ns);
+            }
+
+        private:
+            metrica &m; /*!< Metrica que se actualiza */
+            uint64_t asignaciones; /*!< asignaciones_hilo al empezar */
+            uint64_t bytes; /*!< bytes_hilo al empezar */
+            std::chrono::steady_clock::time_point inicio; /*!< Momento de la construccion */
+    };
+}
+
+#define INSTRUMENTACION_UNIR_(a, b) a##b
+#define INSTRUMENTACION_UNIR(a, b) INSTRUMENTACION_UNIR_(a, b)
+
+/** @brief Mide el resto del bloque actual con la metrica nombre */
+#define MEDIR(nombre) \
+    static instrumentacion::metrica &INSTRUMENTACION_UNIR(metrica_, __LINE__) = \
+        instrumentacion::registro::global().obtener_metrica(nombre); \
+    instrumentacion::cronometro INSTRUMENTACION_UNIR(cronometro_, __LINE__)(INSTRUMENTACION_UNIR(metrica_, __LINE__))
+
+/** @brief Suma cantidad al contador nombre */
+#define CONTAR(nombre, cantidad) \
+    do { \
+        static instrumentacion::contador &c_ = instrumentacion::registro::global().obtener_contador(nombre); \
+        c_.valor.fetch_add((uint64_t)(cantidad), std::memory_order_relaxed); \
+    } while (0)
+
+/** @brief Cuenta una asignacion en el hilo actual */
+#define INSTRUMENTACION_CONTAR_ASIGNACION(tamano) \
+    (instrumentacion::asignaciones_hilo++, instrumentacion::bytes_hilo += (tamano))
+
+/** @brief Marca que el operator new fue reemplazado, para reportar las asignaciones */
+#define INSTRUMENTACION_MARCAR_REEMPLAZO \
+    static const bool instrumentacion_new_reemplazado = (instrumentacion::cuenta_asignaciones = true)
+
+/** @brief Reemplaza el operator new global para contar asignaciones; usar una sola vez por programa */
+#define INSTRUMENTACION_REEMPLAZAR_NEW INSTRUMENTACION_REEMPLAZAR_NEW_CON(instrumentacion::sin_cuenta_adicional)
+
+#else
+
+#define MEDIR(nombre) ((void)0)
+#define CONTAR(nombre, cantidad) ((void)0)
+#define INSTRUMENTACION_REEMPLAZAR_NEW static_assert(true)
+#define INSTRUMENTACION_CONTAR_ASIGNACION(tamano) ((void)0)
+#define INSTRUMENTACION_MARCAR_REEMPLAZO static_assert(true)
+
+#endif
+
+// El operator delete reemplazado libera con free la memoria que el operator new
+// reemplazado obtuvo con malloc o aligned_alloc; GCC no lo reconoce al expandir las llamadas en linea
+#if defined(__GNUC__) && !defined(__clang__)
+#define INSTRUMENTACION_IGNORAR_NEW_DELETE _Pragma("GCC diagnostic ignored \"-Wmismatched-new-delete\"")
+#else
+#define INSTRUMENTACION_IGNORAR_NEW_DELETE
+#endif
+
+/**
+ * @brief Reemplaza los operator new y delete globales, con y sin alineacion; usar una sola vez por programa
+ * @param contar Funcion que recibe el tamaño de cada asignacion, ademas de la cuenta de la instrumentacion
+*/
+#define INSTRUMENTACION_REEMPLAZAR_NEW_CON(contar) \
+    INSTRUMENTACION_IGNORAR_NEW_DELETE \
+    void *operator new(std::size_t tamano){ \
+        INSTRUMENTACION_CONTAR_ASIGNACION(tamano); \
+        contar(tamano); \
+        if (void *p = std::malloc(tamano == 0 ? 1 : tamano)){ \
+            return p; \
+        } \
+        throw std::bad_alloc(); \
+    } \
+    void *operator new[](std::size_t tamano){ \
+        return ::operator new(tamano); \
+    } \
+    void *operator new(std::size_t tamano, std::align_val_t alineacion){ \
+        INSTRUMENTACION_CONTAR_ASIGNACION(tamano); \
+        contar(tamano); \
+        std::size_t a = ((std::size_t)alineacion < sizeof(void *)) ? sizeof(void *) : (std::size_t)alineacion; \
+        if (void *p = std::aligned_alloc(a, (tamano == 0) ? a : (tamano + a - 1) / a * a)){ \
+            return p; \
+        } \
+        throw std::bad_alloc(); \
+    } \
+    void *operator new[](std::size_t tamano, std::align_val_t alineacion){ \
+        return ::operator new(tamano, alineacion); \
+    } \
+    void operator delete(void *p) noexcept { \
+        std::free(p); \
+    } \
+    void operator delete[](void *p) noexcept { \
+        std::free(p); \
+    } \
+    void operator delete(void *p, std::size_t) noexcept { \
+        std::free(p); \
+    } \
+    void operator delete[](void *p, std::size_t) noexcept { \
+        std::free(p); \
+    } \
+    void operator delete(void *p, std::align_val_t) noexcept { \
+        std::free(p); \
+    } \
+    void operator delete[](void *p, std::align_val_t) noexcept { \
+        std::free(p); \
+    } \
+    void operator delete(void *p, std::size_t, std::align_val_t) noexcept { \
+        std::free(p); \
+    } \
+    void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { \
+        std::free(p); \
+    } \
+    INSTRUMENTACION_MARCAR_REEMPLAZO
+
+#endif
@@ -0,0 +1,371 @@
+/**
+ * @file
+ * @brief Interpolacion inversa: todos los x en que un trazador toma un valor dado
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Cada intervalo del trazador es un cubico p(t), t = x - x[i - 1], cuyo
+ * minimo y maximo estan en los extremos o en los ceros de p'(t). Esos
+ * rangos se guardan en un arbol de segmentos: cada nodo tiene el minimo y
+ * el maximo de los intervalos que cubre, y una consulta solo baja por los
+ * nodos cuyo rango contiene el valor buscado. Encontrar los k intervalos
+ * candidatos cuesta O(log n + k log n), en lugar de recorrer los n.
+ *
+ * En cada intervalo los ceros de p'(t) lo parten en tramos monotonos; en
+ * cada tramo con cambio de signo hay exactamente un cruce, que se calcula
+ * con Newton protegido por biseccion: el paso de Newton se toma si cae
+ * dentro del tramo que encierra el cruce y lo reduce lo suficiente, y si
+ * no se biseca.
+ *
+ * Los cruces se reportan ordenados y sin repetir. En los datos se usan los
+ * valores y[i] exactos, y cada cruce en un dato x[i] lo reporta un solo
+ * intervalo. Donde el trazador es constante e igual al valor buscado se
+ * reporta el inicio de cada intervalo constante.
+*/
+
+#ifndef INVERSA_H
+#define INVERSA_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "cubica_local.h"
+#include "instrumentacion.h"
+#include "paralelo.h"
+#include "spline3.h"
+
+using std::size_t;
+using std::span;
+using std::vector;
+using std::invalid_argument;
+
+namespace interpolacion {
+
+    /**
+     * @brief Cruces de un lote de valores, en un solo arreglo
+    */
+    struct cruces_lote {
+        vector<double> x; /*!< Cruces de todos los valores, seguidos */
+        vector<size_t> inicio; /*!< Los cruces del valor k son x[inicio[k]] .. x[inicio[k + 1] - 1] */
+
+        /** @brief Cantidad de valores consultados */
+        size_t size() const {
+            return inicio.empty() ? 0 : inicio.size() - 1;
+        }
+
+        /** @brief Cruces del valor k, ordenados */
+        span<const double> operator[](size_t k) const {
+            return span<const double>(x.data() + inicio[k], inicio[k + 1] - inicio[k]);
+        }
+    };
+
+    /**
+     * @brief Indice para resolver S(x) = y sobre un trazador cubico por tramos
+    */
+    class inversa {
+        public:
+            /**
+             * @brief Indice de un trazador cubico
+             * @param s Trazador ajustado, con al menos 2 datos
+            */
+            explicit inversa(const spline3 &s){
+                preparar(s.datos_x(), s.datos_y());
+                s.coeficientes(coef);
+                construir_arbol();
+            }
+
+            /**
+             * @brief Indice de una interpolacion cubica local (pchip o akima)
+             * @param s Interpolacion ajustada
+            */
+            template <esquema E>
+            explicit inversa(const basic_cubica_local<double, E> &s){
+                span<const double> px = s.datos_x();
+                span<const double> py = s.datos_y();
+                span<const double> d = s.pendientes();
+                preparar(px, py);
+                for (size_t i = 1; i < px.size(); i++){
+                    double h = px[i] - px[i - 1];
+                    double delta = (py[i] - py[i - 1]) / h;
+                    double *c = coef.data() + 4 * (i - 1);
+                    c[0] = py[i - 1];
+                    c[1] = d[i - 1];
+                    c[2] = (3.0 * delta - 2.0 * d[i - 1] - d[i]) / h;
+                    c[3] = (d[i - 1] + d[i] - 2.0 * delta) / (h * h);
+                }
+                construir_arbol();
+            }
+
+            /**
+             * @brief Todos los x en que el trazador vale objetivo
+             * @param objetivo Valor buscado
+             * @return Cruces en orden creciente; vacio si no hay o si objetivo es NaN
+            */
+            vector<double> cruces(double objetivo) const {
+                vector<double> salida;
+                cruces(objetivo, salida);
+                return salida;
+            }
+
+            /**
+             * @brief Agrega al final de salida los x en que el trazador vale objetivo
+             * @param objetivo Valor buscado
+             * @param salida Cruces en orden creciente, a continuacion de lo que ya tenga
+            */
+            void cruces(double objetivo, vector<double> &salida) const {
+                const size_t primero = salida.size();
+                // Recorrido en profundidad de izquierda a derecha: los intervalos salen en orden
+                std::array<size_t, 2 * std::numeric_limits<size_t>::digits> pila;
+                size_t tope = 0;
+                pila[tope++] = 1;
+                while (tope > 0){
+                    size_t nodo = pila[--tope];
+                    if (!(rango[nodo].minimo <= objetivo && objetivo <= rango[nodo].maximo)){
+                        continue;
+                    }
+                    if (nodo >= hojas){
+                        CONTAR("inversa::intervalos", 1);
+                        raices(nodo - hojas + 1, objetivo, salida, primero);
+                        continue;
+                    }
+                    pila[tope++] = 2 * nodo + 1;
+                    pila[tope++] = 2 * nodo;
+                }
+            }
+
+            /**
+             * @brief Cruces de un lote de valores, repartido entre los hilos
+             * @param objetivos Valores buscados
+             * @param grano Valores por tarea paralela
+            */
+            cruces_lote cruces(span<const double> objetivos, size_t grano = 1 << 10) const {
+                MEDIR("inversa::cruces");
+                grano = std::max<size_t>(1, grano);
+                const size_t total = objetivos.size();
+                const size_t tareas = (total + grano - 1) / grano;
+
+                // Cada tarea junta sus cruces aparte; luego se copian en orden
+                vector<vector<double>> partes(tareas);
+                cruces_lote lote;
+                lote.inicio.assign(total + 1, 0);
+                paralelo::para_cada(tareas, [&](size_t tarea){
+                    size_t fin = std::min(total, (tarea + 1) * grano);
+                    for (size_t k = tarea * grano; k < fin; k++){
+                        cruces(objetivos[k], partes[tarea]);
+                        lote.inicio[k + 1] = partes[tarea].size();
+                    }
+                });
+
+                size_t acumulado = 0;
+                for (size_t tarea = 0; tarea < tareas; tarea++){
+                    size_t fin = std::min(total, (tarea + 1) * grano);
+                    for (size_t k = tarea * grano; k < fin; k++){
+                        lote.inicio[k + 1] += acumulado;
+                    }
+                    acumulado += partes[tarea].size();
+                }
+                lote.x.reserve(acumulado);
+                for (const vector<double> &parte : partes){
+                    lote.x.insert(lote.x.end(), parte.begin(), parte.end());
+                }
+                return lote;
+            }
+
+            /** @brief Valor minimo del trazador en el rango de los datos */
+            double minimo() const {
+                return rango[1].minimo;
+            }
+
+            /** @brief Valor maximo del trazador en el rango de los datos */
+            double maximo() const {
+                return rango[1].maximo;
+            }
+
+        private:
+            /** @brief Minimo y maximo de un nodo del arbol */
+            struct extremos {
+                double minimo = std::numeric_limits<double>::infinity(); /*!< Minimo de los intervalos del nodo */
+                double maximo = -std::numeric_limits<double>::infinity(); /*!< Maximo de los intervalos del nodo */
+            };
+
+            vector<double> x; /*!< Variable independiente */
+            vector<double> y; /*!< Variable dependiente */
+            vector<double> coef; /*!< c0..c3 de cada intervalo en t = x - x[i - 1] */
+            size_t hojas = 1; /*!< Hojas del arbol, potencia de 2 >= intervalos */
+            vector<extremos> rango; /*!< Arbol de segmentos: raiz en 1, hijos de k en 2k y 2k + 1 */
+
+            void preparar(span<const double> px, span<const double> py){
+                if (px.size() < 2 || py.size() != px.size()){
+                    throw invalid_argument("Se necesitan al menos 2 datos para invertir el trazador");
+                }
+                for (size_t i = 1; i < px.size(); i++){
+                    if (!(px[i] > px[i - 1])){
+                        throw invalid_argument("Los datos de x deben estar ordenados de forma estrictamente creciente");
+                    }
+                }
+                x.assign(px.begin(), px.end());
+                y.assign(py.begin(), py.end());
+                coef.assign(4 * (x.size() - 1), 0.0);
+            }
+
+            /** @brief Valor del polinomio del intervalo i en t */
+            double polinomio(size_t i, double t) const {
+                const double *c = coef.data() + 4 * (i - 1);
+                return c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+            }
+
+            /**
+             * @brief Bordes de los tramos monotonos del intervalo i: 0, los ceros de p' en (0, h) y h
+             * @return Cantidad de bordes, de 2 a 4
+            */
+            size_t tramos(size_t i, std::array<double, 4> &bordes) const {
+                const double *c = coef.data() + 4 * (i - 1);
+                const double h = x[i] - x[i - 1];
+                // p'(t) = c1 + 2 c2 t + 3 c3 t^2
+                double a = 3.0 * c[3], b = 2.0 * c[2], d = c[1];
+                std::array<double, 2> r;
+                size_t k = 0;
+                if (a == 0.0){
+                    if (b != 0.0){
+                        r[k++] = -d / b;
+                    }
+                } else {
+                    double disc = b * b - 4.0 * a * d;
+                    if (disc > 0.0){
+                        // Formula estable: q y luego las dos raices sin restar numeros parecidos
+                        double q = -0.5 * (b + std::copysign(std::sqrt(disc), b));
+                        r[k++] = q / a;
+                        if (q != 0.0){
+                            r[k++] = d / q;
+                        }
+                    }
+                }
+                if (k == 2 && r[0] > r[1]){
+                    std::swap(r[0], r[1]);
+                }
+                size_t n = 0;
+                bordes[n++] = 0.0;
+                for (size_t j = 0; j < k; j++){
+                    if (r[j] > 0.0 && r[j] < h){
+                        bordes[n++] = r[j];
+                    }
+                }
+                bordes[n++] = h;
+                return n;
+            }
+
+            /**
+             * @brief Cruce en un tramo monotono [a, b] con g(a) y g(b) de signo contrario, g = p - objetivo
+            */
+            double resolver(size_t i, double objetivo, double a, double b, double ga) const {
+                const double *c = coef.data() + 4 * (i - 1);
+                // bajo tiene el signo de g(a) y alto el contrario
+                double bajo = a, alto = b;
+                double t = 0.5 * (a + b);
+                const double tolerancia = 4.0 * std::numeric_limits<double>::epsilon() * (std::fabs(x[i - 1]) + std::fabs(b));
+                double paso_anterior = std::fabs(b - a);
+                for (int iteracion = 0; iteracion < 100; iteracion++){
+                    double g = c[0] + t * (c[1] + t * (c[2] + t * c[3])) - objetivo;
+                    if (g == 0.0){
+                        return t;
+                    }
+                    if ((g < 0.0) == (ga < 0.0)){
+                        bajo = t;
+                    } else {
+                        alto = t;
+                    }
+                    double dg = c[1] + t * (2.0 * c[2] + t * 3.0 * c[3]);
+                    double siguiente = t - g / dg;
+                    double menor = std::min(bajo, alto), mayor = std::max(bajo, alto);
+                    // Newton si queda dentro del tramo y al menos reduce a la mitad el paso de hace dos iteraciones
+                    if (!(siguiente > menor && siguiente < mayor) || std::fabs(siguiente - t) * 2.0 > paso_anterior){
+                        CONTAR("inversa::bisecciones", 1);
+                        siguiente = 0.5 * (bajo + alto);
+                    }
+                    paso_anterior = std::fabs(siguiente - t);
+                    if (siguiente == t || mayor - menor <= tolerancia){
+                        return siguiente;
+                    }
+                    t = siguiente;
+                }
+                return t;
+            }
+
+            /**
+             * @brief Agrega los cruces del intervalo i, en [x[i - 1], x[i]) salvo el ultimo, que incluye x[i]
+             * @param primero Primer cruce de esta consulta en salida, para no repetir
+            */
+            void raices(size_t i, double objetivo, vector<double> &salida, size_t primero) const {
+                auto agregar = [&](double v){
+                    if (salida.size() == primero || v > salida.back()){
+                        salida.push_back(v);
+                    }
+                };
+                const double *c = coef.data() + 4 * (i - 1);
+                const double h = x[i] - x[i - 1];
+                if (c[1] == 0.0 && c[2] == 0.0 && c[3] == 0.0){
+                    if (c[0] == objetivo){
+                        agregar(x[i - 1]);
+                    }
+                    return;
+                }
+
+                std::array<double, 4> bordes;
+                size_t n = tramos(i, bordes);
+                // En los datos se usan los valores exactos, no el polinomio redondeado
+                double ga = y[i - 1] - objetivo;
+                for (size_t k = 1; k < n; k++){
+                    double b = bordes[k];
+                    double gb = (k == n - 1) ? y[i] - objetivo : polinomio(i, b) - objetivo;
+                    if (ga == 0.0){
+                        agregar(x[i - 1] + bordes[k - 1]);
+                    } else if (gb != 0.0 && (ga < 0.0) != (gb < 0.0)){
+                        agregar(x[i - 1] + resolver(i, objetivo, bordes[k - 1], b, ga));
+                    }
+                    ga = gb;
+                }
+                if (ga == 0.0 && i == x.size() - 1){
+                    agregar(x[i - 1] + h);
+                }
+            }
+
+            void construir_arbol(){
+                MEDIR("inversa::construir");
+                const size_t intervalos = x.size() - 1;
+                hojas = 1;
+                while (hojas < intervalos){
+                    hojas *= 2;
+                }
+                rango.assign(2 * hojas, extremos{});
+                const size_t GRANO = 1 << 12;
+                paralelo::para_cada((intervalos + GRANO - 1) / GRANO, [&](size_t tarea){
+                    size_t fin = std::min(intervalos, (tarea + 1) * GRANO);
+                    for (size_t j = tarea * GRANO; j < fin; j++){
+                        size_t i = j + 1;
+                        std::array<double, 4> bordes;
+                        size_t n = tramos(i, bordes);
+                        extremos &e = rango[hojas + j];
+                        e.minimo = std::min(y[i - 1], y[i]);
+                        e.maximo = std::max(y[i - 1], y[i]);
+                        for (size_t k = 1; k + 1 < n; k++){
+                            double v = polinomio(i, bordes[k]);
+                            e.minimo = std::min(e.minimo, v);
+                            e.maximo = std::max(e.maximo, v);
+                        }
+                    }
+                });
+                for (size_t nodo = hojas; nodo-- > 1;){
+                    rango[nodo].minimo = std::min(rango[2 * nodo].minimo, rango[2 * nodo + 1].minimo);
+                    rango[nodo].maximo = std::max(rango[2 * nodo].maximo, rango[2 * nodo + 1].maximo);
+                }
+            }
+    };
+}
+
+#endif
@@ -14,51 +14,166 @@
 #include <string>
 #include <algorithm>    
 #include <iostream>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "arena.h"
+#include "datos.h"
+#include "instrumentacion.h"
 #include "newton.h"
 
 using std::cout;
 using std::endl;
 using std::vector;
+using std::span;
 using std::string;
 using std::ostringstream;
 using std::abs;
 using std::nan;
 using std::lower_bound;
+using std::invalid_argument;
 using std::max;
 using std::min;
 
 namespace interpolacion {
 
-    class lagrange {
-        /**
-         * @brief Interpolacion mediante el metodo de Lagrange
-        */
+    /**
+     * @brief Interpolacion mediante el metodo de Lagrange
+     *
+     * Los coeficientes siempre se calculan en double; T es el tipo en que se
+     * guardan los datos y se evalua el polinomio.
+     *
+     * @tparam T double o float
+    */
+    template <typename T>
+    class basic_lagrange {
         public:
+            using datos = util::basic_datos<T>; /*!< Arreglo de T propio o prestado */
+
             /**
              * @brief Construye una instancia del metodo de Lagrange
-             * @param p_x Variable independiente, valores de x
-             * @param p_y Variable dependiente, valores de y
+             * @param p_x Variable independiente
+             * @param p_y Variable dependiente
+             * @note Copia x e y (una asignacion de memoria por arreglo)
+            */
+            basic_lagrange(span<const T> p_x, span<const T> p_y):x(p_x), y(p_y){
+                calcular_coeficientes();
+            }
+
+            /**
+             * @brief Construye una instancia del metodo de Lagrange, moviendo los vectores sin copiarlos
+             * @param p_x Variable independiente
+             * @param p_y Variable dependiente
+             * @note No asigna memoria para x e y
+            */
+            basic_lagrange(vector<T> &&p_x, vector<T> &&p_y):x(std::move(p_x)), y(std::move(p_y)){
+                calcular_coeficientes();
+            }
+
+            /**
+             * @brief Construye una instancia del metodo de Lagrange, tomando prestados los datos
+             * @param p_x Variable independiente; debe existir mientras exista la instancia
+             * @param p_y Variable dependiente; debe existir mientras exista la instancia
+             * @note No copia x ni y ni asigna memoria para ellos
             */
-            lagrange( vector <double> p_x, vector <double> p_y): x(p_x), y(p_y){
+            basic_lagrange(util::prestado_t, span<const T> p_x, span<const T> p_y):x(util::prestado, p_x), y(util::prestado, p_y){
                 calcular_coeficientes();
-            }   
+            }
+
+            /**
+             * @brief Construye una instancia del metodo de Lagrange con los coeficientes ya calculados, sin recalcularlos
+             * @param p_x Variable independiente
+             * @param p_y Variable dependiente
+             * @param p_b Coeficientes del polinomio (ver coeficientes()), propios o prestados
+            */
+            basic_lagrange(vector<T> &&p_x, vector<T> &&p_y, datos p_b):x(std::move(p_x)), y(std::move(p_y)), b(std::move(p_b)){
+                validar_coeficientes();
+            }
+
+            /**
+             * @brief Construye una instancia del metodo de Lagrange con los coeficientes ya calculados, tomando prestados los datos
+             * @param p_x Variable independiente; debe existir mientras exista la instancia
+             * @param p_y Variable dependiente; debe existir mientras exista la instancia
+             * @param p_b Coeficientes del polinomio (ver coeficientes()), propios o prestados
+            */
+            basic_lagrange(util::prestado_t, span<const T> p_x, span<const T> p_y, datos p_b):x(util::prestado, p_x), y(util::prestado, p_y), b(std::move(p_b)){
+                validar_coeficientes();
+            }
+
+            /**
+             * @brief Copia un polinomio ya ajustado convirtiendo sus datos a T, sin recalcular los coeficientes
+             * @param otro Polinomio ajustado, por ejemplo en double para evaluarlo en float
+            */
+            template <typename U>
+            explicit basic_lagrange(const basic_lagrange<U> &otro)
+                : x(util::convertir<T>(otro.datos_x())), y(util::convertir<T>(otro.datos_y())),
+                  b(util::convertir<T>(otro.coeficientes())){
+            }
+
+            /**
+             * @brief Coeficientes del polinomio de Newton por todos los datos: el estado ajustado
+            */
+            span<const T> coeficientes() const {
+                return b;
+            }
+
+            /** @brief Variable independiente */
+            span<const T> datos_x() const {
+                return x;
+            }
+
+            /** @brief Variable dependiente */
+            span<const T> datos_y() const {
+                return y;
+            }
 
             /**
              * @brief Interpola el valor de x_int utilizando todos los datos
              * @param x_int Valor de x a interpolar
              * @return Valor interpolado
             */
-            double interpolar(double x_int){
+            T interpolar(T x_int) const {
                 return interpolar(x_int, 0, x.size() - 1);
             }
 
+            /**
+             * @brief Interpola un lote de valores con todos los datos, en O(n) por valor
+             * @param x_int Valores de x a interpolar
+             * @param y_int Salida: valores interpolados, del mismo tamaño que x_int
+             *
+             * El polinomio de Lagrange por todos los datos es el mismo polinomio de
+             * Newton cuyos coeficientes estan en b; se evalua en forma anidada (Horner).
+            */
+            void evaluar(span<const T> x_int, span<T> y_int) const {
+                MEDIR("lagrange::evaluar");
+                CONTAR("lagrange::evaluar::valores", x_int.size());
+                if (x_int.size() != y_int.size()){
+                    throw invalid_argument("x_int e y_int deben tener el mismo tamano");
+                }
+                const size_t m = b.size();
+                for (size_t k = 0; k < x_int.size(); k++){
+                    if (m == 0){
+                        y_int[k] = NAN;
+                        continue;
+                    }
+                    T xk = x_int[k];
+                    T f = b[m - 1];
+                    for (size_t i = m - 1; i > 0; i--){
+                        f = f * (xk - x[i - 1]) + b[i - 1];
+                    }
+                    y_int[k] = f;
+                }
+            }
+
             /**
              * @brief Interpola el valor de x_int utilizando un polinomio del grado especifico
              * @param x_int Valor de x a interpolar sobre el cual se calcula el polinomio p(x)
              * @param grado Grado del polinomio p(x)
              * @return Valor interpolado
             */
-            double interpolar(double x_int, int grado){
+            T interpolar(T x_int, int grado){
                 //Validar que x_int este dentro del rango de x
                 if (x_int < x[0] || x_int >= x[x.size() - 1]){
                     return NAN;
@@ -102,8 +217,8 @@ namespace interpolacion {
                         return interpolar(x_int, pos_Inicial, pos_Final);
                     }
 
-                    double y_int_1 = interpolar(x_int, pos_Inicial, pos_Final);
-                    double y_int_2 = interpolar(x_int, pos_Inicial_aux, pos_Final_aux);
+                    T y_int_1 = interpolar(x_int, pos_Inicial, pos_Final);
+                    T y_int_2 = interpolar(x_int, pos_Inicial_aux, pos_Final_aux);
 
                     if (std::isnan(y_int_1)) {
                         return y_int_2;
@@ -114,18 +229,19 @@ namespace interpolacion {
                     // y_int_1 o y_int_2 son diferente de nan
                     //Sacar los datos de x en el intervalo pos_Inicial_aux, pos_Final_aux con el dato adicional
                     // con un for del x grande (pos_Inicial) sacr los datos a x1 (0), x1 es un subvector de x que tiene desde x[pos_Inicial_aux] hasta x[pos_Final_aux]
-                    vector<double> x1 (x.begin() + pos_Inicial, x.begin() + pos_Final);
+                    span<const T> x1 (x.begin() + pos_Inicial, x.begin() + pos_Final);
 
                     //Sacar los datos de y en el intervalo pos_Inicial_aux, pos_Final_aux con el dato adicional
-                    vector<double> y1 (y.begin() + pos_Inicial, y.begin() + pos_Final);
+                    span<const T> y1 (y.begin() + pos_Inicial, y.begin() + pos_Final);
 
-                    vector<double> F1 = newton::calcular_coeficientes(x1, y1);
+                    std::pmr::vector<double> F1(x1.size(), util::temporales());
+                    basic_newton<T>::calcular_coeficientes(x1, y1, F1);
 
                     //Calcular el error
-                    double prod_1 = 1.0f; //Ultimo coeficiente de F1
+                    double prod_1 = 1.0; //Ultimo coeficiente de F1
 
                     //Quitar el dato adicional del fin
-                    F1.erase(F1.end());
+                    F1.pop_back();
 
                     //Calcular la productoria de R * (x_int - x1[0]) * (x_int - x1[1]) * ... * (x_int - x1[n_puntos - 1]) sin tener en cuenta el dato adicional
                     for (size_t i = 0; i < F1.size(); i++) {
@@ -139,15 +255,16 @@ namespace interpolacion {
                     cout << "   Posicion Inicial: " << pos_Inicial << ", Posicion Final: " << pos_Final << endl;
                     cout << "   Error 1 (R1): " << error_int_1 << endl;
 
-                    vector<double> x2 (x.begin() + pos_Inicial_aux, x.begin() + pos_Final_aux);
+                    span<const T> x2 (x.begin() + pos_Inicial_aux, x.begin() + pos_Final_aux);
 
                     //Sacar los datos de y en el intervalo pos_Inicial_aux, pos_Final_aux con el dato adicional
-                    vector<double> y2 (y.begin() + pos_Inicial_aux, y.begin() + pos_Final_aux);
+                    span<const T> y2 (y.begin() + pos_Inicial_aux, y.begin() + pos_Final_aux);
 
-                    vector<double> F2 = newton::calcular_coeficientes(x2, y2);
+                    std::pmr::vector<double> F2(x2.size(), util::temporales());
+                    basic_newton<T>::calcular_coeficientes(x2, y2, F2);
 
                     //Calcular el error
-                    double prod_2 = 1.0f; //Ultimo coeficiente de F1
+                    double prod_2 = 1.0; //Ultimo coeficiente de F1
 
                     //Quitar el dato adicional del inicio
                     F2.erase(F2.begin());
@@ -180,24 +297,24 @@ namespace interpolacion {
              * @param x_int Valor de x a interpolar
              * @return Valor interpolado
             */
-            double interpolar(double x_int, int pos_Inicial, int pos_final){
-
-                double resultado = 0.0f;
+            T interpolar(T x_int, int pos_Inicial, int pos_final) const {
+                // Los productos de la base se acumulan en double: en float se cancelan mas cifras
+                double resultado = 0.0;
                 int j, k, n;
                 n = x.size();
 
                 if (pos_Inicial < 0 || pos_final >= n) {return NAN;}
 
                 for(j = pos_Inicial; j <= pos_final; j++){
-                    double lj = 1.0f;
+                    double lj = 1.0;
                     for(k = pos_Inicial; k <= pos_final; k++){
                         if(k != j){
-                            lj *= (x_int - x[k]) / (x[j] - x[k]);
+                            lj *= ((double)x_int - x[k]) / ((double)x[j] - x[k]);
                         }
                     }
                     resultado += y[j] * lj;
                 }
-                return resultado;
+                return (T)resultado;
             }
 
             /**
@@ -207,12 +324,12 @@ namespace interpolacion {
              * @param pos_final Posicion final del intervalo
              * @return Error de interpolacion
             */
-            double calcular_error_interpolacion(double x_int, int pos_Inicial, int pos_final){
+            T calcular_error_interpolacion(T x_int, int pos_Inicial, int pos_final) const {
 
-                double valor_interpolado = interpolar(x_int, pos_Inicial, pos_final);
+                T valor_interpolado = interpolar(x_int, pos_Inicial, pos_final);
 
                 int pos = lower_bound(x.begin(), x.end(), x_int) - x.begin();
-                double valor_real = y[pos];
+                T valor_real = y[pos];
 
                 return valor_interpolado - valor_real;
             }
@@ -223,10 +340,10 @@ namespace interpolacion {
              * @param grado Grado del polinomio p(x)
              * @return Error de interpolacion 
             */
-            double calcular_error_interpolacion(double x_int, double valor_interpolado){
+            T calcular_error_interpolacion(T x_int, T valor_interpolado) const {
 
                 int pos = lower_bound(x.begin(), x.end(), x_int) - x.begin();
-                double valor_real = y[pos];
+                T valor_real = y[pos];
 
                 return valor_interpolado - valor_real;
                 
@@ -237,12 +354,12 @@ namespace interpolacion {
              * @param x_int Valor de x a interpolar
              * @return Error de interpolacion
             */
-            double calcular_error_interpolacion(double x_int){
+            T calcular_error_interpolacion(T x_int) const {
                     
-                double valor_interpolado = interpolar(x_int);
+                T valor_interpolado = interpolar(x_int);
 
                 int pos = lower_bound(x.begin(), x.end(), x_int) - x.begin();
-                double valor_real = y[pos];
+                T valor_real = y[pos];
 
                 return valor_interpolado - valor_real;
             }
@@ -251,7 +368,7 @@ namespace interpolacion {
              * @brief Construye y retorna el polinomio interpolante
              * @return Polinomio interpolante
             */
-            string polinomio(){
+            string polinomio() const {
                 ostringstream oss; // Flujo de salida de string
                 ostringstream oss2; // Flujo de salida de string
 
@@ -280,38 +397,31 @@ namespace interpolacion {
 
             /** @brief Calcula los coeficientes del polinomio */
             void calcular_coeficientes(){
-                
-                size_t i,j;
-                size_t n = x.size();
-                
-                // Matriz: vector de vectores
-                vector <vector <double>> f(n);
-
-                for (i = 0; i<n; i++){
-                    f[i].resize(n - i);
+                MEDIR("lagrange::ajuste");
+                if constexpr (std::is_same_v<T, double>){
+                    b = datos(basic_newton<T>::calcular_coeficientes(x, y));
+                } else {
+                    // Los coeficientes en double son temporales: solo se guardan en T
+                    std::pmr::vector<double> c(x.size(), util::temporales());
+                    basic_newton<T>::calcular_coeficientes(x, y, c);
+                    b = datos(util::convertir<T>(span<const double>(c)));
                 }
+            }
 
-                // Llenar la primera columna
-                for (i = 0; i < n; i++){
-                    f[i][0] = y[i];
+            /** @brief Verifica que los coeficientes recibidos correspondan a los datos */
+            void validar_coeficientes() const {
+                if (x.size() != y.size() || b.size() != x.size()){
+                    throw invalid_argument("Se necesita un coeficiente por dato");
                 }
+            }
 
-                // Llenar la matriz con las diferencias divididas
-                for (j = 1; j < n; j++){
-                    for (i = 0; i < n - j; i++){
-                        f[i][j] = (f[i + 1][j - 1] - f[i][j - 1]) / (x[i + j] - x[i]);
-                    }
-                }
-
-                // Tomar los coeficientes de la primera fila de la matriz
-                b = f[0];
-
-            };
-
-            vector <double> x; /*!< Variable independiente */
-            vector <double> y; /*!< Variable dependiente */
-            vector <double> b; /*!< Coeficientes del polinomio */
+            datos x; /*!< Variable independiente */
+            datos y; /*!< Variable dependiente */
+            datos b; /*!< Coeficientes del polinomio */
     };
+
+    using lagrange = basic_lagrange<double>; /*!< Polinomio de Lagrange en double */
+    using lagrange_f = basic_lagrange<float>; /*!< Polinomio de Lagrange en float, ajustado en double */
 }
 
 #endif
\ No newline at end of file
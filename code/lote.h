@@ -0,0 +1,336 @@
+/**
+ * @file
+ * @brief Modo por lotes: evalua un metodo sobre un flujo de valores desde la linea de comandos
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Uso:
+ * - programa <metodo> <archivo_datos> [archivo_consultas]
+ * - programa --guardar <metodo> <archivo_datos> <archivo_binario>
+ *
+ * - metodo: newton, lagrange, spline3, pchip, akima, lineal, potencia, exponencial o cuadratica
+ * - archivo_datos: CSV o TSV con x e y en las dos primeras columnas, separadas por
+ *   tabulador, coma, punto y coma o espacios (csv.h); se admite una linea de
+ *   encabezado, lineas de comentario que empiezan con # y filas con campos vacios,
+ *   que se omiten. El archivo se mapea en memoria y se convierte por bloques en paralelo.
+ *   Tambien puede ser un archivo binario (binario.h) con datos o con el modelo
+ *   ya ajustado; un modelo se mapea en memoria y se evalua sin ajustarlo.
+ * - archivo_consultas: valores de x a evaluar; si se omite o es -, se lee la entrada estandar
+ *
+ * --guardar ajusta el modelo y lo escribe en formato binario; con el metodo
+ * datos solo convierte el archivo de datos.
+ *
+ * Si la variable de entorno INTERPOLACION_CACHE tiene un directorio, el
+ * estado ajustado se guarda ahi y las ejecuciones siguientes con los mismos
+ * datos y metodo no vuelven a ajustar el modelo.
+ *
+ * Escribe un valor por linea en la salida estandar. Las consultas se leen,
+ * evaluan y escriben en bloques; la evaluacion y el formato de cada bloque
+ * se reparten entre los hilos. Con consultas ordenadas la busqueda del
+ * intervalo del trazador cubico es O(1) amortizado.
+*/
+
+#ifndef LOTE_H
+#define LOTE_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binario.h"
+#include "cache.h"
+#include "csv.h"
+#include "cubica_local.h"
+#include "flujo.h"
+#include "lagrange.h"
+#include "newton.h"
+#include "paralelo.h"
+#include "regresion.h"
+#include "spline3.h"
+
+using std::function;
+using std::span;
+using std::string;
+using std::vector;
+using std::invalid_argument;
+
+namespace lote {
+
+    /** @brief Evalua un bloque de consultas */
+    using evaluador = function<void(span<const double>, span<double>)>;
+
+    /**
+     * @brief Muestra la forma de uso
+    */
+    inline void uso(const char *programa){
+        std::fprintf(stderr,
+                     "Uso: %s <metodo> <archivo_datos> [archivo_consultas]\n"
+                     "     %s --guardar <metodo|datos> <archivo_datos> <archivo_binario>\n"
+                     "  metodo: newton, lagrange, spline3, pchip, akima, lineal, potencia, exponencial, cuadratica\n"
+                     "  Sin archivo de consultas (o con -) se lee la entrada estandar.\n",
+                     programa, programa);
+    }
+
+    /**
+     * @brief Lee los pares (x, y) de un archivo de texto o binario
+     * @param ruta Ruta del archivo
+     * @param x Salida: variable independiente
+     * @param y Salida: variable dependiente
+    */
+    inline void leer_datos(const string &ruta, vector<double> &x, vector<double> &y){
+        if (binario::es_binario(ruta)){
+            binario::archivo_mapeado archivo(ruta);
+            auto [bx, by] = binario::cargar_datos(archivo);
+            x.assign(bx.begin(), bx.end());
+            y.assign(by.begin(), by.end());
+            return;
+        }
+        util::csv(ruta).leer(0, 1, x, y);
+    }
+
+    /**
+     * @brief Ajusta el metodo a los datos y retorna su evaluador por bloques
+     * @param metodo Nombre del metodo
+     * @param x Variable independiente; se mueve al modelo
+     * @param y Variable dependiente; se mueve al modelo
+     * @param cache Cache de modelos ajustados; nullptr para ajustar siempre
+    */
+    inline evaluador crear_evaluador(const string &metodo, vector<double> &&x, vector<double> &&y,
+                                     util::cache_modelos *cache = nullptr){
+        if (metodo == "newton" || metodo == "lagrange" || metodo == "spline3"){
+            if (x.size() < 2){
+                throw invalid_argument("Se necesitan al menos 2 datos para interpolar");
+            }
+            if (metodo == "spline3" && !std::is_sorted(x.begin(), x.end())){
+                throw invalid_argument("Los datos de x deben estar ordenados de forma creciente");
+            }
+        }
+
+        if (metodo == "newton"){
+            auto modelo = cache ? std::make_shared<interpolacion::newton>(cache->ajustar_newton(std::move(x), std::move(y)))
+                                : std::make_shared<interpolacion::newton>(std::move(x), std::move(y));
+            return [modelo](span<const double> q, span<double> r){ modelo->evaluar(q, r); };
+        }
+        if (metodo == "lagrange"){
+            auto modelo = cache ? std::make_shared<interpolacion::lagrange>(cache->ajustar_lagrange(std::move(x), std::move(y)))
+                                : std::make_shared<interpolacion::lagrange>(std::move(x), std::move(y));
+            return [modelo](span<const double> q, span<double> r){ modelo->evaluar(q, r); };
+        }
+        if (metodo == "spline3"){
+            auto modelo = cache ? std::make_shared<interpolacion::spline3>(cache->ajustar_spline3(std::move(x), std::move(y)))
+                                : std::make_shared<interpolacion::spline3>(std::move(x), std::move(y));
+            return [modelo](span<const double> q, span<double> r){ modelo->evaluar(q, r); };
+        }
+        if (metodo == "pchip" || metodo == "akima"){
+            // Ajustar es O(n): no pasa por el cache
+            if (metodo == "pchip"){
+                auto modelo = std::make_shared<interpolacion::pchip>(std::move(x), std::move(y));
+                return [modelo](span<const double> q, span<double> r){ modelo->evaluar(q, r); };
+            }
+            auto modelo = std::make_shared<interpolacion::akima>(std::move(x), std::move(y));
+            return [modelo](span<const double> q, span<double> r){ modelo->evaluar(q, r); };
+        }
+        if (metodo == "lineal"){
+            auto sol = cache ? cache->ajustar_lineal(x, y) : regresion::lineal_simple(std::move(x), std::move(y)).calcular();
+            return [sol](span<const double> q, span<double> r){ sol.predecir(q, r); };
+        }
+        if (metodo == "potencia"){
+            auto sol = cache ? cache->ajustar_potencia(x, y) : regresion::potencia(std::move(x), std::move(y)).calcular();
+            return [sol](span<const double> q, span<double> r){ sol.predecir(q, r); };
+        }
+        if (metodo == "exponencial"){
+            auto sol = cache ? cache->ajustar_exponencial(x, y) : regresion::exponencial(std::move(x), std::move(y)).calcular();
+            return [sol](span<const double> q, span<double> r){ sol.predecir(q, r); };
+        }
+        if (metodo == "cuadratica"){
+            auto sol = cache ? cache->ajustar_cuadratica(x, y) : regresion::cuadratica(std::move(x), std::move(y)).calcular();
+            return [sol](span<const double> q, span<double> r){ sol.predecir(q, r); };
+        }
+        throw invalid_argument("Metodo desconocido: " + metodo);
+    }
+
+    /**
+     * @brief Retorna el evaluador de un modelo guardado en formato binario, sin ajustarlo
+     * @param metodo Nombre del metodo; debe coincidir con el del archivo
+     * @param archivo Archivo mapeado; el evaluador lo mantiene abierto
+    */
+    inline evaluador cargar_evaluador(const string &metodo, std::shared_ptr<const binario::archivo_mapeado> archivo){
+        if (metodo == "newton"){
+            auto modelo = std::make_shared<interpolacion::newton>(binario::cargar_newton(*archivo));
+            return [archivo, modelo](span<const double> q, span<double> r){ modelo->evaluar(q, r); };
+        }
+        if (metodo == "lagrange"){
+            auto modelo = std::make_shared<interpolacion::lagrange>(binario::cargar_lagrange(*archivo));
+            return [archivo, modelo](span<const double> q, span<double> r){ modelo->evaluar(q, r); };
+        }
+        if (metodo == "spline3"){
+            auto modelo = std::make_shared<interpolacion::spline3>(binario::cargar_spline3(*archivo));
+            return [archivo, modelo](span<const double> q, span<double> r){ modelo->evaluar(q, r); };
+        }
+        if (metodo == "lineal"){
+            auto sol = binario::cargar_lineal(*archivo);
+            return [sol](span<const double> q, span<double> r){ sol.predecir(q, r); };
+        }
+        if (metodo == "potencia"){
+            auto sol = binario::cargar_potencia(*archivo);
+            return [sol](span<const double> q, span<double> r){ sol.predecir(q, r); };
+        }
+        if (metodo == "exponencial"){
+            auto sol = binario::cargar_exponencial(*archivo);
+            return [sol](span<const double> q, span<double> r){ sol.predecir(q, r); };
+        }
+        if (metodo == "cuadratica"){
+            auto sol = binario::cargar_cuadratica(*archivo);
+            return [sol](span<const double> q, span<double> r){ sol.predecir(q, r); };
+        }
+        throw invalid_argument("Metodo desconocido: " + metodo);
+    }
+
+    /**
+     * @brief Ajusta el metodo a los datos y guarda el modelo en formato binario
+     * @param metodo Nombre del metodo, o datos para guardar solo los datos
+     * @param x Variable independiente
+     * @param y Variable dependiente
+     * @param ruta Archivo de salida
+    */
+    inline void guardar_modelo(const string &metodo, vector<double> &&x, vector<double> &&y, const string &ruta){
+        if (metodo == "datos"){
+            binario::guardar_datos(ruta, x, y);
+        } else if (metodo == "newton"){
+            binario::guardar(ruta, interpolacion::newton(std::move(x), std::move(y)));
+        } else if (metodo == "lagrange"){
+            binario::guardar(ruta, interpolacion::lagrange(std::move(x), std::move(y)));
+        } else if (metodo == "spline3"){
+            if (x.size() < 2 || !std::is_sorted(x.begin(), x.end())){
+                throw invalid_argument("Se necesitan al menos 2 datos con x ordenado de forma creciente");
+            }
+            binario::guardar(ruta, interpolacion::spline3(std::move(x), std::move(y)));
+        } else if (metodo == "lineal"){
+            binario::guardar(ruta, regresion::lineal_simple(std::move(x), std::move(y)).calcular());
+        } else if (metodo == "potencia"){
+            binario::guardar(ruta, regresion::potencia(std::move(x), std::move(y)).calcular());
+        } else if (metodo == "exponencial"){
+            binario::guardar(ruta, regresion::exponencial(std::move(x), std::move(y)).calcular());
+        } else if (metodo == "cuadratica"){
+            binario::guardar(ruta, regresion::cuadratica(std::move(x), std::move(y)).calcular());
+        } else {
+            throw invalid_argument("Metodo desconocido: " + metodo);
+        }
+    }
+
+    /**
+     * @brief Evalua todas las consultas del archivo y escribe los resultados
+     * @param f Evaluador del metodo ajustado
+     * @param entrada Archivo de consultas
+     * @param salida Archivo de resultados
+     * @return Cantidad de consultas evaluadas
+    */
+    inline size_t procesar(const evaluador &f, FILE *entrada, FILE *salida){
+        // La lectura es secuencial; la evaluacion y el formato de cada bloque se
+        // reparten en PARTES tramos contiguos que se escriben en orden
+        const size_t BLOQUE = 1 << 16;
+        const size_t PARTES = 16;
+        vector<double> q(BLOQUE), r(BLOQUE);
+        vector<vector<char>> textos(PARTES);
+        util::lector_reales lector(entrada);
+        util::escritor_reales escritor(salida);
+        size_t total = 0;
+        while (true){
+            size_t leidos = lector.leer(q);
+            if (leidos == 0){
+                break;
+            }
+            size_t tramo = (leidos + PARTES - 1) / PARTES;
+            paralelo::para_cada(PARTES, [&](size_t parte){
+                size_t inicio = std::min(leidos, parte * tramo);
+                size_t cantidad = std::min(leidos, inicio + tramo) - inicio;
+                textos[parte].clear();
+                if (cantidad > 0){
+                    f(span<const double>(q.data() + inicio, cantidad), span<double>(r.data() + inicio, cantidad));
+                    util::formatear(span<const double>(r.data() + inicio, cantidad), textos[parte]);
+                }
+            });
+            for (const vector<char> &texto : textos){
+                escritor.escribir_texto(texto);
+            }
+            total += leidos;
+            if (leidos < BLOQUE){
+                break;
+            }
+        }
+        return total;
+    }
+
+    /**
+     * @brief Punto de entrada del modo por lotes
+     * @return Codigo de salida del programa
+    */
+    inline int ejecutar(int argc, char *argv[]){
+        if (argc == 5 && string(argv[1]) == "--guardar"){
+            try {
+                vector<double> x, y;
+                leer_datos(argv[3], x, y);
+                guardar_modelo(argv[2], std::move(x), std::move(y), argv[4]);
+            } catch (const std::exception &e) {
+                std::fprintf(stderr, "Error: %s\n", e.what());
+                return 1;
+            }
+            return 0;
+        }
+        if (argc < 3 || argc > 4){
+            uso(argv[0]);
+            return 2;
+        }
+        FILE *entrada = stdin;
+        try {
+            evaluador f;
+            std::shared_ptr<const binario::archivo_mapeado> archivo;
+            if (binario::es_binario(argv[2])){
+                archivo = std::make_shared<const binario::archivo_mapeado>(argv[2]);
+            }
+            if (archivo && archivo->contenido() != binario::tipo::datos){
+                // Modelo ya ajustado: se evalua directamente sobre el archivo mapeado
+                f = cargar_evaluador(argv[1], archivo);
+            } else {
+                vector<double> x, y;
+                leer_datos(argv[2], x, y);
+                const char *directorio = std::getenv("INTERPOLACION_CACHE");
+                if (directorio != nullptr && *directorio != '\0'){
+                    util::cache_modelos cache(size_t(256) << 20, directorio);
+                    f = crear_evaluador(argv[1], std::move(x), std::move(y), &cache);
+                } else {
+                    f = crear_evaluador(argv[1], std::move(x), std::move(y));
+                }
+            }
+
+            if (argc == 4 && string(argv[3]) != "-"){
+                entrada = std::fopen(argv[3], "rb");
+                if (entrada == nullptr){
+                    throw invalid_argument(string("No se pudo abrir ") + argv[3]);
+                }
+            }
+            procesar(f, entrada, stdout);
+        } catch (const std::exception &e) {
+            std::fflush(stdout);
+            std::fprintf(stderr, "Error: %s\n", e.what());
+            if (entrada != stdin){
+                std::fclose(entrada);
+            }
+            return 1;
+        }
+        if (entrada != stdin){
+            std::fclose(entrada);
+        }
+        return 0;
+    }
+}
+
+#endif
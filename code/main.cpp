@@ -5,6 +5,8 @@
 #include "util.h"
 #include "spline3.h"
 #include "regresion.h"
+#include "lote.h"
+#include "instrumentacion.h"
 
 using std::cout;
 using std::cin;
@@ -41,7 +43,15 @@ void caso_interpolacion_newton();
 */
 void caso_interpolacion_spline3();
 
-int main() {
+// Con -DINSTRUMENTAR cuenta las asignaciones de memoria de cada metodo medido
+INSTRUMENTACION_REEMPLAZAR_NEW;
+
+int main(int argc, char *argv[]) {
+    // Con argumentos se ejecuta el modo por lotes (ver lote.h)
+    if (argc > 1) {
+        return lote::ejecutar(argc, argv);
+    }
+
     int opcion;
 
     do {
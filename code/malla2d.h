@@ -0,0 +1,534 @@
+/**
+ * @file
+ * @brief Interpolacion en dos variables sobre mallas rectilineas: bilineal, bicubica y Newton local
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Los datos son una tabla z[i * ny + j] = f(x[i], y[j]) sobre los nodos de
+ * dos ejes crecientes. Los tres metodos son productos tensoriales de un
+ * metodo de una variable: en cada celda [x[i], x[i + 1]] x [y[j], y[j + 1]]
+ * la interpolacion es un polinomio en t = (x - x[i]) / hx y u = (y - y[j]) / hy
+ *
+ *     p(t, u) = suma de a[p][q] t^p u^q,  p, q <= G
+ *
+ * y el polinomio de cada eje es lineal en unos pocos datos del eje. Con la
+ * matriz M de esa relacion en cada eje, los coeficientes de la celda son
+ * Mx D My^T, con D los datos de la celda. Las matrices de cada eje se
+ * calculan una vez por intervalo, no por celda.
+ *
+ * - bilineal: recta en cada eje (G = 1); D son los 4 valores de las esquinas.
+ * - bicubico: trazador cubico natural en cada eje (G = 3); D son los valores
+ *   y las derivadas zxx, zyy y zxxyy en las esquinas. Las derivadas salen de
+ *   pasadas separables con el sistema tridiagonal de cada eje, que se
+ *   factoriza una sola vez: una pasada en x para todas las columnas, una
+ *   en y para todas las filas de z y otra para las de zxx.
+ * - newton_local: polinomio de Newton de grado 3 por los 4 nodos mas
+ *   cercanos de cada eje (G = 3); D son los valores en esos 4 x 4 nodos.
+ *
+ * Los coeficientes se guardan por teselas de 8 x 8 celdas contiguas, de
+ * modo que consultas cercanas en el plano leen memoria cercana. Evaluar es
+ * ubicar la celda en cada eje (en O(1) si el eje es uniforme; si no, a
+ * partir de la celda de la consulta anterior, como spline3::cursor) y un
+ * Horner en dos variables. Fuera del rango de los datos el resultado es NaN.
+*/
+
+#ifndef MALLA2D_H
+#define MALLA2D_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "algebra.h"
+#include "arena.h"
+#include "instrumentacion.h"
+#include "newton.h"
+#include "paralelo.h"
+#include "spline3.h"
+
+using std::size_t;
+using std::span;
+using std::vector;
+using std::invalid_argument;
+
+namespace interpolacion2d {
+
+    namespace detalle {
+
+        /**
+         * @brief Nodos de un eje de la malla y busqueda de la celda de un valor
+        */
+        class eje {
+            public:
+                eje() = default;
+
+                /**
+                 * @param p_nodos Nodos, estrictamente crecientes, al menos 2
+                */
+                explicit eje(span<const double> p_nodos) : nodos(p_nodos.begin(), p_nodos.end()){
+                    const size_t n = nodos.size();
+                    if (n < 2){
+                        throw invalid_argument("Cada eje necesita al menos 2 nodos");
+                    }
+                    inverso_h.resize(n - 1);
+                    for (size_t i = 0; i + 1 < n; i++){
+                        if (!(nodos[i + 1] > nodos[i])){
+                            throw invalid_argument("Los nodos de cada eje deben estar ordenados de forma estrictamente creciente");
+                        }
+                        inverso_h[i] = 1.0 / (nodos[i + 1] - nodos[i]);
+                    }
+                    // Uniforme si cada nodo esta donde lo pone el paso medio, salvo redondeo
+                    const double paso = (nodos[n - 1] - nodos[0]) / (double)(n - 1);
+                    uniforme = true;
+                    for (size_t i = 0; i < n && uniforme; i++){
+                        uniforme = std::fabs(nodos[i] - (nodos[0] + paso * (double)i)) <= 1e-9 * paso;
+                    }
+                    inverso_paso = 1.0 / paso;
+                }
+
+                /** @brief Cantidad de nodos */
+                size_t size() const {
+                    return nodos.size();
+                }
+
+                /** @brief Nodo i */
+                double operator[](size_t i) const {
+                    return nodos[i];
+                }
+
+                /** @brief Nodos del eje */
+                span<const double> valores() const {
+                    return nodos;
+                }
+
+                /** @brief Indica si v esta en el rango del eje */
+                bool contiene(double v) const {
+                    return v >= nodos.front() && v <= nodos.back();
+                }
+
+                /**
+                 * @brief Celda de v: el c con v en [x[c], x[c + 1]]
+                 * @param v Valor dentro del rango del eje
+                 * @param pista Celda de un valor anterior, en [0, n - 2]
+                */
+                size_t celda(double v, size_t pista) const {
+                    const size_t ultima = nodos.size() - 2;
+                    if (uniforme){
+                        size_t c = std::min(ultima, (size_t)((v - nodos[0]) * inverso_paso));
+                        // El redondeo del paso puede dejar v un nodo antes o despues
+                        while (c > 0 && v < nodos[c]){
+                            c--;
+                        }
+                        while (c < ultima && v > nodos[c + 1]){
+                            c++;
+                        }
+                        return c;
+                    }
+                    return interpolacion::detalle::ubicar(span<const double>(nodos), v, pista + 1) - 1;
+                }
+
+                /** @brief Posicion de v dentro de la celda c, en [0, 1] */
+                double local(double v, size_t c) const {
+                    return (v - nodos[c]) * inverso_h[c];
+                }
+
+            private:
+                vector<double> nodos; /*!< Nodos crecientes */
+                vector<double> inverso_h; /*!< 1 / ancho de cada celda */
+                bool uniforme = false; /*!< Nodos equiespaciados */
+                double inverso_paso = 0.0; /*!< 1 / paso, si es uniforme */
+        };
+
+        /**
+         * @brief Polinomios de grado G en cada variable por celda, guardados por teselas
+         * @tparam G Grado en cada variable: 1 o 3
+        */
+        template <size_t G>
+        class malla_celdas {
+            public:
+                static constexpr size_t K = G + 1; /*!< Coeficientes por variable */
+                static constexpr size_t COEFICIENTES = K * K; /*!< Coeficientes por celda */
+                static constexpr size_t TESELA = 8; /*!< Celdas por lado de una tesela */
+
+                /**
+                 * @brief Valor de la interpolacion en (xq, yq)
+                 * @return Valor interpolado, NaN fuera del rango de los datos
+                */
+                double interpolar(double xq, double yq) const {
+                    if (!(ex.contiene(xq) && ey.contiene(yq))){
+                        return NAN;
+                    }
+                    size_t ci = ex.celda(xq, 0), cj = ey.celda(yq, 0);
+                    return valor(ci, cj, ex.local(xq, ci), ey.local(yq, cj));
+                }
+
+                /**
+                 * @brief Interpola un lote de puntos dispersos, repartido entre los hilos
+                 * @param xq Primera coordenada de cada punto
+                 * @param yq Segunda coordenada de cada punto
+                 * @param salida Salida: un valor por punto, NaN fuera del rango de los datos
+                 * @param grano Puntos por tarea paralela
+                 *
+                 * Cada tarea busca la celda de cada punto a partir de la del punto
+                 * anterior; con puntos agrupados u ordenados la busqueda es O(1).
+                */
+                void evaluar(span<const double> xq, span<const double> yq, span<double> salida, size_t grano = 1 << 14) const {
+                    MEDIR("malla2d::evaluar");
+                    CONTAR("malla2d::evaluar::valores", salida.size());
+                    if (xq.size() != salida.size() || yq.size() != salida.size()){
+                        throw invalid_argument("Las coordenadas y la salida deben tener el mismo tamano");
+                    }
+                    grano = std::max<size_t>(1, grano);
+                    const size_t total = salida.size();
+                    paralelo::para_cada((total + grano - 1) / grano, [&](size_t tarea){
+                        size_t fin = std::min(total, (tarea + 1) * grano);
+                        size_t ci = 0, cj = 0;
+                        for (size_t k = tarea * grano; k < fin; k++){
+                            double a = xq[k], b = yq[k];
+                            if (!(ex.contiene(a) && ey.contiene(b))){
+                                salida[k] = NAN;
+                                continue;
+                            }
+                            ci = ex.celda(a, ci);
+                            cj = ey.celda(b, cj);
+                            salida[k] = valor(ci, cj, ex.local(a, ci), ey.local(b, cj));
+                        }
+                    });
+                }
+
+                /** @brief Nodos del primer eje */
+                span<const double> datos_x() const {
+                    return ex.valores();
+                }
+
+                /** @brief Nodos del segundo eje */
+                span<const double> datos_y() const {
+                    return ey.valores();
+                }
+
+                /** @brief Memoria de los coeficientes */
+                size_t bytes() const {
+                    return coef.size() * sizeof(double);
+                }
+
+            protected:
+                eje ex; /*!< Primer eje */
+                eje ey; /*!< Segundo eje */
+
+                /**
+                 * @brief Valida la tabla y crea los ejes
+                 * @param x Nodos del primer eje
+                 * @param y Nodos del segundo eje
+                 * @param z Valores, z[i * ny + j] = f(x[i], y[j])
+                */
+                malla_celdas(span<const double> x, span<const double> y, span<const double> z) : ex(x), ey(y){
+                    if (z.size() != x.size() * y.size()){
+                        throw invalid_argument("Se necesita un valor de z por cada nodo de la malla");
+                    }
+                    teselas_y = (ey.size() - 1 + TESELA - 1) / TESELA;
+                    size_t teselas_x = (ex.size() - 1 + TESELA - 1) / TESELA;
+                    coef.assign(teselas_x * teselas_y * TESELA * TESELA * COEFICIENTES, 0.0);
+                }
+
+                /**
+                 * @brief Calcula los coeficientes de todas las celdas, repartiendo las filas de celdas entre los hilos
+                 * @param mx Matriz K x K de cada intervalo del primer eje, por filas: mx[c][p][m]
+                 * @param my Matriz K x K de cada intervalo del segundo eje, por filas
+                 * @param dato dato(ci, cj, m, n): dato m del primer eje y n del segundo de la celda (ci, cj)
+                */
+                template <typename D>
+                void construir(span<const double> mx, span<const double> my, D dato){
+                    MEDIR("malla2d::construir");
+                    const size_t celdas_x = ex.size() - 1, celdas_y = ey.size() - 1;
+                    paralelo::para_cada(celdas_x, [&](size_t ci){
+                        const double *a = mx.data() + ci * COEFICIENTES;
+                        for (size_t cj = 0; cj < celdas_y; cj++){
+                            const double *b = my.data() + cj * COEFICIENTES;
+                            // D de la celda, luego Mx D, luego (Mx D) My^T
+                            std::array<double, COEFICIENTES> d, ad;
+                            for (size_t m = 0; m < K; m++){
+                                for (size_t n = 0; n < K; n++){
+                                    d[m * K + n] = dato(ci, cj, m, n);
+                                }
+                            }
+                            for (size_t p = 0; p < K; p++){
+                                for (size_t n = 0; n < K; n++){
+                                    double s = 0.0;
+                                    for (size_t m = 0; m < K; m++){
+                                        s += a[p * K + m] * d[m * K + n];
+                                    }
+                                    ad[p * K + n] = s;
+                                }
+                            }
+                            double *c = coef.data() + desplazamiento(ci, cj);
+                            for (size_t p = 0; p < K; p++){
+                                for (size_t q = 0; q < K; q++){
+                                    double s = 0.0;
+                                    for (size_t n = 0; n < K; n++){
+                                        s += ad[p * K + n] * b[q * K + n];
+                                    }
+                                    c[p * K + q] = s;
+                                }
+                            }
+                        }
+                    });
+                }
+
+            private:
+                size_t teselas_y = 0; /*!< Teselas a lo largo del segundo eje */
+                vector<double> coef; /*!< a[p][q] de cada celda, por teselas de TESELA x TESELA celdas */
+
+                /** @brief Posicion de los coeficientes de la celda (ci, cj) */
+                size_t desplazamiento(size_t ci, size_t cj) const {
+                    size_t tesela = (ci / TESELA) * teselas_y + cj / TESELA;
+                    size_t dentro = (ci % TESELA) * TESELA + cj % TESELA;
+                    return (tesela * TESELA * TESELA + dentro) * COEFICIENTES;
+                }
+
+                /** @brief Horner en u para cada potencia de t y luego en t */
+                double valor(size_t ci, size_t cj, double t, double u) const {
+                    const double *a = coef.data() + desplazamiento(ci, cj);
+                    double v = 0.0;
+                    for (size_t p = K; p-- > 0;){
+                        const double *fila = a + p * K;
+                        double f = fila[G];
+                        for (size_t q = G; q-- > 0;){
+                            f = f * u + fila[q];
+                        }
+                        v = v * t + f;
+                    }
+                    return v;
+                }
+        };
+
+        /**
+         * @brief Matrices de la recta de cada intervalo: datos (z[c], z[c + 1])
+        */
+        inline vector<double> matrices_lineales(const eje &e){
+            vector<double> m(4 * (e.size() - 1));
+            for (size_t c = 0; c + 1 < e.size(); c++){
+                double *a = m.data() + 4 * c;
+                a[0] = 1.0; a[1] = 0.0;  // 1
+                a[2] = -1.0; a[3] = 1.0; // t
+            }
+            return m;
+        }
+
+        /**
+         * @brief Matrices del trazador cubico de cada intervalo: datos (z[c], z[c + 1], z''[c], z''[c + 1])
+         *
+         * La columna de cada dato son los coeficientes de spline3 del
+         * intervalo con ese dato en 1 y los demas en 0, llevados a
+         * t = (x - x[c]) / h.
+        */
+        inline vector<double> matrices_trazador(const eje &e){
+            vector<double> m(16 * (e.size() - 1));
+            for (size_t c = 0; c + 1 < e.size(); c++){
+                double h = e[c + 1] - e[c];
+                double *a = m.data() + 16 * c;
+                for (size_t dato = 0; dato < 4; dato++){
+                    double unidad[4] = {0.0, 0.0, 0.0, 0.0};
+                    unidad[dato] = 1.0;
+                    double coef[4];
+                    interpolacion::spline3::coeficientes_intervalo(h, unidad[0], unidad[1], unidad[2], unidad[3], coef);
+                    double escala = 1.0;
+                    for (size_t k = 0; k < 4; k++){
+                        a[4 * k + dato] = coef[k] * escala;
+                        escala *= h;
+                    }
+                }
+            }
+            return m;
+        }
+
+        /**
+         * @brief Primer nodo de los min(4, n) nodos mas cercanos al intervalo c
+        */
+        inline size_t primer_nodo_local(size_t c, size_t n){
+            size_t grado = std::min<size_t>(3, n - 1);
+            return std::min(c > 0 ? c - 1 : 0, n - 1 - grado);
+        }
+
+        /**
+         * @brief Matrices del polinomio de Newton de cada intervalo por sus 4 nodos mas cercanos
+         *
+         * La columna m es el polinomio que vale 1 en el nodo m y 0 en los
+         * demas: sus diferencias divididas (newton::calcular_coeficientes) y
+         * luego la forma de Newton desarrollada en potencias de t. Con menos
+         * de 4 nodos las columnas sobrantes quedan en 0.
+        */
+        inline vector<double> matrices_newton(const eje &e){
+            const size_t n = e.size();
+            const size_t nodos = std::min<size_t>(4, n);
+            vector<double> m(16 * (n - 1), 0.0);
+            std::array<double, 4> t{}, unitario{}, b{}, p{};
+            for (size_t c = 0; c + 1 < n; c++){
+                size_t s = primer_nodo_local(c, n);
+                double h = e[c + 1] - e[c];
+                for (size_t k = 0; k < nodos; k++){
+                    t[k] = (e[s + k] - e[c]) / h;
+                }
+                double *a = m.data() + 16 * c;
+                for (size_t col = 0; col < nodos; col++){
+                    unitario.fill(0.0);
+                    unitario[col] = 1.0;
+                    interpolacion::newton::calcular_coeficientes(span<const double>(t.data(), nodos),
+                                                                 span<const double>(unitario.data(), nodos),
+                                                                 span<double>(b.data(), nodos));
+                    // p = b[k] + (t - t[k]) p, desde el ultimo coeficiente
+                    p.fill(0.0);
+                    for (size_t k = nodos; k-- > 0;){
+                        for (size_t j = 3; j > 0; j--){
+                            p[j] = p[j - 1] - t[k] * p[j];
+                        }
+                        p[0] = b[k] - t[k] * p[0];
+                    }
+                    for (size_t r = 0; r < 4; r++){
+                        a[r * 4 + col] = p[r];
+                    }
+                }
+            }
+            return m;
+        }
+    }
+
+    /**
+     * @brief Interpolacion bilineal: recta en cada eje
+    */
+    class bilineal : public detalle::malla_celdas<1> {
+        public:
+            /**
+             * @brief Crea la interpolacion bilineal de una tabla
+             * @param x Nodos del primer eje, estrictamente crecientes, al menos 2
+             * @param y Nodos del segundo eje, estrictamente crecientes, al menos 2
+             * @param z Valores, z[i * y.size() + j] = f(x[i], y[j])
+            */
+            bilineal(span<const double> x, span<const double> y, span<const double> z) : malla_celdas(x, y, z){
+                const size_t ny = ey.size();
+                construir(detalle::matrices_lineales(ex), detalle::matrices_lineales(ey),
+                          [&](size_t ci, size_t cj, size_t m, size_t n){
+                              return z[(ci + m) * ny + cj + n];
+                          });
+            }
+    };
+
+    /**
+     * @brief Trazador cubico natural en cada eje (producto tensorial de spline3)
+     *
+     * Sobre cada linea de nodos de la malla coincide con spline3 de esa
+     * linea; entre lineas, con el trazador de los valores del trazador.
+    */
+    class bicubico : public detalle::malla_celdas<3> {
+        public:
+            /**
+             * @brief Crea el trazador bicubico de una tabla
+             * @param x Nodos del primer eje, estrictamente crecientes, al menos 2
+             * @param y Nodos del segundo eje, estrictamente crecientes, al menos 2
+             * @param z Valores, z[i * y.size() + j] = f(x[i], y[j])
+            */
+            bicubico(span<const double> x, span<const double> y, span<const double> z) : malla_celdas(x, y, z){
+                MEDIR("bicubico::derivadas");
+                const size_t nx = ex.size(), ny = ey.size();
+                std::pmr::vector<double> zxx(nx * ny, 0.0, util::temporales());
+                std::pmr::vector<double> zyy(nx * ny, 0.0, util::temporales());
+                std::pmr::vector<double> zxxyy(nx * ny, 0.0, util::temporales());
+
+                // zxx: un sistema por columna, todas a la vez fila por fila, por bloques de columnas
+                if (nx > 2){
+                    util::factorizacion_tridiagonal fx = factorizar(ex);
+                    span<double> interiores(zxx.data() + ny, (nx - 2) * ny);
+                    for (size_t i = 1; i + 1 < nx; i++){
+                        derecho(ex, i, z.data() + (i - 1) * ny, ny, zxx.data() + i * ny, 1, ny);
+                    }
+                    const size_t BLOQUE = 256;
+                    paralelo::para_cada((ny + BLOQUE - 1) / BLOQUE, [&](size_t b){
+                        size_t primera = b * BLOQUE;
+                        fx.resolver_columnas(interiores, ny, primera, std::min(ny, primera + BLOQUE) - primera);
+                    });
+                }
+
+                // zyy y zxxyy: un sistema por fila de z y de zxx
+                if (ny > 2){
+                    util::factorizacion_tridiagonal fy = factorizar(ey);
+                    paralelo::para_cada(nx, [&](size_t i){
+                        derecho_fila(ey, z.data() + i * ny, zyy.data() + i * ny);
+                        fy.resolver(span<double>(zyy.data() + i * ny + 1, ny - 2));
+                        derecho_fila(ey, zxx.data() + i * ny, zxxyy.data() + i * ny);
+                        fy.resolver(span<double>(zxxyy.data() + i * ny + 1, ny - 2));
+                    });
+                }
+
+                const double *tablas[4] = {z.data(), zxx.data(), zyy.data(), zxxyy.data()};
+                construir(detalle::matrices_trazador(ex), detalle::matrices_trazador(ey),
+                          [&](size_t ci, size_t cj, size_t m, size_t n){
+                              // m, n: 0 y 1 son valores en los nodos c y c + 1; 2 y 3, segundas derivadas
+                              const double *tabla = tablas[(m >> 1) | ((n >> 1) << 1)];
+                              return tabla[(ci + (m & 1)) * ny + cj + (n & 1)];
+                          });
+            }
+
+        private:
+            /** @brief Sistema de las segundas derivadas interiores del trazador natural sobre un eje */
+            static util::factorizacion_tridiagonal factorizar(const detalle::eje &e){
+                const size_t incognitas = e.size() - 2;
+                vector<double> inferior(incognitas), diagonal(incognitas), superior(incognitas);
+                interpolacion::spline3::sistema_f2(e.valores(), inferior, diagonal, superior);
+                return util::factorizacion_tridiagonal(inferior, diagonal, superior);
+            }
+
+            /**
+             * @brief Lado derecho de la ecuacion del nodo interior i para cuantos sistemas a la vez
+             * @param v Valores en los nodos i - 1, i, i + 1, separados por paso_nodo; sistema k en v + k
+             * @param salida Lado derecho de cada sistema, separados por paso_salida
+            */
+            static void derecho(const detalle::eje &e, size_t i, const double *v, size_t paso_nodo,
+                                double *salida, size_t paso_salida, size_t cuantas){
+                const double x_ant = e[i - 1], x_i = e[i], x_sig = e[i + 1];
+                for (size_t k = 0; k < cuantas; k++){
+                    double ant = v[k], act = v[k + paso_nodo], sig = v[k + 2 * paso_nodo];
+                    salida[k * paso_salida] = interpolacion::spline3::lado_derecho_f2(x_ant, x_i, x_sig, ant, act, sig);
+                }
+            }
+
+            /** @brief Lados derechos de todos los nodos interiores de una fila contigua */
+            static void derecho_fila(const detalle::eje &e, const double *v, double *salida){
+                for (size_t i = 1; i + 1 < e.size(); i++){
+                    derecho(e, i, v + i - 1, 1, salida + i, 1, 1);
+                }
+            }
+    };
+
+    /**
+     * @brief Polinomio de Newton de grado 3 en cada eje por los 4 nodos mas cercanos a la celda
+     *
+     * No necesita resolver sistemas; con menos de 4 nodos en un eje el grado
+     * en ese eje es n - 1. Es continua pero sus derivadas saltan entre celdas.
+    */
+    class newton_local : public detalle::malla_celdas<3> {
+        public:
+            /**
+             * @brief Crea la interpolacion de Newton local de una tabla
+             * @param x Nodos del primer eje, estrictamente crecientes, al menos 2
+             * @param y Nodos del segundo eje, estrictamente crecientes, al menos 2
+             * @param z Valores, z[i * y.size() + j] = f(x[i], y[j])
+            */
+            newton_local(span<const double> x, span<const double> y, span<const double> z) : malla_celdas(x, y, z){
+                const size_t nx = ex.size(), ny = ey.size();
+                const size_t ultimo_x = std::min<size_t>(3, nx - 1), ultimo_y = std::min<size_t>(3, ny - 1);
+                construir(detalle::matrices_newton(ex), detalle::matrices_newton(ey),
+                          [&](size_t ci, size_t cj, size_t m, size_t n){
+                              // Los datos sobrantes con menos de 4 nodos multiplican columnas en 0
+                              size_t i = detalle::primer_nodo_local(ci, nx) + std::min(m, ultimo_x);
+                              size_t j = detalle::primer_nodo_local(cj, ny) + std::min(n, ultimo_y);
+                              return z[i * ny + j];
+                          });
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,123 @@
+/**
+ * @file
+ * @brief Archivo de solo lectura mapeado en memoria
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+*/
+
+#ifndef MAPEO_H
+#define MAPEO_H
+
+#include <cstdio>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using std::size_t;
+using std::span;
+using std::string;
+using std::vector;
+using std::runtime_error;
+
+namespace util {
+
+    /**
+     * @brief Contenido de un archivo, mapeado en memoria sin leerlo
+     *
+     * El sistema carga las paginas a medida que se usan, asi que abrir un
+     * archivo grande es inmediato. En Windows el archivo se lee completo.
+     * El contenido empieza alineado a 8 bytes.
+    */
+    class archivo_en_memoria {
+        public:
+            /**
+             * @brief Mapea el archivo
+             * @param ruta Ruta del archivo
+            */
+            explicit archivo_en_memoria(const string &ruta){
+#ifdef _WIN32
+                FILE *archivo = std::fopen(ruta.c_str(), "rb");
+                if (archivo == nullptr){
+                    throw runtime_error("No se pudo abrir " + ruta);
+                }
+                std::fseek(archivo, 0, SEEK_END);
+                long largo = std::ftell(archivo);
+                std::fseek(archivo, 0, SEEK_SET);
+                size_t bytes = largo < 0 ? 0 : (size_t)largo;
+                copia.resize((bytes + sizeof(double) - 1) / sizeof(double));
+                tamano = std::fread(copia.data(), 1, bytes, archivo);
+                std::fclose(archivo);
+                base = (const char *)copia.data();
+#else
+                int fd = ::open(ruta.c_str(), O_RDONLY);
+                if (fd < 0){
+                    throw runtime_error("No se pudo abrir " + ruta);
+                }
+                struct stat info;
+                if (::fstat(fd, &info) != 0){
+                    ::close(fd);
+                    throw runtime_error("No se pudo leer " + ruta);
+                }
+                tamano = (size_t)info.st_size;
+                if (tamano > 0){
+                    void *p = ::mmap(nullptr, tamano, PROT_READ, MAP_SHARED, fd, 0);
+                    if (p == MAP_FAILED){
+                        ::close(fd);
+                        throw runtime_error("No se pudo mapear " + ruta);
+                    }
+                    base = (const char *)p;
+                }
+                ::close(fd);
+#endif
+            }
+
+            archivo_en_memoria(const archivo_en_memoria &) = delete;
+            archivo_en_memoria &operator=(const archivo_en_memoria &) = delete;
+
+            ~archivo_en_memoria(){
+#ifndef _WIN32
+                if (base != nullptr){
+                    ::munmap((void *)base, tamano);
+                }
+#endif
+            }
+
+            /** @brief Contenido del archivo */
+            span<const char> contenido() const {
+                return span<const char>(base, tamano);
+            }
+
+            /** @brief Bytes del archivo */
+            size_t size() const {
+                return tamano;
+            }
+
+            /**
+             * @brief Indica al sistema que el contenido se leera en orden, para que lea por adelantado
+            */
+            void lectura_secuencial() const {
+#if !defined(_WIN32) && defined(MADV_SEQUENTIAL)
+                if (base != nullptr){
+                    ::madvise((void *)base, tamano, MADV_SEQUENTIAL);
+                }
+#endif
+            }
+
+        private:
+            const char *base = nullptr; /*!< Inicio del contenido */
+            size_t tamano = 0; /*!< Bytes del archivo */
+#ifdef _WIN32
+            vector<double> copia; /*!< Contenido del archivo, alineado a 8 bytes */
+#endif
+    };
+}
+
+#endif
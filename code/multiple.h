@@ -0,0 +1,315 @@
+/**
+ * @file
+ * @brief Regresion lineal multiple mediante ecuaciones normales
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+*/
+
+#ifndef MULTIPLE_H
+#define MULTIPLE_H
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "util.h"
+#include "paralelo.h"
+#include "vectorial.h"
+
+using std::cout;
+using std::endl;
+using std::span;
+using std::vector;
+using std::invalid_argument;
+
+using util::resolver_cholesky;
+
+namespace regresion {
+
+    /**
+     * @brief Forma en que se almacena la matriz de variables independientes
+    */
+    enum class disposicion {
+        por_filas,   /*!< X[i * p + j]: cada fila es una observacion */
+        por_columnas /*!< X[j * n + i]: cada columna es una variable */
+    };
+
+    /**
+     * @brief Solucion mediante Regresion Lineal Multiple
+    */
+    struct solucion_multiple {
+        vector<double> b; /*!< b[0] termino independiente, b[j] coeficiente de x_j */
+        double st = NAN; /*!< Sumatoria de la diferencia cuadratica entre el valor medido y el promedio */
+        double sy = NAN; /*!< Desviacion estandar */
+        double sr = NAN; /*!< Sumatoria de la diferencia cuadratica entre cada y con el y estimado */
+        double syx = NAN; /*!< Error estandar de aproximacion */
+        double r2 = NAN; /*!< Coeficiente de determinacion */
+        size_t n = 0; /*!< Numero de datos */
+        size_t p = 0; /*!< Numero de variables independientes */
+
+        /**
+         * @brief Imprimir solucion encontrada
+         */
+        void imprimir(){
+
+            string aceptable = (syx < sy) ? "La aproximacion se considera aceptable" : "La aproximacion NO se considera aceptable";
+
+            cout << "Hiperplano de regresion: \n"
+                 << "\ny = " << b[0];
+            for (size_t j = 1; j < b.size(); j++){
+                cout << ((b[j] >= 0.0)? " + " : " - ")
+                     << fabs(b[j]) << " * x" << j;
+            }
+            cout << "\n"
+                 << endl
+                 << "Desviacion estandar: "
+                 << sy
+                 << "\n"
+                 << endl
+                 << "Error estandar de aproximacion: "
+                 << syx
+                 << "\n"
+                 << aceptable
+                 << endl
+                 << "Coeficiente de determinacion: "
+                 << r2
+                 << endl;
+        }
+
+        /**
+         * @brief Evalua el hiperplano de regresion sobre un lote de observaciones
+         * @param X Matriz de n x p variables independientes
+         * @param d Disposicion de X
+         * @param y Salida con los n valores estimados
+         */
+        void predecir(span<const double> X, disposicion d, span<double> y) const {
+            size_t filas = y.size();
+            if (X.size() != filas * p){
+                throw invalid_argument("X debe tener n * p elementos");
+            }
+
+            if (d == disposicion::por_filas){
+                for (size_t i = 0; i < filas; i++){
+                    const double *fila = X.data() + i * p;
+                    double v = b[0];
+                    for (size_t j = 0; j < p; j++){
+                        v += b[j + 1] * fila[j];
+                    }
+                    y[i] = v;
+                }
+            } else {
+                for (size_t i = 0; i < filas; i++){
+                    y[i] = b[0];
+                }
+                for (size_t j = 0; j < p; j++){
+                    const double *columna = X.data() + j * filas;
+                    double bj = b[j + 1];
+                    for (size_t i = 0; i < filas; i++){
+                        y[i] += bj * columna[i];
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Calcula los residuos y - y estimado sobre un lote
+         * @param X Matriz de n x p variables independientes
+         * @param d Disposicion de X
+         * @param y Valores medidos de y
+         * @param r Salida con los residuos
+         */
+        void residuos(span<const double> X, disposicion d, span<const double> y, span<double> r) const {
+            predecir(X, d, r);
+            vectorial::restar_de(y, r);
+        }
+    };
+
+    /**
+     * @brief Regresion lineal con p variables independientes
+     *
+     * Las sumas de Xt X y Xt y se acumulan en una sola pasada sobre los datos,
+     * por teselas de FILAS_TESELA filas que caben en la cache L1. Los datos se
+     * dividen en bloques cuyo tamaño depende solo de n; cada bloque produce
+     * una suma parcial y las parciales se suman en orden, de modo que el
+     * resultado es el mismo sin importar la cantidad de hilos.
+    */
+    class lineal_multiple {
+    public:
+        /**
+         * @brief Crea una instancia de la regresion lineal multiple
+         * @param p_X Matriz de n x p variables independientes (no se copia)
+         * @param p_y Variable dependiente, n valores (no se copia)
+         * @param p_p Numero de variables independientes
+         * @param p_d Disposicion de X
+         */
+        lineal_multiple(span<const double> p_X, span<const double> p_y, size_t p_p,
+                        disposicion p_d = disposicion::por_filas)
+            : X(p_X), y(p_y), p(p_p), d(p_d){
+            if (p == 0 || X.size() != y.size() * p){
+                throw invalid_argument("X debe tener n * p elementos");
+            }
+        }
+
+        /**
+         * @brief Calcula el hiperplano de regresion
+         * @return Hiperplano de regresion; si el sistema es singular los coeficientes son NaN
+         */
+        solucion_multiple calcular() const {
+            solucion_multiple sol;
+            sol.n = y.size();
+            sol.p = p;
+            sol.b.assign(p + 1, NAN);
+
+            if (sol.n <= p + 1){
+                return sol;
+            }
+
+            // Dimension de la matriz aumentada [1, x1 ... xp, y]
+            const size_t q = p + 2;
+            vector<double> g = acumular();
+
+            // Ecuaciones normales: (Xt X) beta = Xt y
+            const size_t m = p + 1;
+            vector<double> a(m * m);
+            vector<double> beta(m);
+            for (size_t i = 0; i < m; i++){
+                for (size_t j = i; j < m; j++){
+                    a[i * m + j] = g[i * q + j];
+                    a[j * m + i] = g[i * q + j];
+                }
+                beta[i] = g[i * q + (q - 1)];
+            }
+            vector<double> xty(beta);
+
+            if (!resolver_cholesky(a, beta, m)){
+                return sol;
+            }
+
+            double n = (double)sol.n;
+            double syy = g[(q - 1) * q + (q - 1)];
+            double sum_y = g[q - 1];
+
+            sol.st = syy - (sum_y * sum_y) / n;
+            sol.sr = syy;
+            for (size_t i = 0; i < m; i++){
+                sol.sr -= beta[i] * xty[i];
+            }
+            sol.sr = std::max(sol.sr, 0.0);
+
+            // Deshacer el desplazamiento de los datos a la primera observacion
+            sol.b[0] = y[0] + beta[0];
+            for (size_t j = 0; j < p; j++){
+                sol.b[j + 1] = beta[j + 1];
+                sol.b[0] -= beta[j + 1] * valor(0, j);
+            }
+
+            sol.sy = sqrt(sol.st / (double)(sol.n - 1));
+            sol.syx = sqrt(sol.sr / (double)(sol.n - p - 1));
+            sol.r2 = (sol.st - sol.sr) / sol.st;
+
+            return sol;
+        }
+
+    private:
+        /** @brief Filas por tesela */
+        static const size_t FILAS_TESELA = 128;
+        /** @brief Cantidad maxima de sumas parciales */
+        static const size_t MAX_BLOQUES = 1024;
+
+        span<const double> X; /*!< Variables independientes */
+        span<const double> y; /*!< Variable dependiente */
+        size_t p; /*!< Numero de variables independientes */
+        disposicion d; /*!< Disposicion de X */
+
+        /**
+         * @brief Valor de la variable j en la observacion i
+         */
+        double valor(size_t i, size_t j) const {
+            return (d == disposicion::por_filas) ? X[i * p + j] : X[j * y.size() + i];
+        }
+
+        /**
+         * @brief Acumula la matriz [1 X y]t [1 X y] con los datos desplazados a la primera observacion
+         * @return Triangulo superior de la matriz de q x q, q = p + 2
+         */
+        vector<double> acumular() const {
+            const size_t n = y.size();
+            const size_t q = p + 2;
+
+            // Bloques de tamaño multiplo de la tesela, que dependen solo de n
+            size_t filas_bloque = std::max(FILAS_TESELA * 64, (n + MAX_BLOQUES - 1) / MAX_BLOQUES);
+            filas_bloque = (filas_bloque + FILAS_TESELA - 1) / FILAS_TESELA * FILAS_TESELA;
+            size_t n_bloques = (n + filas_bloque - 1) / filas_bloque;
+
+            // El desplazamiento reduce la perdida de precision al sumar cuadrados
+            vector<double> origen(q, 0.0);
+            for (size_t j = 0; j < p; j++){
+                origen[j + 1] = valor(0, j);
+            }
+            origen[q - 1] = y[0];
+
+            vector<double> parciales(n_bloques * q * q, 0.0);
+
+            paralelo::para_cada(n_bloques, [&](size_t bloque){
+                double *g = parciales.data() + bloque * q * q;
+                vector<double> tesela(FILAS_TESELA * q);
+
+                size_t fin_bloque = std::min(n, (bloque + 1) * filas_bloque);
+                for (size_t inicio = bloque * filas_bloque; inicio < fin_bloque; inicio += FILAS_TESELA){
+                    size_t filas = std::min(FILAS_TESELA, fin_bloque - inicio);
+
+                    // Copiar la tesela por filas: [1, x1 - x01, ..., xp - x0p, y - y0]
+                    for (size_t r = 0; r < filas; r++){
+                        double *z = tesela.data() + r * q;
+                        z[0] = 1.0;
+                        z[q - 1] = y[inicio + r] - origen[q - 1];
+                    }
+                    if (d == disposicion::por_filas){
+                        for (size_t r = 0; r < filas; r++){
+                            const double *fila = X.data() + (inicio + r) * p;
+                            double *z = tesela.data() + r * q;
+                            for (size_t j = 0; j < p; j++){
+                                z[j + 1] = fila[j] - origen[j + 1];
+                            }
+                        }
+                    } else {
+                        for (size_t j = 0; j < p; j++){
+                            const double *columna = X.data() + j * n + inicio;
+                            for (size_t r = 0; r < filas; r++){
+                                tesela[r * q + j + 1] = columna[r] - origen[j + 1];
+                            }
+                        }
+                    }
+
+                    // Actualizaciones de rango 1 sobre el triangulo superior, que permanece en cache
+                    for (size_t r = 0; r < filas; r++){
+                        const double *z = tesela.data() + r * q;
+                        for (size_t a = 0; a < q; a++){
+                            double za = z[a];
+                            double *fila_g = g + a * q;
+                            for (size_t c = a; c < q; c++){
+                                fila_g[c] += za * z[c];
+                            }
+                        }
+                    }
+                }
+            });
+
+            // Reduccion en orden fijo
+            vector<double> g(q * q, 0.0);
+            for (size_t bloque = 0; bloque < n_bloques; bloque++){
+                const double *parcial = parciales.data() + bloque * q * q;
+                for (size_t k = 0; k < q * q; k++){
+                    g[k] += parcial[k];
+                }
+            }
+            return g;
+        }
+    };
+}
+
+#endif
@@ -13,8 +13,18 @@
 #include <sstream>
 #include <string>
 #include <iostream>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "arena.h"
+#include "datos.h"
+#include "instrumentacion.h"
 
 using std::vector;
+using std::span;
 using std::string;
 using std::ostringstream;
 using std::isnan;
@@ -28,32 +38,137 @@ namespace interpolacion{
 
     /**
      * @brief Metodo de Diferencias Divididas de Newton
+     *
+     * Los coeficientes siempre se calculan en double; T es el tipo en que se
+     * guardan los datos y se evalua el polinomio.
+     *
+     * @tparam T double o float
     */
-    class newton{
+    template <typename T>
+    class basic_newton{
 
         public:
+            using datos = util::basic_datos<T>; /*!< Arreglo de T propio o prestado */
+
             /**
              * @brief Crea una instancia de Newton
              * @param p_x Variable independiente
              * @param p_y Variable dependiente
+             * @note Copia x e y (una asignacion de memoria por arreglo)
+            */
+            basic_newton(span<const T> p_x, span<const T> p_y):x(p_x), y(p_y){
+                calcular_coeficientes();
+            }
+
+            /**
+             * @brief Crea una instancia de Newton, moviendo los vectores sin copiarlos
+             * @param p_x Variable independiente
+             * @param p_y Variable dependiente
+             * @note No asigna memoria para x e y
             */
-            newton(vector<double> p_x, vector<double> p_y):x(p_x),y(p_y){
+            basic_newton(vector<T> &&p_x, vector<T> &&p_y):x(std::move(p_x)), y(std::move(p_y)){
                 calcular_coeficientes();
             }
+
+            /**
+             * @brief Crea una instancia de Newton, tomando prestados los datos
+             * @param p_x Variable independiente; debe existir mientras exista la instancia
+             * @param p_y Variable dependiente; debe existir mientras exista la instancia
+             * @note No copia x ni y ni asigna memoria para ellos
+            */
+            basic_newton(util::prestado_t, span<const T> p_x, span<const T> p_y):x(util::prestado, p_x), y(util::prestado, p_y){
+                calcular_coeficientes();
+            }
+
+            /**
+             * @brief Crea una instancia de Newton con los coeficientes ya calculados, sin recalcularlos
+             * @param p_x Variable independiente
+             * @param p_y Variable dependiente
+             * @param p_b Coeficientes del polinomio (ver coeficientes()), propios o prestados
+            */
+            basic_newton(vector<T> &&p_x, vector<T> &&p_y, datos p_b):x(std::move(p_x)), y(std::move(p_y)), b(std::move(p_b)){
+                validar_coeficientes();
+            }
+
+            /**
+             * @brief Crea una instancia de Newton con los coeficientes ya calculados, tomando prestados los datos
+             * @param p_x Variable independiente; debe existir mientras exista la instancia
+             * @param p_y Variable dependiente; debe existir mientras exista la instancia
+             * @param p_b Coeficientes del polinomio (ver coeficientes()), propios o prestados
+            */
+            basic_newton(util::prestado_t, span<const T> p_x, span<const T> p_y, datos p_b):x(util::prestado, p_x), y(util::prestado, p_y), b(std::move(p_b)){
+                validar_coeficientes();
+            }
+
+            /**
+             * @brief Copia un polinomio ya ajustado convirtiendo sus datos a T, sin recalcular los coeficientes
+             * @param otro Polinomio ajustado, por ejemplo en double para evaluarlo en float
+            */
+            template <typename U>
+            explicit basic_newton(const basic_newton<U> &otro)
+                : x(util::convertir<T>(otro.datos_x())), y(util::convertir<T>(otro.datos_y())),
+                  b(util::convertir<T>(otro.coeficientes())){
+            }
+
+            /**
+             * @brief Coeficientes del polinomio de Newton por todos los datos: el estado ajustado
+            */
+            span<const T> coeficientes() const {
+                return b;
+            }
+
+            /** @brief Variable independiente */
+            span<const T> datos_x() const {
+                return x;
+            }
+
+            /** @brief Variable dependiente */
+            span<const T> datos_y() const {
+                return y;
+            }
             
             /**
              * @brief Interpola el valor de x_int utilizando todos los datos
              * @param x_int Valor de x a interpolar
              * @return Valor interpolado
             */
-            double interpolar(double x_int){
+            T interpolar(T x_int) const {
                 return interpolar(x_int, 0, x.size() - 1);
             }
 
+            /**
+             * @brief Interpola un lote de valores con todos los datos, en O(n) por valor
+             * @param x_int Valores de x a interpolar
+             * @param y_int Salida: valores interpolados, del mismo tamaño que x_int
+             *
+             * Evalua el polinomio de Newton en forma anidada (Horner):
+             * p(x) = b0 + (x - x0) (b1 + (x - x1) (b2 + ...)), sin recalcular los productos.
+            */
+            void evaluar(span<const T> x_int, span<T> y_int) const {
+                MEDIR("newton::evaluar");
+                CONTAR("newton::evaluar::valores", x_int.size());
+                if (x_int.size() != y_int.size()){
+                    throw invalid_argument("x_int e y_int deben tener el mismo tamano");
+                }
+                const size_t m = b.size();
+                for (size_t k = 0; k < x_int.size(); k++){
+                    if (m == 0){
+                        y_int[k] = NAN;
+                        continue;
+                    }
+                    T xk = x_int[k];
+                    T f = b[m - 1];
+                    for (size_t i = m - 1; i > 0; i--){
+                        f = f * (xk - x[i - 1]) + b[i - 1];
+                    }
+                    y_int[k] = f;
+                }
+            }
+
             /**
              * @brief Construye y retorna el polinomio interpolante
             */
-            string polinomio(){
+            string polinomio() const {
                 ostringstream oss; // Flujo de salida de string
 
                 size_t i, j;
@@ -84,19 +199,18 @@ namespace interpolacion{
              * @param pos_Final Posicion final del intervalo
              * @return Valor interpolado
             */
-            double interpolar(double x_int, int pos_Inicial, int pos_Final){
-
+            T interpolar(T x_int, int pos_Inicial, int pos_Final) const {
                 int n = x.size();
 
                 // Validar que los coeficientes existan, y que pos_Inicial y pos_Final esten dentro del rango
                 if (b.size() == 0 || pos_Inicial < 0 || pos_Final >= n || pos_Inicial > pos_Final) {return NAN;}
 
-                double f = b[0];
+                T f = b[0];
 
                 size_t i, j;
 
                 for(i = 1; i < b.size(); i++){
-                    double prod = 1.0f;
+                    T prod = T(1);
                     for (j = 0; j < i; j++){
                         prod *= (x_int - x[j]);
                     };
@@ -113,7 +227,7 @@ namespace interpolacion{
              * @param grado Grado del polinomio p(x)
              * @return Valor interpolado
             */
-            double interpolar(double x_int, int grado){
+            T interpolar(T x_int, int grado){
                 //Validar que x_int este dentro del rango de x
                 if (x_int < x[0] || x_int >= x[x.size() - 1]){
                     return NAN;
@@ -157,8 +271,8 @@ namespace interpolacion{
                         return interpolar(x_int, pos_Inicial, pos_Final);
                     }
 
-                    double y_int_1 = interpolar(x_int, pos_Inicial, pos_Final);
-                    double y_int_2 = interpolar(x_int, pos_Inicial_aux, pos_Final_aux);
+                    T y_int_1 = interpolar(x_int, pos_Inicial, pos_Final);
+                    T y_int_2 = interpolar(x_int, pos_Inicial_aux, pos_Final_aux);
 
                     if (isnan(y_int_1)) {
                         return y_int_2;
@@ -169,18 +283,19 @@ namespace interpolacion{
                     // y_int_1 o y_int_2 son diferente de nan
                     //Sacar los datos de x en el intervalo pos_Inicial_aux, pos_Final_aux con el dato adicional
                     // con un for del x grande (pos_Inicial) sacr los datos a x1 (0), x1 es un subvector de x que tiene desde x[pos_Inicial_aux] hasta x[pos_Final_aux]
-                    vector<double> x1 (x.begin() + pos_Inicial, x.begin() + pos_Final);
+                    span<const T> x1 (x.begin() + pos_Inicial, x.begin() + pos_Final);
 
                     //Sacar los datos de y en el intervalo pos_Inicial_aux, pos_Final_aux con el dato adicional
-                    vector<double> y1 (y.begin() + pos_Inicial, y.begin() + pos_Final);
+                    span<const T> y1 (y.begin() + pos_Inicial, y.begin() + pos_Final);
 
-                    vector<double> F1 = calcular_coeficientes(x1, y1);
+                    std::pmr::vector<double> F1(x1.size(), util::temporales());
+                    calcular_coeficientes(x1, y1, F1);
 
                     //Calcular el error
-                    double prod_1 = 1.0f; //Ultimo coeficiente de F1
+                    double prod_1 = 1.0; //Ultimo coeficiente de F1
 
                     //Quitar el dato adicional del fin
-                    F1.erase(F1.end());
+                    F1.pop_back();
 
                     //Calcular la productoria de R * (x_int - x1[0]) * (x_int - x1[1]) * ... * (x_int - x1[n_puntos - 1]) sin tener en cuenta el dato adicional
                     for (size_t i = 0; i < F1.size(); i++) {
@@ -194,15 +309,16 @@ namespace interpolacion{
                     cout << "   Posicion Inicial: " << pos_Inicial << ", Posicion Final: " << pos_Final << endl;
                     cout << "   Error 1 (R1): " << error_int_1 << endl;
 
-                    vector<double> x2 (x.begin() + pos_Inicial_aux, x.begin() + pos_Final_aux);
+                    span<const T> x2 (x.begin() + pos_Inicial_aux, x.begin() + pos_Final_aux);
 
                     //Sacar los datos de y en el intervalo pos_Inicial_aux, pos_Final_aux con el dato adicional
-                    vector<double> y2 (y.begin() + pos_Inicial_aux, y.begin() + pos_Final_aux);
+                    span<const T> y2 (y.begin() + pos_Inicial_aux, y.begin() + pos_Final_aux);
 
-                    vector<double> F2 = calcular_coeficientes(x2, y2);
+                    std::pmr::vector<double> F2(x2.size(), util::temporales());
+                    calcular_coeficientes(x2, y2, F2);
 
                     //Calcular el error
-                    double prod_2 = 1.0f; //Ultimo coeficiente de F1
+                    double prod_2 = 1.0; //Ultimo coeficiente de F1
 
                     //Quitar el dato adicional del inicio
                     F2.erase(F2.begin());
@@ -237,12 +353,12 @@ namespace interpolacion{
              * @param pos_Final Posicion final del intervalo
              * @return Error de interpolacion
             */
-            double calcular_error_interpolacion(double x_int, int pos_Inicial, int pos_Final){
+            T calcular_error_interpolacion(T x_int, int pos_Inicial, int pos_Final) const {
 
-                double valor_interpolado = interpolar(x_int, pos_Inicial, pos_Final);
+                T valor_interpolado = interpolar(x_int, pos_Inicial, pos_Final);
 
                 int pos = lower_bound(x.begin(), x.end(), x_int) - x.begin();
-                double valor_real = y[pos];
+                T valor_real = y[pos];
 
                 return valor_interpolado - valor_real;
             }
@@ -253,10 +369,10 @@ namespace interpolacion{
              * @param grado Grado del polinomio p(x)
              * @return Error de interpolacion 
             */
-            double calcular_error_interpolacion(double x_int, double valor_interpolado){
+            T calcular_error_interpolacion(T x_int, T valor_interpolado) const {
 
                 int pos = lower_bound(x.begin(), x.end(), x_int) - x.begin();
-                double valor_real = y[pos];
+                T valor_real = y[pos];
 
                 return valor_interpolado - valor_real;
                 
@@ -267,87 +383,87 @@ namespace interpolacion{
              * @param x_int Valor de x a interpolar
              * @return Error de interpolacion
             */
-            double calcular_error_interpolacion(double x_int){
+            T calcular_error_interpolacion(T x_int) const {
                     
-                double valor_interpolado = interpolar(x_int);
+                T valor_interpolado = interpolar(x_int);
 
                 int pos = lower_bound(x.begin(), x.end(), x_int) - x.begin();
-                double valor_real = y[pos];
+                T valor_real = y[pos];
 
                 return valor_interpolado - valor_real;
             }           
 
             /**
-             * @brief Metodo estatico para calcular los coeficientes del polinomio
+             * @brief Metodo estatico para calcular los coeficientes del polinomio, en double
              * @param x Variable independiente
              * @param y Variable dependiente
-             * @param b Vector de coeficientes
              * @return Vector de coeficientes
             */
-            vector<double> static calcular_coeficientes(vector<double> x, vector<double> y){
-                
+            vector<double> static calcular_coeficientes(span<const T> x, span<const T> y){
+                vector<double> b(x.size());
+                calcular_coeficientes(x, y, b);
+                return b;
+            }
+
+            /**
+             * @brief Metodo estatico para calcular los coeficientes del polinomio sobre un arreglo dado, sin temporales
+             * @param x Variable independiente
+             * @param y Variable dependiente
+             * @param b Salida con un coeficiente por dato
+            */
+            static void calcular_coeficientes(span<const T> x, span<const T> y, span<double> b){
+                MEDIR("newton::calcular_coeficientes");
+
                 size_t i,j;
                 size_t n = x.size();
-                
-                // Matriz: vector de vectores
-                vector <vector <double>> f(n);
-
-                for (i = 0; i<n; i++){
-                    f[i].resize(n - i);
+                if (y.size() != n || b.size() != n){
+                    throw invalid_argument("Se necesita un coeficiente por dato");
                 }
 
                 // Llenar la primera columna
                 for (i = 0; i < n; i++){
-                    f[i][0] = y[i];
+                    b[i] = y[i];
                 }
 
-                // Llenar la matriz con las diferencias divididas
+                // Diferencias divididas por columnas, en sitio: al terminar la columna j,
+                // b[i] = f[i - j][j] para i >= j, y b[0..j] ya son los coeficientes
                 for (j = 1; j < n; j++){
-                    for (i = 0; i < n - j; i++){
-                        f[i][j] = (f[i + 1][j - 1] - f[i][j - 1]) / (x[i + j] - x[i]);
+                    for (i = n - 1; i >= j; i--){
+                        b[i] = (b[i] - b[i - 1]) / ((double)x[i] - (double)x[i - j]);
                     }
                 }
 
-                // Tomar los coeficientes de la primera fila de la matriz
-                return f[0];
-
             } 
 
         private:
             /** @brief Calcula los coeficientes del polinomio */
             void calcular_coeficientes(){
-                
-                size_t i,j;
-                size_t n = x.size();
-                
-                // Matriz: vector de vectores
-                vector <vector <double>> f(n);
-
-                for (i = 0; i<n; i++){
-                    f[i].resize(n - i);
-                }
-
-                // Llenar la primera columna
-                for (i = 0; i < n; i++){
-                    f[i][0] = y[i];
+                MEDIR("newton::ajuste");
+                if constexpr (std::is_same_v<T, double>){
+                    b = datos(calcular_coeficientes(x, y));
+                } else {
+                    // Los coeficientes en double son temporales: solo se guardan en T
+                    std::pmr::vector<double> c(x.size(), util::temporales());
+                    calcular_coeficientes(x, y, c);
+                    b = datos(util::convertir<T>(span<const double>(c)));
                 }
+            }
 
-                // Llenar la matriz con las diferencias divididas
-                for (j = 1; j < n; j++){
-                    for (i = 0; i < n - j; i++){
-                        f[i][j] = (f[i + 1][j - 1] - f[i][j - 1]) / (x[i + j] - x[i]);
-                    }
+            /** @brief Verifica que los coeficientes recibidos correspondan a los datos */
+            void validar_coeficientes() const {
+                if (x.size() != y.size() || b.size() != x.size()){
+                    throw invalid_argument("Se necesita un coeficiente por dato");
                 }
-
-                // Tomar los coeficientes de la primera fila de la matriz
-                b = f[0];
-
             }
-            vector <double> x; /*!< Variable independiente */
-            vector <double> y; /*!< Variable dependiente */
-            vector <double> b; /*!< Coeficientes b0, b1, ... del polinomio */
+
+            datos x; /*!< Variable independiente */
+            datos y; /*!< Variable dependiente */
+            datos b; /*!< Coeficientes b0, b1, ... del polinomio */
 
     };
+
+    using newton = basic_newton<double>; /*!< Polinomio de Newton en double */
+    using newton_f = basic_newton<float>; /*!< Polinomio de Newton en float, ajustado en double */
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,292 @@
+/**
+ * @file
+ * @brief Utilidades para repartir trabajo entre hilos
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+*/
+
+#ifndef PARALELO_H
+#define PARALELO_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using std::size_t;
+using std::vector;
+
+namespace paralelo {
+
+    /**
+     * @brief Cantidad de hilos del procesador
+     * @return Numero de hilos del procesador (al menos 1)
+    */
+    inline size_t hilos_disponibles(){
+        unsigned int n = std::thread::hardware_concurrency();
+        return (n == 0) ? 1 : n;
+    }
+
+    /**
+     * @brief Grupo de hilos persistente que ejecuta lotes de tareas indexadas
+     *
+     * El hilo que llama a ejecutar tambien trabaja. Las tareas se toman de
+     * un contador compartido, por lo que el resultado no debe depender de
+     * que hilo ejecuta cada tarea. Si ejecutar se llama desde dentro de una
+     * tarea, las tareas anidadas se ejecutan en el hilo que llama.
+    */
+    class grupo_hilos {
+        public:
+            /**
+             * @brief Crea el grupo de hilos
+             * @param n_hilos Cantidad total de hilos, incluyendo el que llama a ejecutar
+            */
+            explicit grupo_hilos(size_t n_hilos = hilos_disponibles()){
+                if (n_hilos == 0){
+                    n_hilos = 1;
+                }
+                for (size_t h = 1; h < n_hilos; h++){
+                    hilos.emplace_back([this](){ trabajar(); });
+                }
+            }
+
+            ~grupo_hilos(){
+                {
+                    std::lock_guard<std::mutex> guarda(mutex_estado);
+                    detener = true;
+                }
+                hay_trabajo.notify_all();
+                for (std::thread &hilo : hilos){
+                    hilo.join();
+                }
+            }
+
+            grupo_hilos(const grupo_hilos &) = delete;
+            grupo_hilos &operator=(const grupo_hilos &) = delete;
+
+            /**
+             * @brief Cantidad total de hilos del grupo
+            */
+            size_t tamano() const {
+                return hilos.size() + 1;
+            }
+
+            /**
+             * @brief Ejecuta tarea(i) para cada i en [0, n_tareas) y espera a que terminen
+             * @param n_tareas Cantidad de tareas
+             * @param tarea Funcion que recibe el indice de la tarea
+             *
+             * Si alguna tarea lanza una excepcion, se relanza la primera al terminar.
+            */
+            void ejecutar(size_t n_tareas, const std::function<void(size_t)> &tarea){
+                if (n_tareas == 0){
+                    return;
+                }
+                if (en_tarea() || hilos.empty() || n_tareas == 1){
+                    for (size_t i = 0; i < n_tareas; i++){
+                        tarea(i);
+                    }
+                    return;
+                }
+
+                std::lock_guard<std::mutex> exclusivo(mutex_ejecucion);
+                {
+                    std::lock_guard<std::mutex> guarda(mutex_estado);
+                    actual = &tarea;
+                    total = n_tareas;
+                    siguiente.store(0);
+                    error = nullptr;
+                    fallo.store(false);
+                    activos = hilos.size();
+                    generacion++;
+                }
+                hay_trabajo.notify_all();
+
+                consumir();
+
+                std::unique_lock<std::mutex> guarda(mutex_estado);
+                terminado.wait(guarda, [this](){ return activos == 0; });
+                actual = nullptr;
+
+                if (error){
+                    std::rethrow_exception(error);
+                }
+            }
+
+        private:
+            vector<std::thread> hilos; /*!< Hilos trabajadores */
+            std::mutex mutex_ejecucion; /*!< Serializa las llamadas a ejecutar */
+            std::mutex mutex_estado; /*!< Protege el estado compartido */
+            std::mutex mutex_error; /*!< Protege la primera excepcion */
+            std::condition_variable hay_trabajo; /*!< Avisa a los trabajadores de un nuevo lote */
+            std::condition_variable terminado; /*!< Avisa al que llama que los trabajadores terminaron */
+            const std::function<void(size_t)> *actual = nullptr; /*!< Lote en ejecucion */
+            size_t total = 0; /*!< Tareas del lote */
+            std::atomic<size_t> siguiente{0}; /*!< Siguiente tarea por tomar */
+            std::atomic<bool> fallo{false}; /*!< Alguna tarea lanzo una excepcion */
+            std::exception_ptr error; /*!< Primera excepcion */
+            size_t activos = 0; /*!< Trabajadores que no han terminado el lote */
+            size_t generacion = 0; /*!< Numero de lote */
+            bool detener = false; /*!< Indica a los trabajadores que terminen */
+
+            static bool &en_tarea_actual(){
+                thread_local bool en = false;
+                return en;
+            }
+
+            static bool en_tarea(){
+                return en_tarea_actual();
+            }
+
+            void consumir(){
+                en_tarea_actual() = true;
+                size_t i;
+                while (!fallo.load(std::memory_order_relaxed) &&
+                       (i = siguiente.fetch_add(1, std::memory_order_relaxed)) < total){
+                    try {
+                        (*actual)(i);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> guarda(mutex_error);
+                        if (!fallo.exchange(true)){
+                            error = std::current_exception();
+                        }
+                    }
+                }
+                en_tarea_actual() = false;
+            }
+
+            void trabajar(){
+                size_t visto = 0;
+                while (true){
+                    {
+                        std::unique_lock<std::mutex> guarda(mutex_estado);
+                        hay_trabajo.wait(guarda, [&](){ return detener || generacion != visto; });
+                        if (detener){
+                            return;
+                        }
+                        visto = generacion;
+                    }
+
+                    consumir();
+
+                    std::lock_guard<std::mutex> guarda(mutex_estado);
+                    if (--activos == 0){
+                        terminado.notify_one();
+                    }
+                }
+            }
+    };
+
+    /**
+     * @brief Grupo de hilos compartido por toda la biblioteca
+    */
+    inline grupo_hilos &grupo_compartido(){
+        static grupo_hilos grupo;
+        return grupo;
+    }
+
+    /**
+     * @brief Ejecuta tarea(i) para cada i en [0, n_tareas) en el grupo compartido
+     * @param n_tareas Cantidad de tareas
+     * @param tarea Funcion que recibe el indice de la tarea
+    */
+    template <typename F>
+    void para_cada(size_t n_tareas, F tarea){
+        grupo_compartido().ejecutar(n_tareas, [&](size_t i){ tarea(i); });
+    }
+
+    /**
+     * @brief Ejecuta tarea(i) para cada i en [0, n_tareas) con robo de trabajo
+     * @param grupo Grupo de hilos que ejecuta las tareas
+     * @param n_tareas Cantidad de tareas
+     * @param tarea Funcion que recibe el indice de la tarea
+     *
+     * Cada hilo recibe un rango contiguo de tareas y lo recorre en orden, lo
+     * que conserva la localidad de los datos. Un hilo que termina su rango
+     * roba la mitad final del rango con mas tareas pendientes, de modo que
+     * los hilos lentos o las tareas de costo desigual no dejan hilos ociosos.
+    */
+    template <typename F>
+    void para_cada_con_robo(grupo_hilos &grupo, size_t n_tareas, F tarea){
+        const size_t partes = std::min(n_tareas, grupo.tamano());
+        if (partes <= 1){
+            for (size_t i = 0; i < n_tareas; i++){
+                tarea(i);
+            }
+            return;
+        }
+
+        struct alignas(64) rango {
+            std::mutex mutex;
+            size_t inicio = 0;
+            size_t fin = 0;
+        };
+        vector<rango> rangos(partes);
+        for (size_t p = 0; p < partes; p++){
+            rangos[p].inicio = n_tareas * p / partes;
+            rangos[p].fin = n_tareas * (p + 1) / partes;
+        }
+
+        grupo.ejecutar(partes, [&](size_t propio){
+            while (true){
+                size_t i = 0;
+                bool hay = false;
+                {
+                    std::lock_guard<std::mutex> guarda(rangos[propio].mutex);
+                    if (rangos[propio].inicio < rangos[propio].fin){
+                        i = rangos[propio].inicio++;
+                        hay = true;
+                    }
+                }
+                if (hay){
+                    tarea(i);
+                    continue;
+                }
+
+                // Robar la mitad final del rango con mas tareas pendientes
+                size_t victima = partes, mayor = 0;
+                for (size_t p = 0; p < partes; p++){
+                    std::lock_guard<std::mutex> guarda(rangos[p].mutex);
+                    if (rangos[p].fin - rangos[p].inicio > mayor){
+                        mayor = rangos[p].fin - rangos[p].inicio;
+                        victima = p;
+                    }
+                }
+                if (victima == partes){
+                    return;
+                }
+                size_t inicio, fin;
+                {
+                    std::lock_guard<std::mutex> guarda(rangos[victima].mutex);
+                    size_t pendientes = rangos[victima].fin - rangos[victima].inicio;
+                    if (pendientes == 0){
+                        continue;
+                    }
+                    fin = rangos[victima].fin;
+                    inicio = fin - (pendientes + 1) / 2;
+                    rangos[victima].fin = inicio;
+                }
+                std::lock_guard<std::mutex> guarda(rangos[propio].mutex);
+                rangos[propio].inicio = inicio;
+                rangos[propio].fin = fin;
+            }
+        });
+    }
+
+    /**
+     * @brief Ejecuta tarea(i) para cada i en [0, n_tareas) en el grupo compartido, con robo de trabajo
+     * @param n_tareas Cantidad de tareas
+     * @param tarea Funcion que recibe el indice de la tarea
+    */
+    template <typename F>
+    void para_cada_con_robo(size_t n_tareas, F tarea){
+        para_cada_con_robo(grupo_compartido(), n_tareas, tarea);
+    }
+}
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * @file
+ * @brief Prueba de la regresion por grupos y de la combinacion de acumuladores
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Verifica que combinar acumuladores y tablas de acumuladores en cualquier
+ * orden da el mismo ajuste, salvo redondeo, aun con datos lejos del cero, y
+ * que ajustar_grupos coincide con ajustar cada grupo por separado con
+ * lineal_simple y cuadratica. Termina con codigo 1 si alguna verificacion
+ * falla.
+ *
+ * Compilar, por ejemplo:
+ * g++ -std=c++20 -O2 -pthread prueba_agrupada.cpp -o prueba_agrupada
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "agrupada.h"
+#include "regresion.h"
+
+using std::vector;
+
+namespace {
+    int fallas = 0; /*!< Verificaciones que no coincidieron */
+
+    /**
+     * @brief Compara un error con su tolerancia
+     * @param nombre Caso verificado
+     * @param error Error medido
+     * @param tolerancia Error maximo aceptado
+    */
+    void verificar(const char *nombre, double error, double tolerancia){
+        bool bien = error <= tolerancia;
+        std::printf("%-50s error %.3g, tolerancia %.3g %s\n", nombre, error, tolerancia, bien ? "ok" : "FALLA");
+        if (!bien){
+            fallas++;
+        }
+    }
+
+    /** @brief Diferencia relativa entre a y b */
+    double relativo(double a, double b){
+        double escala = std::max({std::fabs(a), std::fabs(b), 1e-300});
+        return std::fabs(a - b) / escala;
+    }
+
+    /** @brief Mayor diferencia relativa entre los ajustes lineal y cuadratico de dos acumuladores */
+    double diferencia(const regresion::acumulador &a, const regresion::acumulador &b){
+        regresion::solucion_lineal la = a.lineal(), lb = b.lineal();
+        regresion::solucion_cuadratica qa = a.cuadratica(), qb = b.cuadratica();
+        return std::max({relativo(la.b0, lb.b0), relativo(la.b1, lb.b1), relativo(la.sr, lb.sr),
+                         relativo(qa.a0, qb.a0), relativo(qa.a1, qb.a1), relativo(qa.a2, qb.a2),
+                         relativo(qa.sr, qb.sr)});
+    }
+}
+
+int main(){
+    std::mt19937_64 generador(11);
+    std::normal_distribution<double> ruido(0.0, 1.0);
+
+    // Datos lejos del cero, repartidos en tres acumuladores parciales
+    const size_t n = 30000;
+    vector<double> x(n), y(n);
+    vector<uint64_t> claves(n);
+    for (size_t i = 0; i < n; i++){
+        x[i] = 1e6 + 10.0 * ruido(generador);
+        double u = x[i] - 1e6;
+        y[i] = 1e9 + 3.0 * u + 0.05 * u * u + ruido(generador);
+        claves[i] = generador() % 7;
+    }
+
+    regresion::acumulador todo, partes[3];
+    for (size_t i = 0; i < n; i++){
+        todo.agregar(x[i], y[i]);
+        partes[(i * 5) % 3].agregar(x[i], y[i]);
+    }
+
+    regresion::acumulador abc, cba, bac;
+    abc.combinar(partes[0]);
+    abc.combinar(partes[1]);
+    abc.combinar(partes[2]);
+    cba.combinar(partes[2]);
+    cba.combinar(partes[1]);
+    cba.combinar(partes[0]);
+    bac = partes[1];
+    bac.combinar(partes[0]);
+    bac.combinar(partes[2]);
+    verificar("acumulador: orden (a b c) contra (c b a)", diferencia(abc, cba), 1e-9);
+    verificar("acumulador: orden (a b c) contra (b a c)", diferencia(abc, bac), 1e-9);
+    verificar("acumulador: combinado contra una sola pasada", diferencia(abc, todo), 1e-9);
+
+    regresion::acumulador vacio, con_vacio = todo;
+    con_vacio.combinar(vacio);
+    vacio.combinar(todo);
+    verificar("acumulador: combinar con uno vacio", std::max(diferencia(con_vacio, todo), diferencia(vacio, todo)), 0.0);
+
+    // Tablas de acumuladores combinadas en distinto orden
+    regresion::tabla_acumuladores tablas[3];
+    for (size_t i = 0; i < n; i++){
+        tablas[i % 3][claves[i]].agregar(x[i], y[i]);
+    }
+    regresion::tabla_acumuladores directa, inversa;
+    for (size_t t = 0; t < 3; t++){
+        directa.combinar(tablas[t]);
+        inversa.combinar(tablas[2 - t]);
+    }
+    double error_tablas = 0.0;
+    directa.para_cada([&](uint64_t clave, const regresion::acumulador &acc){
+        error_tablas = std::max(error_tablas, diferencia(acc, inversa[clave]));
+    });
+    verificar("tabla_acumuladores: combinar en otro orden", error_tablas, 1e-9);
+    verificar("tabla_acumuladores: mismos grupos", std::fabs((double)directa.size() - (double)inversa.size()), 0.0);
+
+    // ajustar_grupos contra un ajuste por grupo; los datos se centran porque
+    // lineal_simple y cuadratica suman potencias de x sin trasladar
+    vector<double> xc(n), yc(n);
+    std::map<uint64_t, vector<double>> gx, gy;
+    for (size_t i = 0; i < n; i++){
+        xc[i] = x[i] - 1e6;
+        yc[i] = y[i] - 1e9;
+        gx[claves[i]].push_back(xc[i]);
+        gy[claves[i]].push_back(yc[i]);
+    }
+    regresion::tabla_grupos lineales = regresion::ajustar_grupos(claves, xc, yc, regresion::modelo_grupo::lineal);
+    regresion::tabla_grupos cuadraticas = regresion::ajustar_grupos(claves, xc, yc, regresion::modelo_grupo::cuadratica);
+    double error_lineal = 0.0, error_cuadratica = 0.0, error_orden = 0.0;
+    for (size_t g = 0; g < lineales.clave.size(); g++){
+        uint64_t clave = lineales.clave[g];
+        if (g > 0 && !(lineales.clave[g - 1] < clave)){
+            error_orden = 1.0;
+        }
+        regresion::solucion_lineal l = regresion::lineal_simple(util::prestado, gx[clave], gy[clave]).calcular();
+        regresion::solucion_cuadratica q = regresion::cuadratica(util::prestado, gx[clave], gy[clave]).calcular();
+        error_lineal = std::max({error_lineal, relativo(lineales.c0[g], l.b0), relativo(lineales.c1[g], l.b1),
+                                 relativo(lineales.sr[g], l.sr)});
+        error_cuadratica = std::max({error_cuadratica, relativo(cuadraticas.c0[g], q.a0), relativo(cuadraticas.c1[g], q.a1),
+                                     relativo(cuadraticas.c2[g], q.a2), relativo(cuadraticas.sr[g], q.sr)});
+    }
+    verificar("ajustar_grupos: cantidad de grupos", std::fabs((double)lineales.clave.size() - (double)gx.size()), 0.0);
+    verificar("ajustar_grupos: ordenados por clave", error_orden, 0.0);
+    verificar("ajustar_grupos: lineal contra lineal_simple", error_lineal, 1e-8);
+    verificar("ajustar_grupos: cuadratica contra cuadratica", error_cuadratica, 1e-6);
+
+    if (fallas > 0){
+        std::printf("%d verificaciones fallaron\n", fallas);
+        return 1;
+    }
+    std::printf("Todas las verificaciones pasaron\n");
+    return 0;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file
+ * @brief Prueba de la interpolacion cubica con pendientes locales: PCHIP y Akima
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Verifica, para pchip y akima, que la interpolacion pasa por los datos,
+ * reproduce una recta y da NaN fuera del rango, y que actualizar un dato
+ * deja las mismas pendientes que ajustar de nuevo. Para pchip verifica
+ * ademas que con datos monotonos, con tramos planos, la interpolacion es
+ * monotona y no sale del rango de cada intervalo. Termina con codigo 1 si
+ * alguna verificacion falla.
+ *
+ * Compilar, por ejemplo:
+ * g++ -std=c++20 -O2 -pthread prueba_cubica_local.cpp -o prueba_cubica_local
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cubica_local.h"
+
+using std::string;
+using std::vector;
+
+namespace {
+    int fallas = 0; /*!< Verificaciones que no coincidieron */
+
+    /**
+     * @brief Compara un error con su tolerancia
+     * @param nombre Caso verificado
+     * @param error Error medido
+     * @param tolerancia Error maximo aceptado
+    */
+    void verificar(const string &nombre, double error, double tolerancia){
+        bool bien = error <= tolerancia;
+        std::printf("%-50s error %.3g, tolerancia %.3g %s\n", nombre.c_str(), error, tolerancia, bien ? "ok" : "FALLA");
+        if (!bien){
+            fallas++;
+        }
+    }
+
+    /** @brief Mayor diferencia entre las pendientes de dos interpolaciones */
+    template <typename C>
+    double diferencia_pendientes(const C &a, const C &b){
+        span<const double> da = a.pendientes(), db = b.pendientes();
+        double error = 0.0;
+        for (size_t i = 0; i < da.size(); i++){
+            error = std::max(error, std::fabs(da[i] - db[i]));
+        }
+        return error;
+    }
+
+    /**
+     * @brief Verificaciones comunes a los dos esquemas
+     * @param nombre Nombre del esquema
+     * @param x Variable independiente
+     * @param y Variable dependiente
+    */
+    template <typename C>
+    void comunes(const string &nombre, const vector<double> &x, const vector<double> &y){
+        const size_t n = x.size();
+        C c(x, y);
+
+        double error = 0.0;
+        for (size_t i = 0; i < n; i++){
+            error = std::max(error, std::fabs(c.interpolar(x[i]) - y[i]));
+        }
+        verificar(nombre + ": pasa por los datos", error, 1e-12);
+        verificar(nombre + ": NaN fuera del rango",
+                  std::isnan(c.interpolar(x.front() - 0.5)) && std::isnan(c.interpolar(x.back() + 0.5)) ? 0.0 : 1.0, 0.0);
+
+        // Datos alineados en una recta
+        vector<double> recta(n);
+        for (size_t i = 0; i < n; i++){
+            recta[i] = 2.5 - 0.75 * x[i];
+        }
+        C r(x, recta);
+        error = 0.0;
+        for (size_t k = 0; k <= 10000; k++){
+            double t = x.front() + (x.back() - x.front()) * (double)k / 10000.0;
+            error = std::max(error, std::fabs(r.interpolar(t) - (2.5 - 0.75 * t)));
+        }
+        verificar(nombre + ": reproduce una recta", error, 1e-12);
+
+        // actualizar contra ajustar de nuevo, en los extremos, junto a ellos y en el centro
+        vector<double> xa = x, ya = y;
+        error = 0.0;
+        for (size_t i : {(size_t)0, (size_t)1, (size_t)2, n / 2, n - 3, n - 2, n - 1}){
+            ya[i] = -3.0 * ya[i] + 1.0;
+            c.actualizar(i, ya[i]);
+            error = std::max(error, diferencia_pendientes(c, C(xa, ya)));
+        }
+        verificar(nombre + ": actualizar(i, y) contra reajustar", error, 1e-14);
+
+        error = 0.0;
+        for (size_t i : {(size_t)0, (size_t)1, n / 2, n - 2, n - 1}){
+            double izquierda = i > 0 ? xa[i - 1] : xa[i] - 1.0;
+            double derecha = i + 1 < n ? xa[i + 1] : xa[i] + 1.0;
+            xa[i] = 0.3 * izquierda + 0.7 * derecha;
+            ya[i] += 0.5;
+            c.actualizar(i, xa[i], ya[i]);
+            error = std::max(error, diferencia_pendientes(c, C(xa, ya)));
+        }
+        verificar(nombre + ": actualizar(i, x, y) contra reajustar", error, 1e-14);
+    }
+}
+
+int main(){
+    std::mt19937_64 generador(48);
+    std::uniform_real_distribution<double> paso(0.2, 1.0);
+    std::normal_distribution<double> ruido(0.0, 1.0);
+
+    const size_t n = 200;
+    vector<double> x(n), y(n);
+    double v = 0.0;
+    for (size_t i = 0; i < n; i++){
+        v += paso(generador);
+        x[i] = v;
+        y[i] = 5.0 * std::sin(0.4 * v) + ruido(generador);
+    }
+    comunes<interpolacion::pchip>("pchip", x, y);
+    comunes<interpolacion::akima>("akima", x, y);
+
+    // Datos crecientes con saltos y tramos planos
+    vector<double> escalones(n);
+    double nivel = 0.0;
+    for (size_t i = 0; i < n; i++){
+        if (i % 5 == 0){
+            nivel += std::fabs(ruido(generador)) * (i % 20 == 0 ? 10.0 : 1.0);
+        }
+        escalones[i] = nivel;
+    }
+    interpolacion::pchip p(x, escalones);
+    double retroceso = 0.0, desborde = 0.0;
+    double anterior = p.interpolar(x.front());
+    for (size_t i = 1; i < n; i++){
+        for (size_t k = 1; k <= 200; k++){
+            double t = x[i - 1] + (x[i] - x[i - 1]) * (double)k / 200.0;
+            double valor = p.interpolar(t);
+            retroceso = std::max(retroceso, anterior - valor);
+            desborde = std::max({desborde, escalones[i - 1] - valor, valor - escalones[i]});
+            anterior = valor;
+        }
+    }
+    // Los retrocesos permitidos son solo de redondeo al evaluar el polinomio
+    verificar("pchip: monotona con datos monotonos", retroceso, 1e-12);
+    verificar("pchip: dentro del rango de cada intervalo", desborde, 1e-12);
+
+    if (fallas > 0){
+        std::printf("%d verificaciones fallaron\n", fallas);
+        return 1;
+    }
+    std::printf("Todas las verificaciones pasaron\n");
+    return 0;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file
+ * @brief Prueba de las asignaciones de memoria documentadas en util::basic_datos
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Cuenta las llamadas a operator new, reemplazandolo, al construir, copiar y
+ * mover arreglos de datos y modelos. Copiar asigna una vez por arreglo;
+ * mover o tomar prestado no asigna. Termina con codigo 1 si alguna cuenta
+ * no coincide.
+ *
+ * Compilar, por ejemplo:
+ * g++ -std=c++20 -O2 -pthread prueba_datos.cpp -o prueba_datos
+*/
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "datos.h"
+#include "regresion.h"
+
+using std::vector;
+
+namespace {
+    size_t asignaciones = 0; /*!< Llamadas a operator new */
+    int fallas = 0; /*!< Verificaciones que no coincidieron */
+
+    /**
+     * @brief Compara las asignaciones hechas desde antes con las esperadas
+     * @param nombre Caso verificado
+     * @param antes Asignaciones al iniciar el caso
+     * @param esperadas Asignaciones que documenta el caso
+    */
+    void verificar(const char *nombre, size_t antes, size_t esperadas){
+        size_t hechas = asignaciones - antes;
+        bool bien = hechas == esperadas;
+        std::printf("%-40s esperadas %zu, hechas %zu %s\n", nombre, esperadas, hechas, bien ? "ok" : "FALLA");
+        if (!bien){
+            fallas++;
+        }
+    }
+}
+
+// El operator delete reemplazado libera con free la memoria que el operator new
+// reemplazado obtuvo con malloc; GCC no lo reconoce al expandir las llamadas en linea
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void *operator new(std::size_t tamano){
+    asignaciones++;
+    if (void *p = std::malloc(tamano == 0 ? 1 : tamano)){
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t tamano){
+    return ::operator new(tamano);
+}
+
+void operator delete(void *p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept {
+    ::operator delete(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept {
+    ::operator delete(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept {
+    ::operator delete(p);
+}
+
+int main(){
+    const vector<double> x = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0};
+    const vector<double> y = {2.0, 4.1, 5.9, 8.2, 9.8, 12.1};
+    size_t antes;
+
+    // Arreglo de datos
+    antes = asignaciones;
+    util::datos copiado{span<const double>(x)};
+    verificar("datos: copia de una vista", antes, 1);
+
+    antes = asignaciones;
+    util::datos copia_propia(copiado);
+    verificar("datos: copia de un arreglo propio", antes, 1);
+
+    vector<double> v = x;
+    antes = asignaciones;
+    util::datos movido_vector(std::move(v));
+    verificar("datos: vector movido", antes, 0);
+
+    antes = asignaciones;
+    util::datos movido(std::move(copia_propia));
+    verificar("datos: movido", antes, 0);
+
+    antes = asignaciones;
+    util::datos asignado;
+    asignado = std::move(movido);
+    verificar("datos: asignacion por movimiento", antes, 0);
+
+    antes = asignaciones;
+    util::datos prestado(util::prestado, x);
+    verificar("datos: prestado", antes, 0);
+
+    antes = asignaciones;
+    util::datos copia_prestada(prestado);
+    verificar("datos: copia de un arreglo prestado", antes, 0);
+
+    // Modelo con dos arreglos: x e y
+    antes = asignaciones;
+    regresion::lineal_simple modelo_copia(x, y);
+    verificar("lineal_simple: copia de x e y", antes, 2);
+
+    vector<double> mx = x, my = y;
+    antes = asignaciones;
+    regresion::lineal_simple modelo_movido(std::move(mx), std::move(my));
+    verificar("lineal_simple: x e y movidos", antes, 0);
+
+    antes = asignaciones;
+    regresion::lineal_simple modelo_prestado(util::prestado, x, y);
+    verificar("lineal_simple: x e y prestados", antes, 0);
+
+    antes = asignaciones;
+    regresion::lineal_simple modelo_copiado(modelo_copia);
+    verificar("lineal_simple: copia del modelo", antes, 2);
+
+    antes = asignaciones;
+    regresion::lineal_simple modelo_trasladado(std::move(modelo_copiado));
+    verificar("lineal_simple: modelo movido", antes, 0);
+
+    if (fallas > 0){
+        std::printf("%d verificaciones fallaron\n", fallas);
+        return 1;
+    }
+    std::printf("Todas las verificaciones pasaron\n");
+    return 0;
+}
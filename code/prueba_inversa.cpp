@@ -0,0 +1,247 @@
+/**
+ * @file
+ * @brief Prueba de la interpolacion inversa contra un recorrido denso
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Compara los cruces de inversa con los de recorrer densamente cada
+ * intervalo y biseccionar cada cambio de signo. La referencia sigue la
+ * convencion documentada en inversa.h: un dato con y[i] igual al valor
+ * buscado es un cruce exacto en x[i], y de un intervalo constante igual al
+ * valor solo se reporta su inicio. Se prueban valores al azar, valores
+ * iguales a los datos, un minimo justo en un dato, datos con tramos planos
+ * y datos constantes, con spline3 y con pchip. Termina con codigo 1 si
+ * alguna verificacion falla.
+ *
+ * Compilar, por ejemplo:
+ * g++ -std=c++20 -O2 -pthread prueba_inversa.cpp -o prueba_inversa
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cubica_local.h"
+#include "inversa.h"
+#include "spline3.h"
+
+using std::string;
+using std::vector;
+
+namespace {
+    int fallas = 0; /*!< Verificaciones que no coincidieron */
+
+    /**
+     * @brief Compara un error con su tolerancia
+     * @param nombre Caso verificado
+     * @param error Error medido
+     * @param tolerancia Error maximo aceptado
+    */
+    void verificar(const string &nombre, double error, double tolerancia){
+        bool bien = error <= tolerancia;
+        std::printf("%-50s error %.3g, tolerancia %.3g %s\n", nombre.c_str(), error, tolerancia, bien ? "ok" : "FALLA");
+        if (!bien){
+            fallas++;
+        }
+    }
+
+    /**
+     * @brief Cruces por fuerza bruta: cada intervalo se recorre en muestras y cada cambio de signo se bisecciona
+     * @param c Interpolacion con datos_x(), datos_y() e interpolar()
+     * @param constante Si cada intervalo i (de x[i - 1] a x[i]) es constante; constante[0] no se usa
+     * @param objetivo Valor buscado
+     * @param muestras Muestras por intervalo
+    */
+    template <typename C>
+    vector<double> bruto(const C &c, const vector<bool> &constante, double objetivo, size_t muestras){
+        span<const double> x = c.datos_x(), y = c.datos_y();
+        const size_t n = x.size();
+        vector<double> r;
+        for (size_t i = 0; i < n; i++){
+            // Un dato igual al valor es un cruce, salvo si solo cierra el ultimo intervalo constante
+            if (y[i] == objetivo && !(i == n - 1 && constante[n - 1])){
+                r.push_back(x[i]);
+            }
+            if (i == n - 1 || constante[i + 1]){
+                continue;
+            }
+            // Cruces dentro de (x[i], x[i + 1]), con los extremos en los valores exactos de los datos
+            double a = x[i], ga = y[i] - objetivo;
+            for (size_t k = 1; k <= muestras; k++){
+                double b = (k == muestras) ? x[i + 1] : x[i] + (x[i + 1] - x[i]) * (double)k / (double)muestras;
+                double gb = (k == muestras) ? y[i + 1] - objetivo : c.interpolar(b) - objetivo;
+                if (gb == 0.0 && k < muestras){
+                    r.push_back(b);
+                } else if (ga != 0.0 && gb != 0.0 && (ga < 0.0) != (gb < 0.0)){
+                    double lo = a, hi = b;
+                    for (int it = 0; it < 200 && lo < hi; it++){
+                        double medio = 0.5 * (lo + hi);
+                        if (medio <= lo || medio >= hi){
+                            break;
+                        }
+                        double gm = c.interpolar(medio) - objetivo;
+                        if (gm == 0.0){
+                            lo = hi = medio;
+                        } else if ((gm < 0.0) == (ga < 0.0)){
+                            lo = medio;
+                        } else {
+                            hi = medio;
+                        }
+                    }
+                    r.push_back(0.5 * (lo + hi));
+                }
+                a = b;
+                ga = gb;
+            }
+        }
+        std::sort(r.begin(), r.end());
+        return r;
+    }
+
+    /** @brief Diferencia entre dos listas de cruces; si no tienen el mismo tamaño es infinita */
+    double diferencia(const vector<double> &a, const vector<double> &b){
+        if (a.size() != b.size()){
+            return INFINITY;
+        }
+        double error = 0.0;
+        for (size_t k = 0; k < a.size(); k++){
+            error = std::max(error, std::fabs(a[k] - b[k]));
+        }
+        return error;
+    }
+
+    /** @brief Intervalos constantes de un trazador, por sus coeficientes */
+    vector<bool> constantes(const interpolacion::spline3 &s){
+        vector<double> c = s.coeficientes();
+        vector<bool> r(c.size() / 4 + 1, false);
+        for (size_t i = 1; i < r.size(); i++){
+            const double *ci = c.data() + 4 * (i - 1);
+            r[i] = ci[1] == 0.0 && ci[2] == 0.0 && ci[3] == 0.0;
+        }
+        return r;
+    }
+
+    /** @brief Intervalos constantes de una interpolacion pchip: valores iguales y pendientes nulas */
+    vector<bool> constantes(const interpolacion::pchip &p){
+        span<const double> y = p.datos_y(), d = p.pendientes();
+        vector<bool> r(y.size(), false);
+        for (size_t i = 1; i < r.size(); i++){
+            r[i] = y[i - 1] == y[i] && d[i - 1] == 0.0 && d[i] == 0.0;
+        }
+        return r;
+    }
+
+    /**
+     * @brief Compara inversa con la fuerza bruta para una lista de valores
+     * @param nombre Caso verificado
+     * @param c Interpolacion
+     * @param objetivos Valores buscados
+     * @param muestras Muestras por intervalo de la fuerza bruta
+    */
+    template <typename C>
+    void comparar(const string &nombre, const C &c, const vector<double> &objetivos, size_t muestras){
+        interpolacion::inversa inv(c);
+        vector<bool> constante = constantes(c);
+        double escala = c.datos_x().back() - c.datos_x().front();
+        double error = 0.0;
+        for (double objetivo : objetivos){
+            error = std::max(error, diferencia(inv.cruces(objetivo), bruto(c, constante, objetivo, muestras)) / escala);
+        }
+        verificar(nombre, error, 1e-10);
+    }
+}
+
+int main(){
+    std::mt19937_64 generador(50);
+    std::uniform_real_distribution<double> paso(0.1, 1.0), uniforme(0.0, 1.0);
+
+    // Trazador oscilante: valores al azar y valores iguales a los datos
+    const size_t n = 150;
+    vector<double> x(n), y(n);
+    double v = 0.0;
+    for (size_t i = 0; i < n; i++){
+        v += paso(generador);
+        x[i] = v;
+        y[i] = 3.0 * std::sin(v) + uniforme(generador);
+    }
+    interpolacion::spline3 s(util::prestado, x, y);
+    interpolacion::inversa inv(s);
+    vector<double> azar(60);
+    for (double &o : azar){
+        o = inv.minimo() - 0.05 + (inv.maximo() - inv.minimo() + 0.1) * uniforme(generador);
+    }
+    comparar("spline3: valores al azar", s, azar, 400);
+    vector<double> en_datos;
+    for (size_t i = 0; i < n; i += 5){
+        en_datos.push_back(y[i]);
+    }
+    comparar("spline3: valores iguales a los datos", s, en_datos, 400);
+
+    size_t exactos = 0;
+    for (size_t i = 0; i < n; i++){
+        vector<double> r = inv.cruces(y[i]);
+        exactos += std::find(r.begin(), r.end(), x[i]) != r.end() ? 1 : 0;
+    }
+    verificar("spline3: cruce exacto en cada dato", (double)(n - exactos), 0.0);
+
+    double residuo = 0.0;
+    for (double o : azar){
+        for (double r : inv.cruces(o)){
+            residuo = std::max(residuo, std::fabs(s.interpolar(r) - o));
+        }
+    }
+    verificar("spline3: residuo de los cruces", residuo, 1e-12);
+
+    // El lote da lo mismo que las consultas sueltas
+    interpolacion::cruces_lote lote = inv.cruces(span<const double>(azar), 3);
+    double error_lote = lote.size() == azar.size() ? 0.0 : INFINITY;
+    for (size_t k = 0; k < azar.size() && error_lote == 0.0; k++){
+        error_lote = std::max(error_lote, diferencia(inv.cruces(azar[k]), vector<double>(lote[k].begin(), lote[k].end())));
+    }
+    verificar("spline3: lote contra consultas sueltas", error_lote, 0.0);
+
+    // Minimo justo en un dato: el valor toca sin cruzar
+    vector<double> xp = {-2.0, -1.0, 0.0, 1.0, 2.0}, yp = {4.0, 1.0, 0.0, 1.0, 4.0};
+    interpolacion::spline3 parabola(xp, yp);
+    comparar("spline3: minimo en un dato", parabola, {0.0, 1.0, 0.5, 4.0}, 2000);
+    verificar("spline3: minimo en un dato, un solo cruce", diferencia(interpolacion::inversa(parabola).cruces(0.0), {0.0}), 0.0);
+
+    // Tramos planos con pchip, iguales al valor buscado y entre ellos
+    vector<double> xe(n), ye(n);
+    double nivel = 0.0;
+    for (size_t i = 0; i < n; i++){
+        xe[i] = x[i];
+        if (i % 6 == 0){
+            nivel += std::floor(1.0 + 4.0 * uniforme(generador));
+        }
+        ye[i] = (i % 12 < 6) ? nivel : nivel - 0.5 * (double)(i % 6);
+    }
+    interpolacion::pchip escalones(xe, ye);
+    vector<double> planos;
+    for (size_t i = 0; i < n; i += 6){
+        planos.push_back(ye[i]);
+        planos.push_back(ye[i] + 0.25);
+    }
+    comparar("pchip: tramos planos", escalones, planos, 400);
+
+    vector<double> xf = {0.0, 1.0, 2.0, 3.0, 4.0}, yf = {0.0, 1.0, 1.0, 1.0, 2.0};
+    interpolacion::pchip meseta(xf, yf);
+    verificar("pchip: inicio de cada intervalo plano", diferencia(interpolacion::inversa(meseta).cruces(1.0), {1.0, 2.0, 3.0}), 0.0);
+    comparar("pchip: meseta", meseta, {0.0, 0.5, 1.0, 1.5, 2.0}, 2000);
+
+    // Datos constantes: todos los intervalos son planos
+    vector<double> yc(xf.size(), 7.0);
+    interpolacion::spline3 constante(xf, yc);
+    verificar("spline3: datos constantes", diferencia(interpolacion::inversa(constante).cruces(7.0), {0.0, 1.0, 2.0, 3.0}), 0.0);
+    comparar("spline3: datos constantes", constante, {6.0, 7.0, 8.0}, 100);
+
+    if (fallas > 0){
+        std::printf("%d verificaciones fallaron\n", fallas);
+        return 1;
+    }
+    std::printf("Todas las verificaciones pasaron\n");
+    return 0;
+}
@@ -0,0 +1,186 @@
+/**
+ * @file
+ * @brief Prueba de la interpolacion en dos variables sobre mallas rectilineas
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Compara cada metodo de malla2d.h con su definicion en una variable,
+ * aplicada primero en y y luego en x: bicubico con spline3 anidado,
+ * newton_local con el polinomio de Newton por los 4 nodos mas cercanos de
+ * cada eje y bilineal con la formula de las 4 esquinas. Verifica tambien
+ * que los tres pasan por los nodos, que evaluar coincide con interpolar y
+ * que fuera del rango dan NaN, en mallas de 2 x 2 hasta 40 x 23, uniformes
+ * y no uniformes. Termina con codigo 1 si alguna verificacion falla.
+ *
+ * Compilar, por ejemplo:
+ * g++ -std=c++20 -O2 -pthread prueba_malla2d.cpp -o prueba_malla2d
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "malla2d.h"
+#include "newton.h"
+#include "spline3.h"
+
+using std::string;
+using std::vector;
+
+namespace {
+    int fallas = 0; /*!< Verificaciones que no coincidieron */
+
+    /**
+     * @brief Compara un error con su tolerancia
+     * @param nombre Caso verificado
+     * @param error Error medido
+     * @param tolerancia Error maximo aceptado
+    */
+    void verificar(const string &nombre, double error, double tolerancia){
+        bool bien = error <= tolerancia;
+        std::printf("%-50s error %.3g, tolerancia %.3g %s\n", nombre.c_str(), error, tolerancia, bien ? "ok" : "FALLA");
+        if (!bien){
+            fallas++;
+        }
+    }
+
+    /** @brief Intervalo [e[c], e[c + 1]] que contiene a v, con v dentro del rango */
+    size_t intervalo(const vector<double> &e, double v){
+        size_t c = std::upper_bound(e.begin(), e.end(), v) - e.begin();
+        return std::min(c > 0 ? c - 1 : 0, e.size() - 2);
+    }
+
+    /** @brief Primer nodo de los min(4, n) nodos mas cercanos al intervalo c */
+    size_t primer_nodo(size_t c, size_t n){
+        size_t nodos = std::min<size_t>(4, n);
+        return std::min(c > 0 ? c - 1 : 0, n - nodos);
+    }
+
+    /**
+     * @brief Verifica los tres metodos sobre una malla
+     * @param x Eje x, creciente
+     * @param y Eje y, creciente
+     * @param generador Fuente de los puntos de consulta
+    */
+    void probar_malla(const vector<double> &x, const vector<double> &y, std::mt19937_64 &generador){
+        const size_t nx = x.size(), ny = y.size();
+        vector<double> z(nx * ny);
+        for (size_t i = 0; i < nx; i++){
+            for (size_t j = 0; j < ny; j++){
+                z[i * ny + j] = std::sin(x[i]) * std::cos(2.0 * y[j]) + x[i] * y[j];
+            }
+        }
+        interpolacion2d::bilineal bl(x, y, z);
+        interpolacion2d::bicubico bc(x, y, z);
+        interpolacion2d::newton_local nl(x, y, z);
+        const string malla = std::to_string(nx) + " x " + std::to_string(ny) + ": ";
+
+        std::uniform_real_distribution<double> ux(x.front(), x.back()), uy(y.front(), y.back());
+        const size_t consultas = 300;
+        vector<double> xq(consultas), yq(consultas);
+        double e_bl = 0.0, e_bc = 0.0, e_nl = 0.0;
+        for (size_t q = 0; q < consultas; q++){
+            xq[q] = ux(generador);
+            yq[q] = uy(generador);
+            size_t ci = intervalo(x, xq[q]), cj = intervalo(y, yq[q]);
+
+            // Bicubico: trazador en y por cada fila y luego en x
+            vector<double> columna(nx);
+            for (size_t i = 0; i < nx; i++){
+                vector<double> fila(z.begin() + i * ny, z.begin() + (i + 1) * ny);
+                columna[i] = interpolacion::spline3(y, fila).interpolar(yq[q]);
+            }
+            double ref_bc = interpolacion::spline3(x, columna).interpolar(xq[q]);
+            e_bc = std::max(e_bc, std::fabs(ref_bc - bc.interpolar(xq[q], yq[q])));
+
+            // Newton local: polinomio por los nodos mas cercanos de cada eje
+            size_t sx = primer_nodo(ci, nx), sy = primer_nodo(cj, ny);
+            size_t kx = std::min<size_t>(4, nx), ky = std::min<size_t>(4, ny);
+            vector<double> yy(y.begin() + sy, y.begin() + sy + ky), xx(x.begin() + sx, x.begin() + sx + kx);
+            vector<double> cx(kx), zz(ky);
+            for (size_t m = 0; m < kx; m++){
+                for (size_t k = 0; k < ky; k++){
+                    zz[k] = z[(sx + m) * ny + sy + k];
+                }
+                cx[m] = interpolacion::newton(yy, zz).interpolar(yq[q]);
+            }
+            double ref_nl = interpolacion::newton(xx, cx).interpolar(xq[q]);
+            e_nl = std::max(e_nl, std::fabs(ref_nl - nl.interpolar(xq[q], yq[q])));
+
+            // Bilineal: formula de las 4 esquinas
+            double t = (xq[q] - x[ci]) / (x[ci + 1] - x[ci]), s = (yq[q] - y[cj]) / (y[cj + 1] - y[cj]);
+            double ref_bl = (1.0 - t) * (1.0 - s) * z[ci * ny + cj] + t * (1.0 - s) * z[(ci + 1) * ny + cj]
+                          + (1.0 - t) * s * z[ci * ny + cj + 1] + t * s * z[(ci + 1) * ny + cj + 1];
+            e_bl = std::max(e_bl, std::fabs(ref_bl - bl.interpolar(xq[q], yq[q])));
+        }
+        verificar(malla + "bicubico contra spline3 anidado", e_bc, 1e-10);
+        verificar(malla + "newton_local contra newton anidado", e_nl, 1e-10);
+        verificar(malla + "bilineal contra las 4 esquinas", e_bl, 1e-12);
+
+        double e_nodos = 0.0;
+        for (size_t i = 0; i < nx; i++){
+            for (size_t j = 0; j < ny; j++){
+                double valor = z[i * ny + j];
+                e_nodos = std::max({e_nodos, std::fabs(bl.interpolar(x[i], y[j]) - valor),
+                                    std::fabs(bc.interpolar(x[i], y[j]) - valor),
+                                    std::fabs(nl.interpolar(x[i], y[j]) - valor)});
+            }
+        }
+        verificar(malla + "pasan por los nodos", e_nodos, 1e-11);
+
+        // Lote con grano pequeño contra consultas sueltas
+        vector<double> lote(consultas);
+        bc.evaluar(xq, yq, lote, 7);
+        double e_lote = 0.0;
+        for (size_t q = 0; q < consultas; q++){
+            e_lote = std::max(e_lote, std::fabs(lote[q] - bc.interpolar(xq[q], yq[q])));
+        }
+        verificar(malla + "evaluar contra interpolar", e_lote, 0.0);
+
+        bool nan = std::isnan(bc.interpolar(x.front() - 1.0, y.front())) && std::isnan(nl.interpolar(x.front(), y.back() + 1.0))
+                   && std::isnan(bl.interpolar(x.back() + 1.0, y.front() - 1.0));
+        verificar(malla + "NaN fuera del rango", nan ? 0.0 : 1.0, 0.0);
+    }
+}
+
+int main(){
+    std::mt19937_64 generador(49);
+    std::uniform_real_distribution<double> paso(0.2, 1.0);
+
+    // Ejes no uniformes de varios tamaños, incluidos los de menos de 4 nodos
+    const size_t tamanos[][2] = {{2, 2}, {2, 5}, {3, 4}, {5, 3}, {7, 9}, {40, 23}};
+    for (const auto &t : tamanos){
+        vector<double> x(t[0]), y(t[1]);
+        double v = 0.0;
+        for (double &e : x){
+            v += paso(generador);
+            e = v;
+        }
+        v = -1.0;
+        for (double &e : y){
+            v += paso(generador);
+            e = v;
+        }
+        probar_malla(x, y, generador);
+    }
+
+    // Ejes uniformes, que ubican la celda sin busqueda
+    vector<double> x(30), y(20);
+    for (size_t i = 0; i < x.size(); i++){
+        x[i] = 0.25 * (double)i;
+    }
+    for (size_t j = 0; j < y.size(); j++){
+        y[j] = -2.0 + 0.2 * (double)j;
+    }
+    probar_malla(x, y, generador);
+
+    if (fallas > 0){
+        std::printf("%d verificaciones fallaron\n", fallas);
+        return 1;
+    }
+    std::printf("Todas las verificaciones pasaron\n");
+    return 0;
+}
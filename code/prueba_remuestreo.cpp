@@ -0,0 +1,160 @@
+/**
+ * @file
+ * @brief Prueba del remuestreo de series sobre una malla destino
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Compara, punto por punto, remuestreo::remuestrear con spline3::interpolar
+ * sobre una malla uniforme y sobre una malla dada con puntos repetidos,
+ * nodos y puntos fuera del rango, que deben dar NaN. Tambien compara los
+ * metodos lineal y newton con su formula directa. Termina con codigo 1 si
+ * alguna verificacion falla.
+ *
+ * Compilar, por ejemplo:
+ * g++ -std=c++20 -O2 -pthread prueba_remuestreo.cpp -o prueba_remuestreo
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "newton.h"
+#include "remuestreo.h"
+#include "spline3.h"
+
+using std::vector;
+
+namespace {
+    int fallas = 0; /*!< Verificaciones que no coincidieron */
+
+    /**
+     * @brief Compara un error con su tolerancia
+     * @param nombre Caso verificado
+     * @param error Error medido
+     * @param tolerancia Error maximo aceptado
+    */
+    void verificar(const char *nombre, double error, double tolerancia){
+        bool bien = error <= tolerancia;
+        std::printf("%-50s error %.3g, tolerancia %.3g %s\n", nombre, error, tolerancia, bien ? "ok" : "FALLA");
+        if (!bien){
+            fallas++;
+        }
+    }
+
+    /**
+     * @brief Mayor diferencia entre dos salidas; un NaN de un lado sin NaN del otro es error infinito
+     * @param a Salida calculada
+     * @param b Salida de referencia
+     * @return Error relativo a la escala de la referencia
+    */
+    double diferencia(const vector<double> &a, const vector<double> &b){
+        double error = 0.0;
+        for (size_t k = 0; k < b.size(); k++){
+            if (std::isnan(a[k]) || std::isnan(b[k])){
+                if (std::isnan(a[k]) != std::isnan(b[k])){
+                    return INFINITY;
+                }
+                continue;
+            }
+            error = std::max(error, std::fabs(a[k] - b[k]) / std::max(1.0, std::fabs(b[k])));
+        }
+        return error;
+    }
+}
+
+int main(){
+    std::mt19937_64 generador(46);
+    std::uniform_real_distribution<double> paso(0.1, 1.0);
+
+    // Serie de origen con nodos irregulares
+    const size_t n = 300;
+    vector<double> x(n), y(n);
+    double v = 0.0;
+    for (size_t i = 0; i < n; i++){
+        v += paso(generador);
+        x[i] = v;
+        y[i] = std::sin(0.1 * v) * v;
+    }
+    interpolacion::spline3 trazador(util::prestado, x, y);
+
+    // Malla uniforme que empieza y termina fuera del rango; grano pequeño para repartir en muchas tareas
+    const size_t m = 20000;
+    remuestreo::malla_uniforme malla{x.front() - 3.0, (x.back() - x.front() + 6.0) / (double)(m - 1)};
+    vector<double> salida(m), referencia(m);
+    remuestreo::remuestrear(x, y, malla, salida, remuestreo::metodo::spline3, 97);
+    size_t fuera = 0, nan_fuera = 0;
+    for (size_t k = 0; k < m; k++){
+        referencia[k] = trazador.interpolar(malla[k]);
+        if (malla[k] < x.front() || malla[k] > x.back()){
+            fuera++;
+            nan_fuera += std::isnan(salida[k]) ? 1 : 0;
+        }
+    }
+    verificar("malla uniforme: spline3 contra interpolar", diferencia(salida, referencia), 1e-12);
+    verificar("malla uniforme: NaN fuera del rango", (double)(fuera - nan_fuera), 0.0);
+
+    // Malla dada: nodos, puntos repetidos y extremos fuera del rango
+    vector<double> destino;
+    destino.push_back(x.front() - 1.0);
+    for (size_t i = 0; i < n; i++){
+        destino.push_back(x[i]);
+        if (i + 1 < n){
+            double medio = 0.5 * (x[i] + x[i + 1]);
+            destino.push_back(medio);
+            destino.push_back(medio);
+        }
+    }
+    destino.push_back(x.back() + 1.0);
+    vector<double> dada(destino.size()), dada_ref(destino.size());
+    remuestreo::remuestrear(x, y, span<const double>(destino), dada, remuestreo::metodo::spline3, 31);
+    for (size_t k = 0; k < destino.size(); k++){
+        dada_ref[k] = trazador.interpolar(destino[k]);
+    }
+    verificar("malla dada: spline3 contra interpolar", diferencia(dada, dada_ref), 1e-12);
+    verificar("malla dada: NaN en los extremos", std::isnan(dada.front()) && std::isnan(dada.back()) ? 0.0 : 1.0, 0.0);
+
+    // Lineal contra la recta entre cada par de datos
+    remuestreo::remuestrear(x, y, span<const double>(destino), dada, remuestreo::metodo::lineal, 31);
+    for (size_t k = 0; k < destino.size(); k++){
+        double t = destino[k];
+        if (t < x.front() || t > x.back()){
+            dada_ref[k] = NAN;
+            continue;
+        }
+        size_t i = std::max<size_t>(1, std::lower_bound(x.begin(), x.end(), t) - x.begin());
+        dada_ref[k] = y[i - 1] + (y[i] - y[i - 1]) * (t - x[i - 1]) / (x[i] - x[i - 1]);
+    }
+    verificar("malla dada: lineal contra la recta", diferencia(dada, dada_ref), 1e-12);
+
+    // Newton con pocos datos, contra basic_newton::interpolar
+    vector<double> xs(x.begin(), x.begin() + 12), ys(y.begin(), y.begin() + 12);
+    vector<double> corto{xs.front() - 1.0, xs.front(), 0.5 * (xs[3] + xs[4]), xs[7], xs.back(), xs.back() + 1.0};
+    vector<double> corto_sal(corto.size()), corto_ref(corto.size());
+    remuestreo::remuestrear(xs, ys, span<const double>(corto), corto_sal, remuestreo::metodo::newton);
+    interpolacion::newton polinomio(xs, ys);
+    for (size_t k = 0; k < corto.size(); k++){
+        corto_ref[k] = (corto[k] < xs.front() || corto[k] > xs.back()) ? NAN : polinomio.interpolar(corto[k]);
+    }
+    verificar("malla dada: newton contra interpolar", diferencia(corto_sal, corto_ref), 1e-9);
+
+    // Una malla sin ordenar se rechaza
+    bool rechazada = false;
+    try {
+        vector<double> desordenada{x[5], x[2]};
+        vector<double> sal(2);
+        remuestreo::remuestrear(x, y, span<const double>(desordenada), sal);
+    } catch (const std::invalid_argument &){
+        rechazada = true;
+    }
+    verificar("malla dada: desordenada se rechaza", rechazada ? 0.0 : 1.0, 0.0);
+
+    if (fallas > 0){
+        std::printf("%d verificaciones fallaron\n", fallas);
+        return 1;
+    }
+    std::printf("Todas las verificaciones pasaron\n");
+    return 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file
+ * @brief Prueba de la cota de error de la tabla uniforme
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Recorre densamente el rango de los datos, y alrededor de cada nodo, y
+ * verifica que la distancia entre la tabla y el trazador del que se compilo
+ * no pase de cota_error(), para tablas compiladas con varios errores
+ * maximos y para tablas con pocas celdas, donde la cota no es despreciable.
+ * Termina con codigo 1 si alguna verificacion falla.
+ *
+ * Compilar, por ejemplo:
+ * g++ -std=c++20 -O2 -pthread prueba_tabla_uniforme.cpp -o prueba_tabla_uniforme
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "spline3.h"
+#include "tabla_uniforme.h"
+
+using std::vector;
+
+namespace {
+    int fallas = 0; /*!< Verificaciones que no coincidieron */
+
+    /**
+     * @brief Compara un error con su tolerancia
+     * @param nombre Caso verificado
+     * @param error Error medido
+     * @param tolerancia Error maximo aceptado
+    */
+    void verificar(const char *nombre, double error, double tolerancia){
+        bool bien = error <= tolerancia;
+        std::printf("%-50s error %.3g, tolerancia %.3g %s\n", nombre, error, tolerancia, bien ? "ok" : "FALLA");
+        if (!bien){
+            fallas++;
+        }
+    }
+
+    /**
+     * @brief Mayor distancia entre la tabla y el trazador en los puntos dados
+     * @param t Tabla
+     * @param s Trazador del que se compilo la tabla
+     * @param puntos Puntos dentro del rango de los datos
+    */
+    double error_real(const interpolacion::tabla_uniforme &t, const interpolacion::spline3 &s, const vector<double> &puntos){
+        double error = 0.0;
+        for (double p : puntos){
+            error = std::max(error, std::fabs(t.interpolar(p) - s.interpolar(p)));
+        }
+        return error;
+    }
+}
+
+int main(){
+    std::mt19937_64 generador(47);
+    std::uniform_real_distribution<double> paso(0.1, 1.0);
+    std::uniform_real_distribution<double> ruido(-1.0, 1.0);
+
+    // Datos irregulares con ruido, para que la tercera derivada salte en cada nodo
+    const size_t n = 400;
+    vector<double> x(n), y(n);
+    double v = 0.0;
+    for (size_t i = 0; i < n; i++){
+        v += paso(generador);
+        x[i] = v;
+        y[i] = 10.0 * std::sin(0.3 * v) + ruido(generador);
+    }
+    interpolacion::spline3 s(util::prestado, x, y);
+
+    // Malla densa y puntos pegados a cada nodo
+    vector<double> puntos;
+    const size_t m = 400000;
+    for (size_t k = 0; k <= m; k++){
+        puntos.push_back(x.front() + (x.back() - x.front()) * (double)k / (double)m);
+    }
+    for (size_t i = 0; i < n; i++){
+        for (double d : {-1e-3, -1e-9, 0.0, 1e-9, 1e-3}){
+            double p = x[i] + d;
+            if (p >= x.front() && p <= x.back()){
+                puntos.push_back(p);
+            }
+        }
+    }
+    // Redondeo de evaluar dos cubicos con valores de y del orden de 10
+    const double redondeo = 1e-12;
+
+    char nombre[64];
+    for (double tolerancia : {1e-1, 1e-3, 1e-6, 1e-9}){
+        interpolacion::tabla_uniforme t = interpolacion::compilar(s, tolerancia);
+        std::snprintf(nombre, sizeof(nombre), "compilar %g: cota <= error pedido", tolerancia);
+        verificar(nombre, t.cota_error(), tolerancia);
+        std::snprintf(nombre, sizeof(nombre), "compilar %g: error real <= cota", tolerancia);
+        verificar(nombre, error_real(t, s, puntos), t.cota_error() + redondeo);
+    }
+
+    for (size_t celdas : {1, 7, 64, 1000}){
+        interpolacion::tabla_uniforme t(s, celdas);
+        double real = error_real(t, s, puntos);
+        std::snprintf(nombre, sizeof(nombre), "%zu celdas: error real <= cota", celdas);
+        verificar(nombre, real, t.cota_error() + redondeo);
+        std::snprintf(nombre, sizeof(nombre), "%zu celdas: cota sin construir", celdas);
+        verificar(nombre, std::fabs(interpolacion::tabla_uniforme::cota_error(s, celdas) - t.cota_error()), 0.0);
+    }
+
+    // En los extremos la tabla reproduce los datos y fuera del rango da NaN
+    interpolacion::tabla_uniforme t(s, 64);
+    verificar("extremos: valor en los nodos", std::max(std::fabs(t.interpolar(x.front()) - y.front()),
+                                                        std::fabs(t.interpolar(x.back()) - y.back())), redondeo);
+    verificar("fuera del rango: NaN", std::isnan(t.interpolar(x.front() - 1.0)) && std::isnan(t.interpolar(x.back() + 1.0)) ? 0.0 : 1.0, 0.0);
+
+    if (fallas > 0){
+        std::printf("%d verificaciones fallaron\n", fallas);
+        return 1;
+    }
+    std::printf("Todas las verificaciones pasaron\n");
+    return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file
+ * @brief Prueba de la validacion cruzada dejando uno fuera en forma cerrada
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Compara los residuos de validacion::lineal, cuadratica y spline3 con los
+ * de reajustar el modelo n veces, cada vez sin un dato, y predecir el dato
+ * que quedo fuera. Para el trazador, los extremos se predicen extendiendo
+ * linealmente el trazador sin el dato. Termina con codigo 1 si alguna
+ * verificacion falla.
+ *
+ * Compilar, por ejemplo:
+ * g++ -std=c++20 -O2 -pthread prueba_validacion.cpp -o prueba_validacion
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "regresion.h"
+#include "spline3.h"
+#include "validacion.h"
+
+using std::vector;
+
+namespace {
+    int fallas = 0; /*!< Verificaciones que no coincidieron */
+
+    /**
+     * @brief Compara un error con su tolerancia
+     * @param nombre Caso verificado
+     * @param error Error medido
+     * @param tolerancia Error maximo aceptado
+    */
+    void verificar(const char *nombre, double error, double tolerancia){
+        bool bien = error <= tolerancia;
+        std::printf("%-50s error %.3g, tolerancia %.3g %s\n", nombre, error, tolerancia, bien ? "ok" : "FALLA");
+        if (!bien){
+            fallas++;
+        }
+    }
+
+    /**
+     * @brief Mayor diferencia entre los residuos en forma cerrada y los de fuerza bruta
+     * @param res Resultado de la validacion en forma cerrada
+     * @param bruta Residuos de reajustar sin cada dato
+     * @return Error relativo a la escala de los residuos
+    */
+    double diferencia(const validacion::resultado_loocv &res, const vector<double> &bruta){
+        if (res.residuos.size() != bruta.size()){
+            return INFINITY;
+        }
+        double escala = 1.0, error = 0.0, press = 0.0;
+        for (size_t i = 0; i < bruta.size(); i++){
+            escala = std::max(escala, std::fabs(bruta[i]));
+            error = std::max(error, std::fabs(res.residuos[i] - bruta[i]));
+            press += bruta[i] * bruta[i];
+        }
+        return std::max(error / escala, std::fabs(res.press - press) / std::max(press, 1.0));
+    }
+
+    /** @brief Copia de x e y sin el dato i */
+    void sin_dato(const vector<double> &x, const vector<double> &y, size_t i, vector<double> &xs, vector<double> &ys){
+        xs.clear();
+        ys.clear();
+        for (size_t k = 0; k < x.size(); k++){
+            if (k != i){
+                xs.push_back(x[k]);
+                ys.push_back(y[k]);
+            }
+        }
+    }
+}
+
+int main(){
+    std::mt19937_64 generador(29);
+    std::uniform_real_distribution<double> paso(0.2, 1.5);
+    std::normal_distribution<double> ruido(0.0, 0.3);
+
+    // Nodos irregulares y datos con ruido
+    const size_t n = 40;
+    vector<double> x(n), y(n);
+    double xi = 0.0;
+    for (size_t i = 0; i < n; i++){
+        xi += paso(generador);
+        x[i] = xi;
+        y[i] = std::sin(0.3 * xi) * 4.0 + 0.1 * xi * xi + ruido(generador);
+    }
+
+    vector<double> xs, ys;
+    vector<double> bruta_lineal(n), bruta_cuadratica(n), bruta_spline(n);
+    for (size_t i = 0; i < n; i++){
+        sin_dato(x, y, i, xs, ys);
+
+        regresion::solucion_lineal l = regresion::lineal_simple(util::prestado, xs, ys).calcular();
+        bruta_lineal[i] = y[i] - (l.b0 + l.b1 * x[i]);
+
+        regresion::solucion_cuadratica q = regresion::cuadratica(util::prestado, xs, ys).calcular();
+        bruta_cuadratica[i] = y[i] - (q.a0 + q.a1 * x[i] + q.a2 * x[i] * x[i]);
+
+        // El trazador natural sin el dato se extiende linealmente fuera de su rango
+        interpolacion::spline3 s(util::prestado, xs, ys);
+        double prediccion;
+        if (i == 0){
+            vector<double> c = s.coeficientes();
+            prediccion = c[0] + c[1] * (x[0] - xs[0]);
+        } else if (i == n - 1){
+            vector<double> c = s.coeficientes();
+            const double *u = c.data() + c.size() - 4;
+            double h = xs[n - 2] - xs[n - 3];
+            double pendiente = u[1] + 2.0 * u[2] * h + 3.0 * u[3] * h * h;
+            prediccion = ys[n - 2] + pendiente * (x[n - 1] - xs[n - 2]);
+        } else {
+            prediccion = s.interpolar(x[i]);
+        }
+        bruta_spline[i] = y[i] - prediccion;
+    }
+
+    verificar("lineal: forma cerrada contra fuerza bruta", diferencia(validacion::lineal(x, y), bruta_lineal), 1e-9);
+    verificar("cuadratica: forma cerrada contra fuerza bruta", diferencia(validacion::cuadratica(x, y), bruta_cuadratica), 1e-9);
+    verificar("spline3: forma cerrada contra fuerza bruta", diferencia(validacion::spline3(x, y), bruta_spline), 1e-9);
+
+    // Los mismos datos trasladados lejos del cero dan los mismos residuos
+    vector<double> xt(n), yt(n);
+    for (size_t i = 0; i < n; i++){
+        xt[i] = x[i] + 1e5;
+        yt[i] = y[i] + 1e5;
+    }
+    verificar("lineal: datos trasladados", diferencia(validacion::lineal(xt, yt), bruta_lineal), 1e-7);
+    verificar("cuadratica: datos trasladados", diferencia(validacion::cuadratica(xt, yt), bruta_cuadratica), 1e-6);
+
+    if (fallas > 0){
+        std::printf("%d verificaciones fallaron\n", fallas);
+        return 1;
+    }
+    std::printf("Todas las verificaciones pasaron\n");
+    return 0;
+}
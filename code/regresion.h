@@ -7,8 +7,16 @@
 #include <vector>
 #include <iomanip>
 #include <cmath>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
 
 #include "util.h"
+#include "arena.h"
+#include "datos.h"
+#include "instrumentacion.h"
+#include "sistemas.h"
+#include "vectorial.h"
 
 using std::string;
 using std::vector;
@@ -20,30 +28,12 @@ using std::setprecision;
 using std::left;
 using std::right;
 using std::to_string;
+using std::span;
 
 using util::gauss;
 
 namespace regresion{
 
-    /**
-     * @brief Repite una cadena de caracteres
-     * @param s Cadena a repetir
-     * @param n Cantidad de repeteciones
-     * @return Concatenacion de s n veces
-    */
-    string str_repeat(string s, int n){
-        string ret = "";
-        for(int i = 0; i < n; i++){
-            ret += s;
-        }
-        return ret;
-    }
-
-    int getCenteredWidth(size_t label_length, int value) {
-        size_t value_length = to_string(value).length();
-        return (label_length - value_length) / 2 + value_length;
-    }
-
     /**
      * @brief Solucion mediante Regresion Lineal Simple
     */
@@ -66,7 +56,7 @@ namespace regresion{
 
              cout << "Recta de regresion: \n"
                  << "\ny = " << b1 << " * x "
-                 << ((b0 >= 0.0f)? " + " : " - ")
+                 << ((b0 >= 0.0)? " + " : " - ")
                  << fabs(b0)
                  << "\n"
                  << endl   
@@ -83,6 +73,41 @@ namespace regresion{
                  << r2
                  << endl;
          }
+
+        /**
+         * @brief Evalua la recta de regresion sobre un lote de valores
+         * @param x Valores de x
+         * @param y Salida con los valores estimados, puede ser el mismo arreglo que x
+         */
+        void predecir(span<const double> x, span<double> y) const {
+            MEDIR("lineal_simple::predecir");
+            const double coef[] = {b0, b1};
+            vectorial::horner(coef, x, y);
+        }
+
+        /**
+         * @brief Calcula los residuos y - y estimado sobre un lote
+         * @param x Valores de x
+         * @param y Valores medidos de y
+         * @param r Salida con los residuos, puede ser el mismo arreglo que x
+         */
+        void residuos(span<const double> x, span<const double> y, span<double> r) const {
+            predecir(x, r);
+            vectorial::restar_de(y, r);
+        }
+
+        /** @brief Evalua la recta de regresion sobre un lote en float; los coeficientes siguen en double */
+        void predecir(span<const float> x, span<float> y) const {
+            MEDIR("lineal_simple::predecir");
+            const double coef[] = {b0, b1};
+            vectorial::horner(coef, x, y);
+        }
+
+        /** @brief Calcula los residuos y - y estimado sobre un lote en float */
+        void residuos(span<const float> x, span<const float> y, span<float> r) const {
+            predecir(x, r);
+            vectorial::restar_de(y, r);
+        }
     };
 
     /**
@@ -90,8 +115,8 @@ namespace regresion{
     */
     struct solucion_potencia
     {
-        double c = 0.0f;        /*!<Coeficiente de la potencia*/
-        double a = 0.0f;        /*!<Factor del exponente de la potencia*/
+        double c = 0.0;        /*!<Coeficiente de la potencia*/
+        double a = 0.0;        /*!<Factor del exponente de la potencia*/
         solucion_lineal lineal; /*!<Regresion de los datos linealizados*/
         /**
          * @brief Impresion de la regresion potencia
@@ -114,6 +139,39 @@ namespace regresion{
                  << lineal.r2 
                  << endl;
         }
+
+        /**
+         * @brief Evalua la funcion potencia c * x^a (x > 0) sobre un lote de valores
+         * @param x Valores de x
+         * @param y Salida con los valores estimados, puede ser el mismo arreglo que x
+         */
+        void predecir(span<const double> x, span<double> y) const {
+            MEDIR("potencia::predecir");
+            vectorial::potencia(c, a, x, y);
+        }
+
+        /**
+         * @brief Calcula los residuos y - y estimado sobre un lote
+         * @param x Valores de x
+         * @param y Valores medidos de y
+         * @param r Salida con los residuos, puede ser el mismo arreglo que x
+         */
+        void residuos(span<const double> x, span<const double> y, span<double> r) const {
+            predecir(x, r);
+            vectorial::restar_de(y, r);
+        }
+
+        /** @brief Evalua la funcion potencia sobre un lote en float; los coeficientes siguen en double */
+        void predecir(span<const float> x, span<float> y) const {
+            MEDIR("potencia::predecir");
+            vectorial::potencia(c, a, x, y);
+        }
+
+        /** @brief Calcula los residuos y - y estimado sobre un lote en float */
+        void residuos(span<const float> x, span<const float> y, span<float> r) const {
+            predecir(x, r);
+            vectorial::restar_de(y, r);
+        }
     };
 
     /**
@@ -121,8 +179,8 @@ namespace regresion{
     */
     struct solucion_exponencial
     {
-        double c = 0.0f;        /*!<Coeficiente de la potencia*/
-        double a = 0.0f;        /*!<Factor del exponente de la potencia*/
+        double c = 0.0;        /*!<Coeficiente de la potencia*/
+        double a = 0.0;        /*!<Factor del exponente de la potencia*/
         solucion_lineal lineal; /*!<Regresion de los datos linealizados*/
         /**
          * @brief Impresion de la regresion potencia
@@ -145,6 +203,39 @@ namespace regresion{
                  << lineal.r2 
                  << endl;
         }
+
+        /**
+         * @brief Evalua la funcion exponencial c * e^(a * x) sobre un lote de valores
+         * @param x Valores de x
+         * @param y Salida con los valores estimados, puede ser el mismo arreglo que x
+         */
+        void predecir(span<const double> x, span<double> y) const {
+            MEDIR("exponencial::predecir");
+            vectorial::exp_lineal(lineal.b0, a, 1.0, x, y);
+        }
+
+        /**
+         * @brief Calcula los residuos y - y estimado sobre un lote
+         * @param x Valores de x
+         * @param y Valores medidos de y
+         * @param r Salida con los residuos, puede ser el mismo arreglo que x
+         */
+        void residuos(span<const double> x, span<const double> y, span<double> r) const {
+            predecir(x, r);
+            vectorial::restar_de(y, r);
+        }
+
+        /** @brief Evalua la funcion exponencial sobre un lote en float; los coeficientes siguen en double */
+        void predecir(span<const float> x, span<float> y) const {
+            MEDIR("exponencial::predecir");
+            vectorial::exp_lineal(lineal.b0, a, 1.0, x, y);
+        }
+
+        /** @brief Calcula los residuos y - y estimado sobre un lote en float */
+        void residuos(span<const float> x, span<const float> y, span<float> r) const {
+            predecir(x, r);
+            vectorial::restar_de(y, r);
+        }
     };
 
     /**
@@ -152,14 +243,14 @@ namespace regresion{
     */
     struct solucion_cuadratica{
 
-        double a0 = 0.0f; /*!< Termino independiente del polinomio cuadratico */
-        double a1 = 0.0f; /*!< Coeficiente de x del polinomio cuadratico */
-        double a2 = 0.0f; /*!< Coeficiente de x^2 del polinomio cuadratico */
-        double st = 0.0f; /*!< Sumatoria de la diferencia cuadratica entre el valor medido y el promedio */
-        double sr = 0.0f; /*!< Sumatoria de la diferencia cuadratica entre cada y con el y estimado */
-        double sy = 0.0f; /*!< Desviacion estandar */
-        double syx = 0.0f; /*!< Error estandar de aproximacion */
-        double r2 = 0.0f; /*!< Coeficiente de determinacion */
+        double a0 = 0.0; /*!< Termino independiente del polinomio cuadratico */
+        double a1 = 0.0; /*!< Coeficiente de x del polinomio cuadratico */
+        double a2 = 0.0; /*!< Coeficiente de x^2 del polinomio cuadratico */
+        double st = 0.0; /*!< Sumatoria de la diferencia cuadratica entre el valor medido y el promedio */
+        double sr = 0.0; /*!< Sumatoria de la diferencia cuadratica entre cada y con el y estimado */
+        double sy = 0.0; /*!< Desviacion estandar */
+        double syx = 0.0; /*!< Error estandar de aproximacion */
+        double r2 = 0.0; /*!< Coeficiente de determinacion */
         size_t n; /*!< Numero de datos */
 
         /**
@@ -171,9 +262,9 @@ namespace regresion{
             
             cout << "Polinomio de regresion: \n"
             << "y = " << a2 << " * x^2 "
-            << ((a1 >= 0.0f)? " + " : " - ")
+            << ((a1 >= 0.0)? " + " : " - ")
             << fabs(a1) << "x"
-            << ((a0 >= 0.0f)? " + " : " - ")
+            << ((a0 >= 0.0)? " + " : " - ")
             << fabs(a0)
             << "\n"
             << endl
@@ -189,54 +280,253 @@ namespace regresion{
             << r2
             << endl;
         }
+
+        /**
+         * @brief Evalua el polinomio de regresion sobre un lote de valores
+         * @param x Valores de x
+         * @param y Salida con los valores estimados, puede ser el mismo arreglo que x
+         */
+        void predecir(span<const double> x, span<double> y) const {
+            MEDIR("cuadratica::predecir");
+            const double coef[] = {a0, a1, a2};
+            vectorial::horner(coef, x, y);
+        }
+
+        /**
+         * @brief Calcula los residuos y - y estimado sobre un lote
+         * @param x Valores de x
+         * @param y Valores medidos de y
+         * @param r Salida con los residuos, puede ser el mismo arreglo que x
+         */
+        void residuos(span<const double> x, span<const double> y, span<double> r) const {
+            predecir(x, r);
+            vectorial::restar_de(y, r);
+        }
+
+        /** @brief Evalua el polinomio de regresion sobre un lote en float; los coeficientes siguen en double */
+        void predecir(span<const float> x, span<float> y) const {
+            MEDIR("cuadratica::predecir");
+            const double coef[] = {a0, a1, a2};
+            vectorial::horner(coef, x, y);
+        }
+
+        /** @brief Calcula los residuos y - y estimado sobre un lote en float */
+        void residuos(span<const float> x, span<const float> y, span<float> r) const {
+            predecir(x, r);
+            vectorial::restar_de(y, r);
+        }
     };
 
+    using util::imprimir_tabla;
+
     /**
-     * Imprime una tabla de datos
-     * @param X  variable independiente
-     * @param y variable dependiente
-     * @param x_label Etiqueta de la variable independiente
-     * @param y_label Etiqueta de la variable dependiente
-     */
-    void imprimir_tabla(vector<double> x, vector<double> y, string x_label = "", string y_label = "") {
+     * @brief Sumas necesarias para las regresiones lineal y cuadratica
+     *
+     * Permite ajustar un modelo en una sola pasada sobre los datos y combinar
+     * sumas parciales calculadas por separado (por bloques, hilos o grupos).
+     *
+     * Las sumas son de u = x - origen_x y v = y - origen_y, con el origen en
+     * el primer dato agregado, como en multiple.h: con datos lejos del cero
+     * (x ~ 1e6) las sumas de potencias crudas se cancelan al centrarlas.
+     * sr se obtiene de las sumas centradas.
+    */
+    struct acumulador{
+        double n = 0.0; /*!< Numero de datos */
+        double sum_x = 0.0; /*!< Sumatoria de u */
+        double sum_x2 = 0.0; /*!< Sumatoria de u^2 */
+        double sum_x3 = 0.0; /*!< Sumatoria de u^3 */
+        double sum_x4 = 0.0; /*!< Sumatoria de u^4 */
+        double sum_y = 0.0; /*!< Sumatoria de v */
+        double sum_y2 = 0.0; /*!< Sumatoria de v^2 */
+        double sum_xy = 0.0; /*!< Sumatoria de u * v */
+        double sum_x2y = 0.0; /*!< Sumatoria de u^2 * v */
+        double origen_x = 0.0; /*!< x del primer dato agregado */
+        double origen_y = 0.0; /*!< y del primer dato agregado */
 
-        if (x_label.empty()) {
-            x_label = "X";
+        /**
+         * @brief Agrega un dato a las sumas
+         * @param x Variable independiente
+         * @param y Variable dependiente
+         */
+        void agregar(double x, double y){
+            if (n == 0.0){
+                origen_x = x;
+                origen_y = y;
+            }
+            x -= origen_x;
+            y -= origen_y;
+            double x2 = x * x;
+            n += 1.0;
+            sum_x += x;
+            sum_x2 += x2;
+            sum_x3 += x2 * x;
+            sum_x4 += x2 * x2;
+            sum_y += y;
+            sum_y2 += y * y;
+            sum_xy += x * y;
+            sum_x2y += x2 * y;
         }
 
-        if (y_label.empty()) {
-            y_label = "Y";
+        /**
+         * @brief Suma las sumas de otro acumulador, trasladadas al origen de este
+         * @param otro Acumulador a combinar
+         */
+        void combinar(const acumulador &otro){
+            if (otro.n == 0.0){
+                return;
+            }
+            if (n == 0.0){
+                *this = otro;
+                return;
+            }
+
+            // Con u = u_otro + dx y v = v_otro + dy, desarrollando cada potencia
+            const double dx = otro.origen_x - origen_x, dy = otro.origen_y - origen_y;
+            const double dx2 = dx * dx;
+            const double m = otro.n;
+            n += m;
+            sum_x += otro.sum_x + m * dx;
+            sum_x2 += otro.sum_x2 + 2.0 * dx * otro.sum_x + m * dx2;
+            sum_x3 += otro.sum_x3 + 3.0 * dx * otro.sum_x2 + 3.0 * dx2 * otro.sum_x + m * dx2 * dx;
+            sum_x4 += otro.sum_x4 + 4.0 * dx * otro.sum_x3 + 6.0 * dx2 * otro.sum_x2 + 4.0 * dx2 * dx * otro.sum_x + m * dx2 * dx2;
+            sum_y += otro.sum_y + m * dy;
+            sum_y2 += otro.sum_y2 + 2.0 * dy * otro.sum_y + m * dy * dy;
+            sum_xy += otro.sum_xy + dy * otro.sum_x + dx * otro.sum_y + m * dx * dy;
+            sum_x2y += otro.sum_x2y + dy * otro.sum_x2 + 2.0 * dx * otro.sum_xy + 2.0 * dx * dy * otro.sum_x
+                     + dx2 * otro.sum_y + m * dx2 * dy;
         }
 
-        size_t x_width = x_label.length() + 4;
-        size_t y_width = y_label.length() + 4;
+        /**
+         * @brief Calcula la recta de regresion a partir de las sumas
+         * @return Recta de regresion lineal
+         */
+        solucion_lineal lineal() const {
+            solucion_lineal sol;
+            sol.n = (size_t)n;
 
-        cout << "\n";
-        cout << str_repeat("=", x_width + y_width + 2) << endl;
+            double u_prom = (n > 0) ? sum_x / n : NAN;
+            double v_prom = (n > 0) ? sum_y / n : NAN;
 
-        cout << "  " << setw(x_width) << left << x_label << setw(y_width/4) << right << y_label << endl;
+            // Sumas centradas en los promedios
+            double sxx = sum_x2 - (u_prom * sum_x);
+            double sxy = sum_xy - (u_prom * sum_y);
+            double syy = sum_y2 - (v_prom * sum_y);
 
-        cout << str_repeat("=", x_width + y_width + 2) << endl;
+            sol.b1 = sxy / sxx;
+            sol.b0 = (origen_y + v_prom) - (sol.b1 * (origen_x + u_prom));
 
-        for (size_t i = 0; i < x.size(); i++) {
-            int x_space = getCenteredWidth(x_width, x[i]);
-            int y_space = getCenteredWidth(y_width, y[i]);
+            sol.st = syy;
+            sol.sr = syy - (sol.b1 * sxy);
+            sol.sr = (sol.sr < 0.0) ? 0.0 : sol.sr;
 
-            cout << setw(x_space) << right << x[i] << setw(x_width - x_space + y_space) << right << y[i] << endl;
+            sol.sy = (sol.n > 1) ? sqrt(sol.st / (double)(sol.n - 1)) : NAN;
+            sol.syx = (sol.n > 2) ? sqrt(sol.sr / (double)(sol.n - 2)) : NAN;
+            sol.r2 = (sol.st - sol.sr) / sol.st;
+            return sol;
         }
-        cout << str_repeat("=", x_width + y_width + 2) << endl;
-        cout << "\n";
 
+        /**
+         * @brief Calcula el polinomio de regresion de grado 2 a partir de las sumas
+         * @return Polinomio de solucion; con 3 datos o menos los coeficientes quedan en 0
+         */
+        solucion_cuadratica cuadratica() const {
+            solucion_cuadratica sol;
+            sol.n = (size_t)n;
+
+            // La regresion cuadratica se calcula con al menos 4 puntos
+            if (sol.n <= 3){
+                return sol;
+            }
+
+            double a[9], b[3];
+            llenar_cuadratica(a, b, 1, 0);
+            util::resolver_lote(3, 1, a, b);
+            completar(sol, b[0], b[1], b[2]);
+            return sol;
         }
 
-    class lineal_simple{
+        /**
+         * @brief Escribe las ecuaciones normales de la regresion cuadratica en u y v en un lote de sistemas intercalados
+         * @param a Matrices intercaladas de 3 x 3 (ver util::resolver_lote)
+         * @param b Lados derechos intercalados
+         * @param n_sistemas Cantidad de sistemas del lote
+         * @param s Posicion del sistema dentro del lote
+         */
+        void llenar_cuadratica(double *a, double *b, size_t n_sistemas, size_t s) const {
+            const double m[3][4] = {
+                {n, sum_x, sum_x2, sum_y},
+                {sum_x, sum_x2, sum_x3, sum_xy},
+                {sum_x2, sum_x3, sum_x4, sum_x2y}
+            };
+            for (size_t i = 0; i < 3; i++){
+                for (size_t j = 0; j < 3; j++){
+                    a[(i * 3 + j) * n_sistemas + s] = m[i][j];
+                }
+                b[i * n_sistemas + s] = m[i][3];
+            }
+        }
+
+        /**
+         * @brief Calcula las estadisticas de un polinomio cuadratico ya resuelto
+         * @param sol Solucion a completar, con los coeficientes en x
+         * @param a0 Termino independiente en u (solucion de llenar_cuadratica)
+         * @param a1 Coeficiente de u
+         * @param a2 Coeficiente de u^2
+         */
+        void completar(solucion_cuadratica &sol, double a0, double a1, double a2) const {
+            sol.n = (size_t)n;
+            // v = a0 + a1 u + a2 u^2 con u = x - origen_x, v = y - origen_y
+            sol.a0 = origen_y + a0 - (a1 * origen_x) + (a2 * origen_x * origen_x);
+            sol.a1 = a1 - (2.0 * a2 * origen_x);
+            sol.a2 = a2;
+
+            // Con el residuo ortogonal a 1, u y u^2: sr = st - a1 Suv - a2 Su2v, con sumas centradas
+            double v_prom = sum_y / n;
+            sol.st = sum_y2 - (v_prom * sum_y);
+            sol.sr = sol.st - (a1 * (sum_xy - (v_prom * sum_x))) - (a2 * (sum_x2y - (v_prom * sum_x2)));
+            sol.sr = (sol.sr < 0.0) ? 0.0 : sol.sr;
+
+            sol.sy = sqrt(sol.st / (double)(sol.n - 1));
+            sol.syx = sqrt(sol.sr / (double)(sol.n - 3));
+            sol.r2 = (sol.st - sol.sr) / sol.st;
+        }
+    };
+
+    /**
+     * @brief Regresion lineal simple
+     *
+     * Las sumas se acumulan en double aunque los datos sean float.
+     *
+     * @tparam T double o float
+    */
+    template <typename T>
+    class basic_lineal_simple{
     public:
         /**
          * @brief Crea una instancia de la solucion lineal simple
          * @param p_x Variable independiente
          * @param p_y Variable dependiente
-         */
-        lineal_simple(vector<double> p_x, vector<double> p_y):x(p_x), y(p_y){
+         * @note Copia x e y (una asignacion de memoria por arreglo)
+        */
+        basic_lineal_simple(span<const T> p_x, span<const T> p_y):x(p_x), y(p_y){
+        }
+
+        /**
+         * @brief Crea una instancia de la solucion lineal simple, moviendo los vectores sin copiarlos
+         * @param p_x Variable independiente
+         * @param p_y Variable dependiente
+         * @note No asigna memoria para x e y
+        */
+        basic_lineal_simple(vector<T> &&p_x, vector<T> &&p_y):x(std::move(p_x)), y(std::move(p_y)){
+        }
+
+        /**
+         * @brief Crea una instancia de la solucion lineal simple, tomando prestados los datos
+         * @param p_x Variable independiente; debe existir mientras exista la instancia
+         * @param p_y Variable dependiente; debe existir mientras exista la instancia
+         * @note No copia x ni y ni asigna memoria para ellos
+        */
+        basic_lineal_simple(util::prestado_t, span<const T> p_x, span<const T> p_y):x(util::prestado, p_x), y(util::prestado, p_y){
         }
 
         /**
@@ -244,27 +534,29 @@ namespace regresion{
          * @return  Recta de regresion lineal
          */
         solucion_lineal calcular(){
+            MEDIR("lineal_simple::calcular");
             solucion_lineal sol;
 
-            double sum_xy = 0.0f, sum_x = 0.0f, sum_x2 = 0.0f, sum_y = 0.0f,
+            double sum_xy = 0.0, sum_x = 0.0, sum_x2 = 0.0, sum_y = 0.0,
                 x_prom , y_prom;
 
             sol.n = x.size();
 
             for(size_t i = 0; i < sol.n; i++){
-                sum_xy += x[i] * y[i];
-                sum_x += x[i];
-                sum_y += y[i];
-                sum_x2 += x[i] * x[i];
+                double xi = x[i], yi = y[i];
+                sum_xy += xi * yi;
+                sum_x += xi;
+                sum_y += yi;
+                sum_x2 += xi * xi;
             }
 
             if(sol.n > 0){
                 x_prom = sum_x / sol.n;
                 y_prom = sum_y / sol.n;
 
-                sol.st = 0.0f;
+                sol.st = 0.0;
                 for(size_t i = 0; i < sol.n; i++){
-                    sol.st += pow(y[i] - y_prom, 2.0f);
+                    sol.st += pow((double)y[i] - y_prom, 2.0);
                 }
 
                 if (sol.n > 1){
@@ -279,9 +571,9 @@ namespace regresion{
             sol.b1 = (sum_xy - (y_prom * sum_x)) / (sum_x2 - (x_prom * sum_x));
             sol.b0 = y_prom - (sol.b1 * x_prom);
 
-            sol.sr = 0.0f;
+            sol.sr = 0.0;
             for(size_t i = 0; i < sol.n; i++){
-                sol.sr += pow(y[i] - ((sol.b1 * x[i]) + sol.b0), 2.0f);
+                sol.sr += pow((double)y[i] - ((sol.b1 * x[i]) + sol.b0), 2.0);
             }
 
             if(sol.n > 2){
@@ -293,23 +585,44 @@ namespace regresion{
         }
 
     private:
-        vector<double> x; /*!< Variable independiente */
-        vector<double> y; /*!< Variable dependiente */
+        util::basic_datos<T> x; /*!< Variable independiente */
+        util::basic_datos<T> y; /*!< Variable dependiente */
     };
 
 
     /**
      * @brief Regresion linealizada mediante la funcion potencia
+     * @tparam T double o float
     */
-    class potencia{
+    template <typename T>
+    class basic_potencia{
     
     public:
         /**
          * @brief Crea una instancia de la solucion potencia
          * @param p_x Variable independiente
          * @param p_y Variable dependiente
-         */
-        potencia(vector<double> p_x, vector<double> p_y):x(p_x), y(p_y){
+         * @note Copia x e y (una asignacion de memoria por arreglo)
+        */
+        basic_potencia(span<const T> p_x, span<const T> p_y):x(p_x), y(p_y){
+        }
+
+        /**
+         * @brief Crea una instancia de la solucion potencia, moviendo los vectores sin copiarlos
+         * @param p_x Variable independiente
+         * @param p_y Variable dependiente
+         * @note No asigna memoria para x e y
+        */
+        basic_potencia(vector<T> &&p_x, vector<T> &&p_y):x(std::move(p_x)), y(std::move(p_y)){
+        }
+
+        /**
+         * @brief Crea una instancia de la solucion potencia, tomando prestados los datos
+         * @param p_x Variable independiente; debe existir mientras exista la instancia
+         * @param p_y Variable dependiente; debe existir mientras exista la instancia
+         * @note No copia x ni y ni asigna memoria para ellos
+        */
+        basic_potencia(util::prestado_t, span<const T> p_x, span<const T> p_y):x(util::prestado, p_x), y(util::prestado, p_y){
         }
 
         /**
@@ -317,19 +630,21 @@ namespace regresion{
          * @return Solucion linealizada
         */
         solucion_potencia calcular(){
+            MEDIR("potencia::calcular");
 
             solucion_potencia sol;
 
-            vector<double> X(x);
-            vector<double> Y(y);
+            // Los datos transformados son temporales del hilo
+            std::pmr::vector<double> X(x.begin(), x.end(), util::temporales());
+            std::pmr::vector<double> Y(y.begin(), y.end(), util::temporales());
 
             for(unsigned int i = 0; i < X.size(); i++){
                 X[i] = log10(X[i]);
                 Y[i] = log10(Y[i]);
             }
 
-            // Crear un modelo de regresion lineal con los datos transformados
-            lineal_simple ls(X, Y);
+            // Crear un modelo de regresion lineal con los datos transformados, sin volver a copiarlos
+            basic_lineal_simple<double> ls(util::prestado, X, Y);
 
             // Calcular la regresion lineal con los datos transformados
             sol.lineal = ls.calcular();
@@ -338,29 +653,50 @@ namespace regresion{
             sol.a = sol.lineal.b1;
 
             // Calcular C
-            sol.c = pow(10.0f, sol.lineal.b0);
+            sol.c = pow(10.0, sol.lineal.b0);
 
             return sol;
 
         }
 
     private:
-        vector<double> x; /*!< Variable independiente */
-        vector<double> y; /*!< Variable dependiente */   
+        util::basic_datos<T> x; /*!< Variable independiente */
+        util::basic_datos<T> y; /*!< Variable dependiente */   
     };
 
     /**
      * @brief Regresion linealizada mediante la funcion potencia
+     * @tparam T double o float
     */
-    class exponencial{
+    template <typename T>
+    class basic_exponencial{
     
     public:
         /**
          * @brief Crea una instancia de la solucion exponencial
          * @param p_x Variable independiente
          * @param p_y Variable dependiente
-         */
-        exponencial(vector<double> p_x, vector<double> p_y):x(p_x), y(p_y){
+         * @note Copia x e y (una asignacion de memoria por arreglo)
+        */
+        basic_exponencial(span<const T> p_x, span<const T> p_y):x(p_x), y(p_y){
+        }
+
+        /**
+         * @brief Crea una instancia de la solucion exponencial, moviendo los vectores sin copiarlos
+         * @param p_x Variable independiente
+         * @param p_y Variable dependiente
+         * @note No asigna memoria para x e y
+        */
+        basic_exponencial(vector<T> &&p_x, vector<T> &&p_y):x(std::move(p_x)), y(std::move(p_y)){
+        }
+
+        /**
+         * @brief Crea una instancia de la solucion exponencial, tomando prestados los datos
+         * @param p_x Variable independiente; debe existir mientras exista la instancia
+         * @param p_y Variable dependiente; debe existir mientras exista la instancia
+         * @note No copia x ni y ni asigna memoria para ellos
+        */
+        basic_exponencial(util::prestado_t, span<const T> p_x, span<const T> p_y):x(util::prestado, p_x), y(util::prestado, p_y){
         }
 
         /**
@@ -368,21 +704,27 @@ namespace regresion{
          * @return Solucion linealizada
         */
         solucion_exponencial calcular(){
+            MEDIR("exponencial::calcular");
 
             solucion_exponencial sol;
 
-            vector<double> X(x);
-            vector<double> Y(y);
+            // Los datos transformados son temporales del hilo
+            std::pmr::vector<double> Y(y.begin(), y.end(), util::temporales());
 
             for(unsigned int i = 0; i < Y.size(); i++){
                 Y[i] = log(Y[i]);
             }
 
-            // Crear un modelo de regresion lineal con los datos transformados
-            lineal_simple ls(x, Y);
-
-            // Calcular la regresion lineal con los datos transformados
-            sol.lineal = ls.calcular();
+            // Crear un modelo de regresion lineal con los datos transformados; x no cambia y se presta
+            // si ya esta en double
+            if constexpr (std::is_same_v<T, double>){
+                basic_lineal_simple<double> ls(util::prestado, x, Y);
+                sol.lineal = ls.calcular();
+            } else {
+                std::pmr::vector<double> X(x.begin(), x.end(), util::temporales());
+                basic_lineal_simple<double> ls(util::prestado, X, Y);
+                sol.lineal = ls.calcular();
+            }
 
             // Calcular A
             sol.a = sol.lineal.b1;
@@ -395,14 +737,16 @@ namespace regresion{
         }
 
     private:
-        vector<double> x; /*!< Variable independiente */
-        vector<double> y; /*!< Variable dependiente */   
+        util::basic_datos<T> x; /*!< Variable independiente */
+        util::basic_datos<T> y; /*!< Variable dependiente */   
     };
 
     /**
      * @brief Regresion cuadratica
+     * @tparam T double o float
     */
-    class cuadratica{
+    template <typename T>
+    class basic_cuadratica{
 
         public:
 
@@ -410,15 +754,36 @@ namespace regresion{
              * @brief Crea una instancia de la solucion cuadratica
              * @param p_x Variable independiente
              * @param p_y Variable dependiente
-             */
-            cuadratica(vector<double> p_x, vector<double> p_y):x(p_x), y(p_y){
-            };
+             * @note Copia x e y (una asignacion de memoria por arreglo)
+            */
+            basic_cuadratica(span<const T> p_x, span<const T> p_y):x(p_x), y(p_y){
+            }
+
+            /**
+             * @brief Crea una instancia de la solucion cuadratica, moviendo los vectores sin copiarlos
+             * @param p_x Variable independiente
+             * @param p_y Variable dependiente
+             * @note No asigna memoria para x e y
+            */
+            basic_cuadratica(vector<T> &&p_x, vector<T> &&p_y):x(std::move(p_x)), y(std::move(p_y)){
+            }
+
+            /**
+             * @brief Crea una instancia de la solucion cuadratica, tomando prestados los datos
+             * @param p_x Variable independiente; debe existir mientras exista la instancia
+             * @param p_y Variable dependiente; debe existir mientras exista la instancia
+             * @note No copia x ni y ni asigna memoria para ellos
+            */
+            basic_cuadratica(util::prestado_t, span<const T> p_x, span<const T> p_y):x(util::prestado, p_x), y(util::prestado, p_y){
+            }
+
             /**
              * @brief Calcula el polinomio de regresion de grado 2
              * @return Polinomio de solucion.
             */
             solucion_cuadratica calcular(){
-                
+                MEDIR("cuadratica::calcular");
+
                 solucion_cuadratica sol;
                 size_t i;
 
@@ -434,27 +799,32 @@ namespace regresion{
                 }
 
                 for(i=0; i<sol.n; i++){
-                    sum_x += x[i];
-                    double x2 = pow(x[i], 2.0f);
+                    double xi = x[i], yi = y[i];
+                    sum_x += xi;
+                    double x2 = pow(xi, 2.0);
                     sum_x2 += x2;
-                    sum_x3 += pow(x[i], 3.0f);
-                    sum_x4 += pow(x[i], 4.0f);
-                    sum_y += y[i];
-                    sum_xy += x[i] * y[i];
-                    sum_x2y += x2 * y[i];
+                    sum_x3 += pow(xi, 3.0);
+                    sum_x4 += pow(xi, 4.0);
+                    sum_y += yi;
+                    sum_xy += xi * yi;
+                    sum_x2y += x2 * yi;
                 }
 
                 // Calcular y_prom
                 y_prom = sum_y / (double)sol.n;
 
-                vector <vector<double>> m {
-                    {(double)sol.n, sum_x, sum_x2, sum_y},
-                    {sum_x, sum_x2, sum_x3, sum_xy},
-                    {sum_x2, sum_x3, sum_x4, sum_x2y}
+                double m[9] = {
+                    (double)sol.n, sum_x, sum_x2,
+                    sum_x, sum_x2, sum_x3,
+                    sum_x2, sum_x3, sum_x4
                 };
-                
-                // Hallar a0, a1 y a2 mediante eliminacion de Gauss
-                vector <double> coef = gauss(m);
+                double coef[3] = {sum_y, sum_xy, sum_x2y};
+
+                // Hallar a0, a1 y a2 mediante eliminacion de Gauss con pivoteo parcial
+                {
+                    MEDIR("cuadratica::calcular::gauss");
+                    util::resolver_lote(3, 1, m, coef);
+                }
 
                 //Imprimir los coeficientes
 
@@ -463,18 +833,19 @@ namespace regresion{
                 sol.a2 = coef[2];
 
                 // Calcular st
-                sol.st = 0.0f;
+                sol.st = 0.0;
                 for(i=0; i<sol.n; i++){
-                    sol.st += pow(y[i] - y_prom, 2.0f);
+                    sol.st += pow((double)y[i] - y_prom, 2.0);
                 }
 
                 // Calcular sy
                 sol.sy = sqrt(sol.st / (double)(sol.n - 1));  
 
                	//Calcular sr
-			    sol.sr = 0.0f;
+			    sol.sr = 0.0;
                 for(size_t i = 0; i<sol.n; i++) {
-                    sol.sr += pow(y[i] - sol.a0 - (sol.a1*x[i]) - (sol.a2*pow(x[i], 2.0f)) , 2.0f);
+                    double xi = x[i];
+                    sol.sr += pow((double)y[i] - sol.a0 - (sol.a1*xi) - (sol.a2*pow(xi, 2.0)) , 2.0);
                 }
 			
                 //Calcular sxy
@@ -489,8 +860,17 @@ namespace regresion{
 
             }
         private:
-            vector<double> x; /*!< Variable independiente */
-            vector<double> y; /*!< Variable dependiente */
+            util::basic_datos<T> x; /*!< Variable independiente */
+            util::basic_datos<T> y; /*!< Variable dependiente */
     };
+
+    using lineal_simple = basic_lineal_simple<double>; /*!< Regresion lineal sobre datos double */
+    using lineal_simple_f = basic_lineal_simple<float>; /*!< Regresion lineal sobre datos float */
+    using potencia = basic_potencia<double>; /*!< Regresion potencia sobre datos double */
+    using potencia_f = basic_potencia<float>; /*!< Regresion potencia sobre datos float */
+    using exponencial = basic_exponencial<double>; /*!< Regresion exponencial sobre datos double */
+    using exponencial_f = basic_exponencial<float>; /*!< Regresion exponencial sobre datos float */
+    using cuadratica = basic_cuadratica<double>; /*!< Regresion cuadratica sobre datos double */
+    using cuadratica_f = basic_cuadratica<float>; /*!< Regresion cuadratica sobre datos float */
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,239 @@
+/**
+ * @file
+ * @brief Remuestreo de una serie sobre una malla nueva en un solo recorrido
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Remuestrear con spline3::interpolar o newton::interpolar es una consulta
+ * independiente por punto de la malla destino. Aqui el ajuste se hace una
+ * vez: para los metodos por tramos se calcula el polinomio de cada
+ * intervalo, c0 + c1 t + c2 t^2 + c3 t^3 con t = x - x[i - 1], y la malla
+ * destino, ordenada, se recorre a la par con la de origen sin buscar. Las
+ * mallas destino grandes se reparten en tramos contiguos entre los hilos;
+ * cada tramo busca su intervalo inicial una sola vez.
+ *
+ * Fuera del rango de los datos el resultado es NaN, para todos los metodos.
+*/
+
+#ifndef REMUESTREO_H
+#define REMUESTREO_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "arena.h"
+#include "instrumentacion.h"
+#include "newton.h"
+#include "paralelo.h"
+#include "spline3.h"
+
+using std::size_t;
+using std::span;
+using std::string;
+using std::string_view;
+using std::invalid_argument;
+
+namespace remuestreo {
+
+    /**
+     * @brief Metodo de interpolacion del remuestreo
+    */
+    enum class metodo {
+        lineal, /*!< Recta entre cada par de datos */
+        spline3, /*!< Trazador cubico natural, como interpolacion::spline3 */
+        newton /*!< Polinomio de Newton por todos los datos */
+    };
+
+    /**
+     * @brief Interpreta el nombre de un metodo
+     * @param nombre lineal, spline3 o newton
+    */
+    inline metodo metodo_desde(string_view nombre){
+        if (nombre == "lineal"){
+            return metodo::lineal;
+        }
+        if (nombre == "spline3"){
+            return metodo::spline3;
+        }
+        if (nombre == "newton"){
+            return metodo::newton;
+        }
+        throw invalid_argument("Metodo de remuestreo desconocido: " + string(nombre));
+    }
+
+    /**
+     * @brief Malla destino de puntos inicio + k * paso, sin guardarla
+    */
+    struct malla_uniforme {
+        double inicio; /*!< Primer punto */
+        double paso; /*!< Distancia entre puntos, no negativa */
+
+        /** @brief Punto k */
+        double operator[](size_t k) const {
+            return inicio + paso * (double)k;
+        }
+    };
+
+    namespace detalle {
+
+        /** @brief Valida los datos de origen: mismo tamaño, al menos 2 y x creciente */
+        inline void validar_origen(span<const double> x, span<const double> y){
+            if (x.size() != y.size()){
+                throw invalid_argument("x e y deben tener el mismo tamano");
+            }
+            if (x.size() < 2){
+                throw invalid_argument("Se necesitan al menos 2 datos para interpolar");
+            }
+            for (size_t i = 1; i < x.size(); i++){
+                if (!(x[i] > x[i - 1])){
+                    throw invalid_argument("Los datos de x deben estar ordenados de forma estrictamente creciente");
+                }
+            }
+        }
+
+        /**
+         * @brief Coeficientes c0..c3 de cada intervalo, 4 por intervalo
+         * @param x Variable independiente, creciente
+         * @param y Variable dependiente
+         * @param m lineal o spline3
+         * @param coef Salida de 4 (n - 1) elementos
+         *
+         * Para spline3 son los de interpolacion::spline3::coeficientes, con
+         * los datos prestados.
+        */
+        inline void coeficientes(span<const double> x, span<const double> y, metodo m, span<double> coef){
+            MEDIR("remuestreo::coeficientes");
+            if (m == metodo::spline3){
+                interpolacion::spline3 trazador(util::prestado, x, y);
+                trazador.coeficientes(coef);
+                return;
+            }
+
+            for (size_t i = 1; i < x.size(); i++){
+                double *c = coef.data() + 4 * (i - 1);
+                c[0] = y[i - 1];
+                c[1] = (y[i] - y[i - 1]) / (x[i] - x[i - 1]);
+                c[2] = 0.0;
+                c[3] = 0.0;
+            }
+        }
+
+        /**
+         * @brief Evalua los polinomios por tramos en los puntos [inicio, fin) de una malla ordenada
+         * @tparam M Malla: span<const double> o malla_uniforme
+        */
+        template <typename M>
+        void barrer(span<const double> x, span<const double> coef, const M &destino,
+                    size_t inicio, size_t fin, span<double> salida){
+            const size_t n = x.size();
+            const double *px = x.data();
+            const double x_min = px[0], x_max = px[n - 1];
+
+            // Intervalo del primer punto: primer i >= 1 con destino[inicio] <= x[i]
+            size_t i = std::max<size_t>(1, std::lower_bound(px + 1, px + n - 1, destino[inicio]) - px);
+
+            for (size_t k = inicio; k < fin; k++){
+                double q = destino[k];
+                if (!(q >= x_min && q <= x_max)){
+                    salida[k] = NAN;
+                    continue;
+                }
+                while (q > px[i]){
+                    i++;
+                }
+                double t = q - px[i - 1];
+                const double *c = coef.data() + 4 * (i - 1);
+                salida[k] = c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+            }
+        }
+
+        /**
+         * @brief Remuestrea sobre una malla ordenada de salida.size() puntos
+        */
+        template <typename M>
+        void remuestrear(span<const double> x, span<const double> y, const M &destino,
+                         span<double> salida, metodo m, size_t grano){
+            MEDIR("remuestreo::remuestrear");
+            CONTAR("remuestreo::valores", salida.size());
+            validar_origen(x, y);
+            grano = std::max<size_t>(1, grano);
+            const size_t total = salida.size();
+            const size_t tareas = (total + grano - 1) / grano;
+
+            if (m == metodo::newton){
+                interpolacion::newton polinomio(util::prestado, x, y);
+                const double x_min = x.front(), x_max = x.back();
+                paralelo::para_cada(tareas, [&](size_t tarea){
+                    size_t inicio = tarea * grano;
+                    size_t fin = std::min(total, inicio + grano);
+                    for (size_t k = inicio; k < fin; k++){
+                        salida[k] = destino[k];
+                    }
+                    span<double> tramo = salida.subspan(inicio, fin - inicio);
+                    polinomio.evaluar(tramo, tramo);
+                    for (size_t k = inicio; k < fin; k++){
+                        double q = destino[k];
+                        if (!(q >= x_min && q <= x_max)){
+                            salida[k] = NAN;
+                        }
+                    }
+                });
+                return;
+            }
+
+            std::pmr::vector<double> coef(4 * (x.size() - 1), util::temporales());
+            coeficientes(x, y, m, coef);
+            paralelo::para_cada(tareas, [&](size_t tarea){
+                size_t inicio = tarea * grano;
+                barrer(x, coef, destino, inicio, std::min(total, inicio + grano), salida);
+            });
+        }
+    }
+
+    /**
+     * @brief Remuestrea una serie sobre una malla destino ordenada
+     * @param x Variable independiente de origen, estrictamente creciente
+     * @param y Variable dependiente de origen
+     * @param destino Malla destino, creciente (admite repetidos) y sin NaN
+     * @param salida Salida: un valor por punto de destino, NaN fuera del rango de x
+     * @param m Metodo
+     * @param grano Puntos por tarea paralela
+    */
+    inline void remuestrear(span<const double> x, span<const double> y, span<const double> destino,
+                            span<double> salida, metodo m = metodo::spline3, size_t grano = 1 << 14){
+        if (destino.size() != salida.size()){
+            throw invalid_argument("El destino y la salida deben tener el mismo tamano");
+        }
+        for (size_t k = 0; k < destino.size(); k++){
+            if (!(destino[k] >= (k > 0 ? destino[k - 1] : destino[k]))){
+                throw invalid_argument("La malla destino debe estar ordenada de forma creciente y sin NaN");
+            }
+        }
+        detalle::remuestrear(x, y, destino, salida, m, grano);
+    }
+
+    /**
+     * @brief Remuestrea una serie sobre la malla uniforme inicio + k * paso, k < salida.size()
+     * @param x Variable independiente de origen, estrictamente creciente
+     * @param y Variable dependiente de origen
+     * @param destino Malla uniforme, con paso no negativo
+     * @param salida Salida: un valor por punto de destino, NaN fuera del rango de x
+     * @param m Metodo
+     * @param grano Puntos por tarea paralela
+    */
+    inline void remuestrear(span<const double> x, span<const double> y, malla_uniforme destino,
+                            span<double> salida, metodo m = metodo::spline3, size_t grano = 1 << 14){
+        if (!(destino.paso >= 0.0) || !std::isfinite(destino.inicio)){
+            throw invalid_argument("La malla destino debe tener un inicio finito y un paso no negativo");
+        }
+        detalle::remuestrear(x, y, destino, salida, m, grano);
+    }
+}
+
+#endif
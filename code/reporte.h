@@ -0,0 +1,201 @@
+/**
+ * @file
+ * @brief Reportes de las soluciones de regresion en texto, CSV o JSON
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Cada solucion se describe como una lista de campos (nombre, valor), la
+ * misma para los tres formatos:
+ *
+ * | solucion    | campos                                         |
+ * |-------------|------------------------------------------------|
+ * | lineal      | b0, b1, st, sy, sr, syx, r2, n                 |
+ * | potencia    | c, a y los campos lineales de ln(x), ln(y)     |
+ * | exponencial | c, a y los campos lineales de x, ln(y)         |
+ * | cuadratica  | a0, a1, a2, st, sr, sy, syx, r2, n             |
+ *
+ * Varias soluciones del mismo tipo se escriben en CSV como una fila cada
+ * una bajo un solo encabezado, y en JSON como un arreglo de objetos.
+*/
+
+#ifndef REPORTE_H
+#define REPORTE_H
+
+#include <cmath>
+#include <span>
+#include <string_view>
+
+#include "regresion.h"
+#include "tabla.h"
+
+using std::size_t;
+using std::span;
+using std::string_view;
+
+namespace reporte {
+
+    using util::escritor_texto;
+    using util::formato;
+
+    /**
+     * @brief Recorre los campos de la regresion lineal
+     * @param s Solucion
+     * @param f Funcion f(nombre, valor)
+    */
+    template <typename F>
+    void campos(const regresion::solucion_lineal &s, F f){
+        f("b0", s.b0);
+        f("b1", s.b1);
+        f("st", s.st);
+        f("sy", s.sy);
+        f("sr", s.sr);
+        f("syx", s.syx);
+        f("r2", s.r2);
+        f("n", (double)s.n);
+    }
+
+    /** @brief Recorre los campos de la regresion potencia */
+    template <typename F>
+    void campos(const regresion::solucion_potencia &s, F f){
+        f("c", s.c);
+        f("a", s.a);
+        campos(s.lineal, f);
+    }
+
+    /** @brief Recorre los campos de la regresion exponencial */
+    template <typename F>
+    void campos(const regresion::solucion_exponencial &s, F f){
+        f("c", s.c);
+        f("a", s.a);
+        campos(s.lineal, f);
+    }
+
+    /** @brief Recorre los campos de la regresion cuadratica */
+    template <typename F>
+    void campos(const regresion::solucion_cuadratica &s, F f){
+        f("a0", s.a0);
+        f("a1", s.a1);
+        f("a2", s.a2);
+        f("st", s.st);
+        f("sr", s.sr);
+        f("sy", s.sy);
+        f("syx", s.syx);
+        f("r2", s.r2);
+        f("n", (double)s.n);
+    }
+
+    /** @brief Escribe un termino " + v" o " - |v|" con 6 cifras */
+    inline void termino(escritor_texto &e, double v){
+        e.texto(v >= 0.0 ? " + " : " - ").real(std::fabs(v), 6);
+    }
+
+    /** @brief Escribe la ecuacion de la regresion lineal */
+    inline void ecuacion(escritor_texto &e, const regresion::solucion_lineal &s){
+        e.texto("Recta de regresion: y = ").real(s.b1, 6).texto(" * x");
+        termino(e, s.b0);
+    }
+
+    /** @brief Escribe la ecuacion de la regresion potencia */
+    inline void ecuacion(escritor_texto &e, const regresion::solucion_potencia &s){
+        e.texto("Regresion potencia: y = ").real(s.c, 6).texto(" * x^").real(s.a, 6);
+    }
+
+    /** @brief Escribe la ecuacion de la regresion exponencial */
+    inline void ecuacion(escritor_texto &e, const regresion::solucion_exponencial &s){
+        e.texto("Regresion exponencial: y = ").real(s.c, 6).texto(" * e^(").real(s.a, 6).texto(" * x)");
+    }
+
+    /** @brief Escribe la ecuacion de la regresion cuadratica */
+    inline void ecuacion(escritor_texto &e, const regresion::solucion_cuadratica &s){
+        e.texto("Polinomio de regresion: y = ").real(s.a2, 6).texto(" * x^2");
+        termino(e, s.a1);
+        e.texto(" * x");
+        termino(e, s.a0);
+    }
+
+    /** @brief Solucion con sy, syx y r2 de la regresion lineal */
+    inline const regresion::solucion_lineal &estadisticas(const regresion::solucion_lineal &s){
+        return s;
+    }
+
+    /** @brief Solucion con sy, syx y r2 de la regresion potencia: la de los datos linealizados */
+    inline const regresion::solucion_lineal &estadisticas(const regresion::solucion_potencia &s){
+        return s.lineal;
+    }
+
+    /** @brief Solucion con sy, syx y r2 de la regresion exponencial: la de los datos linealizados */
+    inline const regresion::solucion_lineal &estadisticas(const regresion::solucion_exponencial &s){
+        return s.lineal;
+    }
+
+    /** @brief Solucion con sy, syx y r2 de la regresion cuadratica */
+    inline const regresion::solucion_cuadratica &estadisticas(const regresion::solucion_cuadratica &s){
+        return s;
+    }
+
+    /**
+     * @brief Escribe una o varias soluciones del mismo tipo
+     * @param e Escritor
+     * @param soluciones Soluciones
+     * @param f Formato
+    */
+    template <typename S>
+    void escribir_varias(escritor_texto &e, span<const S> soluciones, formato f){
+        if (f == formato::csv){
+            bool primero = true;
+            campos(S{}, [&](string_view nombre, double){
+                (primero ? e : e.caracter(',')).cadena_csv(nombre);
+                primero = false;
+            });
+            e.caracter('\n');
+            for (const S &s : soluciones){
+                primero = true;
+                campos(s, [&](string_view, double v){
+                    (primero ? e : e.caracter(',')).real(v);
+                    primero = false;
+                });
+                e.caracter('\n');
+            }
+            return;
+        }
+        if (f == formato::json){
+            if (soluciones.size() != 1){
+                e.caracter('[');
+            }
+            for (size_t i = 0; i < soluciones.size(); i++){
+                bool primero = true;
+                (i > 0 ? e.texto(", ") : e).caracter('{');
+                campos(soluciones[i], [&](string_view nombre, double v){
+                    (primero ? e : e.texto(", ")).cadena_json(nombre).texto(": ").real_json(v);
+                    primero = false;
+                });
+                e.caracter('}');
+            }
+            e.texto(soluciones.size() != 1 ? "]\n" : "\n");
+            return;
+        }
+        for (const S &s : soluciones){
+            const auto &est = estadisticas(s);
+            ecuacion(e, s);
+            e.texto("\nDesviacion estandar: ").real(est.sy, 6)
+             .texto("\nError estandar de aproximacion: ").real(est.syx, 6)
+             .texto(est.syx < est.sy ? "\nLa aproximacion se considera aceptable"
+                                     : "\nLa aproximacion NO se considera aceptable")
+             .texto("\nCoeficiente de determinacion: ").real(est.r2, 6)
+             .texto("\n\n");
+        }
+    }
+
+    /**
+     * @brief Escribe una solucion
+     * @param e Escritor
+     * @param s Solucion
+     * @param f Formato
+    */
+    template <typename S>
+    void escribir(escritor_texto &e, const S &s, formato f){
+        escribir_varias(e, span<const S>(&s, 1), f);
+    }
+}
+
+#endif
@@ -0,0 +1,193 @@
+/**
+ * @file
+ * @brief Servidor local de consultas y cliente de prueba
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Uso:
+ * - servidor <socket>: atiende peticiones hasta recibir detener o SIGINT/SIGTERM
+ * - servidor --cliente <socket>: ejecuta la prueba contra un servidor en marcha
+ * - servidor --prueba: levanta un servidor en un socket temporal y ejecuta la prueba
+ *
+ * La prueba carga un trazador cubico, envia peticiones de evaluacion desde
+ * varios hilos, compara cada respuesta con el mismo modelo evaluado en el
+ * cliente y muestra las latencias del servidor.
+ *
+ * Compilar con: g++ -std=c++20 -O2 -pthread servidor.cpp -o servidor
+*/
+
+#ifdef _WIN32
+
+#include <cstdio>
+
+int main(){
+    std::fprintf(stderr, "El servidor local usa sockets Unix y no esta disponible en Windows\n");
+    return 1;
+}
+
+#else
+
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <exception>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "instrumentacion.h"
+#include "servidor.h"
+#include "spline3.h"
+
+using std::string;
+using std::vector;
+
+// Con -DINSTRUMENTAR cuenta las asignaciones de memoria de cada metodo medido
+INSTRUMENTACION_REEMPLAZAR_NEW;
+
+namespace {
+    servidor::servidor_local *activo = nullptr; /*!< Servidor que detienen las señales */
+
+    void al_recibir_senal(int){
+        if (activo != nullptr){
+            activo->detener();
+        }
+    }
+}
+
+/**
+ * @brief Carga un modelo, lo evalua desde varios hilos y verifica las respuestas
+ * @param ruta Socket del servidor
+ * @return true si todas las respuestas coinciden con la evaluacion local
+*/
+bool probar(const string &ruta){
+    const uint64_t CLAVE = 42;
+    const size_t N_DATOS = 500;
+    const size_t HILOS = 4;
+    const size_t PETICIONES = 2000; // Por hilo
+    const size_t PUNTOS = 256; // Por peticion
+    const size_t VENTANA = 32; // Peticiones en vuelo por hilo
+
+    vector<double> x(N_DATOS), y(N_DATOS);
+    for (size_t i = 0; i < N_DATOS; i++){
+        x[i] = 10.0 * (double)i / (double)(N_DATOS - 1);
+        y[i] = std::sin(x[i]) + 0.1 * x[i];
+    }
+    interpolacion::spline3 local(util::prestado, x, y);
+
+    servidor::cliente_local control(ruta);
+    control.cargar(CLAVE, servidor::metodo::spline3, x, y);
+
+    vector<size_t> errores(HILOS, 0);
+    auto inicio = std::chrono::steady_clock::now();
+    vector<std::thread> hilos;
+    for (size_t h = 0; h < HILOS; h++){
+        hilos.emplace_back([&, h]{
+            servidor::cliente_local cliente(ruta);
+            std::mt19937_64 gen(h);
+            std::uniform_real_distribution<double> rango(-0.5, 10.5);
+            vector<vector<double>> consultas(VENTANA, vector<double>(PUNTOS));
+            vector<double> esperado(PUNTOS);
+            vector<char> cuerpo;
+
+            for (size_t enviadas = 0; enviadas < PETICIONES; enviadas += VENTANA){
+                size_t lote = std::min(VENTANA, PETICIONES - enviadas);
+                for (size_t k = 0; k < lote; k++){
+                    for (double &v : consultas[k]){
+                        v = rango(gen);
+                    }
+                    cliente.enviar(servidor::operacion::evaluar,
+                                   servidor::cliente_local::peticion_evaluar(CLAVE, consultas[k]));
+                }
+                // Las respuestas pueden llegar en otro orden; el id indica la peticion
+                uint32_t primer_id = (uint32_t)(enviadas + 1);
+                for (size_t k = 0; k < lote; k++){
+                    servidor::encabezado enc = cliente.recibir(cuerpo);
+                    size_t j = enc.id - primer_id;
+                    if (enc.resultado != (uint32_t)servidor::estado::ok || j >= lote
+                        || cuerpo.size() != PUNTOS * sizeof(double)){
+                        errores[h]++;
+                        continue;
+                    }
+                    local.evaluar(consultas[j], esperado);
+                    for (size_t i = 0; i < PUNTOS; i++){
+                        double v;
+                        std::memcpy(&v, cuerpo.data() + i * sizeof(double), sizeof(double));
+                        if (!(v == esperado[i] || (std::isnan(v) && std::isnan(esperado[i])))){
+                            errores[h]++;
+                            break;
+                        }
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread &h : hilos){
+        h.join();
+    }
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+
+    size_t total_errores = 0;
+    for (size_t e : errores){
+        total_errores += e;
+    }
+    double puntos = (double)(HILOS * PETICIONES * PUNTOS);
+    std::printf("Peticiones: %zu de %zu puntos, %.0f peticiones/s, %.2f millones de puntos/s, errores: %zu\n",
+                HILOS * PETICIONES, PUNTOS, (double)(HILOS * PETICIONES) / segundos, puntos / segundos / 1e6,
+                total_errores);
+
+    const char *nombres[] = {"", "cargar", "cargar_archivo", "evaluar", "descartar", "estadisticas", "detener"};
+    std::printf("%-15s %10s %12s %12s %12s\n", "operacion", "cantidad", "p50 (us)", "p99 (us)", "max (us)");
+    for (const servidor::estadistica &e : control.estadisticas()){
+        if (e.cantidad > 0 && e.op < 7){
+            std::printf("%-15s %10llu %12.1f %12.1f %12.1f\n", nombres[e.op], (unsigned long long)e.cantidad,
+                        e.p50_ns / 1e3, e.p99_ns / 1e3, e.maximo_ns / 1e3);
+        }
+    }
+    return total_errores == 0;
+}
+
+int main(int argc, char *argv[]){
+    try {
+        if (argc == 2 && string(argv[1]) == "--prueba"){
+            string ruta = "/tmp/interpolacion-" + std::to_string(::getpid()) + ".sock";
+            servidor::servidor_local srv(ruta);
+            std::thread eventos([&]{ srv.ejecutar(); });
+            bool ok = false;
+            try {
+                ok = probar(ruta);
+                servidor::cliente_local(ruta).detener();
+            } catch (...) {
+                srv.detener();
+                eventos.join();
+                throw;
+            }
+            eventos.join();
+            return ok ? 0 : 1;
+        }
+        if (argc == 3 && string(argv[1]) == "--cliente"){
+            return probar(argv[2]) ? 0 : 1;
+        }
+        if (argc == 2 && argv[1][0] != '-'){
+            servidor::servidor_local srv(argv[1]);
+            activo = &srv;
+            std::signal(SIGINT, al_recibir_senal);
+            std::signal(SIGTERM, al_recibir_senal);
+            std::fprintf(stderr, "Escuchando en %s\n", argv[1]);
+            srv.ejecutar();
+            activo = nullptr;
+            return 0;
+        }
+    } catch (const std::exception &e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+    std::fprintf(stderr, "Uso: %s <socket> | --cliente <socket> | --prueba\n", argv[0]);
+    return 2;
+}
+
+#endif
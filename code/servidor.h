@@ -0,0 +1,942 @@
+/**
+ * @file
+ * @brief Servidor local de consultas sobre un socket Unix, con cache de modelos ajustados
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Cada modelo se carga y se ajusta una sola vez y queda en la cache con
+ * una clave elegida por el cliente. Cargar datos que ya se ajustaron con el
+ * mismo metodo, con cualquier clave, reutiliza el ajuste
+ * (util::cache_modelos). Un hilo atiende todas las conexiones con poll();
+ * las peticiones completas pasan a un grupo de trabajadores y las
+ * respuestas vuelven al hilo de eventos por una tuberia.
+ *
+ * Protocolo binario, little-endian. Toda trama (peticion o respuesta)
+ * empieza con un encabezado de 24 bytes seguido de longitud bytes:
+ *
+ * | operacion      | cuerpo de la peticion                                   | cuerpo de la respuesta |
+ * |----------------|---------------------------------------------------------|------------------------|
+ * | cargar         | clave u64, metodo u32, 0 u32, n u64, x[n] f64, y[n] f64 | vacio                  |
+ * | cargar_archivo | clave u64, metodo u32, 0 u32, ruta (bytes)              | vacio                  |
+ * | evaluar        | clave u64, m u64, x[m] f64                              | y[m] f64               |
+ * | descartar      | clave u64                                               | vacio                  |
+ * | estadisticas   | vacio                                                   | ver estadistica        |
+ * | detener        | vacio                                                   | vacio                  |
+ *
+ * Si estado no es ok, el cuerpo de la respuesta es el mensaje de error.
+ * Solo POSIX; en Windows este archivo no declara nada.
+*/
+
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+#ifndef _WIN32
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "arena.h"
+#include "lote.h"
+#include "paralelo.h"
+
+using std::size_t;
+using std::span;
+using std::string;
+using std::vector;
+using std::uint16_t;
+using std::uint32_t;
+using std::uint64_t;
+using std::runtime_error;
+using std::invalid_argument;
+
+namespace servidor {
+
+    static_assert(std::endian::native == std::endian::little, "El protocolo supone un procesador little-endian");
+
+    const uint32_t MAGIA = 0x50544E49; /*!< "INTP" */
+    const uint16_t VERSION = 1; /*!< Version del protocolo */
+    const uint64_t LONGITUD_MAXIMA = uint64_t(1) << 30; /*!< Cuerpo mas largo que se acepta */
+#ifdef MSG_NOSIGNAL
+    const int SIN_SENAL = MSG_NOSIGNAL; /*!< Escribir en un socket cerrado no genera SIGPIPE */
+#else
+    const int SIN_SENAL = 0;
+#endif
+
+    /**
+     * @brief Operaciones del protocolo
+    */
+    enum class operacion : uint16_t {
+        cargar = 1,
+        cargar_archivo = 2,
+        evaluar = 3,
+        descartar = 4,
+        estadisticas = 5,
+        detener = 6
+    };
+    const size_t N_OPERACIONES = 7;
+
+    /**
+     * @brief Resultado de una peticion
+    */
+    enum class estado : uint32_t {
+        ok = 0,
+        error = 1,
+        no_encontrado = 2
+    };
+
+    /**
+     * @brief Metodos que se pueden cargar
+    */
+    enum class metodo : uint32_t {
+        newton = 1,
+        lagrange = 2,
+        spline3 = 3,
+        lineal = 4,
+        potencia = 5,
+        exponencial = 6,
+        cuadratica = 7
+    };
+
+    /**
+     * @brief Nombre del metodo, como en el modo por lotes
+    */
+    inline string nombre_metodo(metodo m){
+        switch (m){
+            case metodo::newton: return "newton";
+            case metodo::lagrange: return "lagrange";
+            case metodo::spline3: return "spline3";
+            case metodo::lineal: return "lineal";
+            case metodo::potencia: return "potencia";
+            case metodo::exponencial: return "exponencial";
+            case metodo::cuadratica: return "cuadratica";
+        }
+        throw invalid_argument("Metodo desconocido");
+    }
+
+    /**
+     * @brief Encabezado de cada trama
+    */
+    struct encabezado {
+        uint32_t magia = MAGIA; /*!< Siempre MAGIA */
+        uint16_t version = VERSION; /*!< Version del protocolo */
+        uint16_t op = 0; /*!< operacion */
+        uint32_t id = 0; /*!< Identificador elegido por el cliente; la respuesta lo repite */
+        uint32_t resultado = 0; /*!< estado; 0 en las peticiones */
+        uint64_t longitud = 0; /*!< Bytes del cuerpo */
+    };
+    static_assert(sizeof(encabezado) == 24, "El encabezado debe ocupar 24 bytes");
+
+    /**
+     * @brief Registro de la respuesta de estadisticas (la respuesta es un arreglo de estos)
+    */
+    struct estadistica {
+        uint16_t op; /*!< operacion */
+        uint16_t reservado[3]; /*!< Relleno, en 0 */
+        uint64_t cantidad; /*!< Peticiones atendidas */
+        uint64_t p50_ns; /*!< Mediana de la latencia */
+        uint64_t p99_ns; /*!< Percentil 99 de la latencia */
+        uint64_t maximo_ns; /*!< Latencia maxima */
+    };
+    static_assert(sizeof(estadistica) == 40, "El registro de estadisticas debe ocupar 40 bytes");
+
+    /**
+     * @brief Agrega los bytes de un valor al final del buffer
+    */
+    template <typename T>
+    void agregar(vector<char> &buffer, const T &valor){
+        const char *p = reinterpret_cast<const char *>(&valor);
+        buffer.insert(buffer.end(), p, p + sizeof(T));
+    }
+
+    /**
+     * @brief Agrega los bytes de un arreglo al final del buffer
+    */
+    template <typename T>
+    void agregar(vector<char> &buffer, span<const T> valores){
+        const char *p = reinterpret_cast<const char *>(valores.data());
+        buffer.insert(buffer.end(), p, p + valores.size_bytes());
+    }
+
+    /**
+     * @brief Lector secuencial del cuerpo de una trama
+    */
+    class cursor {
+        public:
+            explicit cursor(span<const char> p_datos) : datos(p_datos){
+            }
+
+            /** @brief Lee un valor */
+            template <typename T>
+            T leer(){
+                T valor;
+                std::memcpy(&valor, tomar(sizeof(T)), sizeof(T));
+                return valor;
+            }
+
+            /** @brief Lee n reales en destino */
+            void leer(span<double> destino){
+                std::memcpy(destino.data(), tomar(destino.size_bytes()), destino.size_bytes());
+            }
+
+            /** @brief Bytes sin leer */
+            span<const char> resto() const {
+                return datos.subspan(pos);
+            }
+
+        private:
+            span<const char> datos; /*!< Cuerpo de la trama */
+            size_t pos = 0; /*!< Bytes leidos */
+
+            const char *tomar(size_t n){
+                if (n > datos.size() - pos){
+                    throw invalid_argument("Cuerpo de la trama demasiado corto");
+                }
+                const char *p = datos.data() + pos;
+                pos += n;
+                return p;
+            }
+    };
+
+    /**
+     * @brief Latencias recientes de una operacion
+    */
+    class registro_latencias {
+        public:
+            /** @brief Registra una latencia */
+            void agregar(uint64_t ns){
+                if (muestras.size() < CAPACIDAD){
+                    muestras.push_back(ns);
+                } else {
+                    muestras[cantidad % CAPACIDAD] = ns;
+                }
+                cantidad++;
+                maximo = std::max(maximo, ns);
+            }
+
+            /** @brief Resumen con los percentiles de las ultimas CAPACIDAD muestras */
+            estadistica resumen(uint16_t op) const {
+                estadistica e{};
+                e.op = op;
+                e.cantidad = cantidad;
+                e.maximo_ns = maximo;
+                if (!muestras.empty()){
+                    vector<uint64_t> copia(muestras);
+                    e.p50_ns = percentil(copia, 0.50);
+                    e.p99_ns = percentil(copia, 0.99);
+                }
+                return e;
+            }
+
+        private:
+            static const size_t CAPACIDAD = 1 << 16;
+            vector<uint64_t> muestras; /*!< Anillo de las ultimas latencias */
+            uint64_t cantidad = 0; /*!< Latencias registradas */
+            uint64_t maximo = 0; /*!< Latencia maxima */
+
+            static uint64_t percentil(vector<uint64_t> &v, double p){
+                size_t k = (size_t)(p * (double)(v.size() - 1));
+                std::nth_element(v.begin(), v.begin() + k, v.end());
+                return v[k];
+            }
+    };
+
+    /**
+     * @brief Modelo ajustado en la cache; se comparte entre trabajadores sin bloqueos
+    */
+    struct modelo_cargado {
+        metodo tipo; /*!< Metodo ajustado */
+        size_t n; /*!< Numero de datos */
+        lote::evaluador evaluar; /*!< Evaluador const, seguro entre hilos */
+    };
+
+    /**
+     * @brief Servidor de consultas sobre un socket Unix
+    */
+    class servidor_local {
+        public:
+            /**
+             * @brief Crea el socket y empieza a escuchar; las conexiones se atienden con ejecutar()
+             * @param p_ruta Ruta del socket; si existe se reemplaza
+             * @param trabajadores Hilos que atienden las peticiones
+            */
+            explicit servidor_local(string p_ruta, size_t trabajadores = paralelo::hilos_disponibles())
+                : ruta(std::move(p_ruta)){
+                sockaddr_un dir{};
+                if (ruta.size() >= sizeof(dir.sun_path)){
+                    throw invalid_argument("Ruta del socket demasiado larga: " + ruta);
+                }
+                if (::pipe(tuberia) != 0){
+                    throw runtime_error("No se pudo crear la tuberia de respuestas");
+                }
+                no_bloqueante(tuberia[0]);
+                no_bloqueante(tuberia[1]);
+
+                escucha = ::socket(AF_UNIX, SOCK_STREAM, 0);
+                if (escucha < 0){
+                    cerrar_descriptores();
+                    throw runtime_error("No se pudo crear el socket");
+                }
+                dir.sun_family = AF_UNIX;
+                std::memcpy(dir.sun_path, ruta.c_str(), ruta.size() + 1);
+                ::unlink(ruta.c_str());
+                if (::bind(escucha, (sockaddr *)&dir, sizeof(dir)) != 0 || ::listen(escucha, 128) != 0){
+                    cerrar_descriptores();
+                    throw runtime_error("No se pudo escuchar en " + ruta + ": " + std::strerror(errno));
+                }
+                no_bloqueante(escucha);
+
+                for (size_t i = 0; i < std::max<size_t>(1, trabajadores); i++){
+                    hilos.emplace_back([this]{ trabajar(); });
+                }
+            }
+
+            servidor_local(const servidor_local &) = delete;
+            servidor_local &operator=(const servidor_local &) = delete;
+
+            ~servidor_local(){
+                {
+                    std::lock_guard<std::mutex> lock(mutex_tareas);
+                    terminar = true;
+                }
+                hay_tareas.notify_all();
+                for (std::thread &h : hilos){
+                    h.join();
+                }
+                for (auto &[id, c] : conexiones){
+                    ::close(c.fd);
+                }
+                cerrar_descriptores();
+                ::unlink(ruta.c_str());
+            }
+
+            /**
+             * @brief Atiende conexiones hasta recibir detener (por el protocolo o con detener())
+             *
+             * Al recibir detener deja de aceptar conexiones y de leer peticiones,
+             * pero responde las que ya estaban en cola. Luego envia lo pendiente
+             * sin bloquear, durante a lo sumo PLAZO_ENVIO; las conexiones que no
+             * terminan de recibir en ese plazo se cierran con el servidor.
+            */
+            void ejecutar(){
+                vector<pollfd> fds;
+                vector<uint64_t> ids;
+                while (true){
+                    const bool vaciando = parar.load();
+                    if (vaciando && en_curso == 0){
+                        break;
+                    }
+                    fds.assign({{tuberia[0], POLLIN, 0}, {escucha, (short)(vaciando ? 0 : POLLIN), 0}});
+                    ids.assign(2, 0);
+                    for (auto &[id, c] : conexiones){
+                        short eventos = vaciando ? 0 : POLLIN;
+                        if (c.enviado < c.salida.size()){
+                            eventos |= POLLOUT;
+                        }
+                        fds.push_back({c.fd, eventos, 0});
+                        ids.push_back(id);
+                    }
+
+                    if (::poll(fds.data(), fds.size(), -1) < 0){
+                        if (errno == EINTR){
+                            continue;
+                        }
+                        throw runtime_error("poll fallo");
+                    }
+
+                    if (fds[0].revents & POLLIN){
+                        recibir_respuestas();
+                    }
+                    if (fds[1].revents & POLLIN){
+                        aceptar();
+                    }
+                    for (size_t k = 2; k < fds.size(); k++){
+                        auto it = conexiones.find(ids[k]);
+                        if (it == conexiones.end()){
+                            continue;
+                        }
+                        conexion &c = it->second;
+                        bool abierta = true;
+                        if (vaciando){
+                            abierta = !(fds[k].revents & (POLLHUP | POLLERR));
+                        } else if (fds[k].revents & (POLLIN | POLLHUP | POLLERR)){
+                            abierta = leer(ids[k], c);
+                        }
+                        if (abierta && (fds[k].revents & POLLOUT)){
+                            abierta = escribir(c);
+                        }
+                        if (!abierta){
+                            ::close(c.fd);
+                            conexiones.erase(it);
+                        }
+                    }
+                }
+                enviar_pendiente(fds, ids);
+            }
+
+            /**
+             * @brief Pide al ciclo de eventos que termine; se puede llamar desde cualquier hilo
+             *
+             * Las peticiones ya encoladas se responden antes de que ejecutar() retorne.
+            */
+            void detener(){
+                parar.store(true);
+                despertar();
+            }
+
+        private:
+            static constexpr std::chrono::milliseconds PLAZO_ENVIO{1000}; /*!< Tiempo maximo para enviar lo pendiente al terminar */
+
+            /** @brief Estado de una conexion */
+            struct conexion {
+                int fd; /*!< Descriptor del socket */
+                vector<char> entrada; /*!< Bytes recibidos sin procesar */
+                vector<char> salida; /*!< Respuestas pendientes de enviar */
+                size_t enviado = 0; /*!< Bytes de salida ya enviados */
+            };
+
+            using reloj = std::chrono::steady_clock;
+
+            /** @brief Peticion completa para un trabajador */
+            struct tarea {
+                uint64_t conexion; /*!< Conexion de origen */
+                encabezado enc; /*!< Encabezado de la peticion */
+                vector<char> cuerpo; /*!< Cuerpo de la peticion */
+                reloj::time_point llegada; /*!< Momento en que la trama quedo completa */
+            };
+
+            /** @brief Respuesta lista para enviar */
+            struct respuesta {
+                uint64_t conexion; /*!< Conexion de destino */
+                uint16_t op; /*!< Operacion, para las estadisticas */
+                vector<char> trama; /*!< Encabezado y cuerpo */
+                reloj::time_point llegada; /*!< Momento en que llego la peticion */
+            };
+
+            string ruta; /*!< Ruta del socket */
+            int escucha = -1; /*!< Socket que acepta conexiones */
+            int tuberia[2] = {-1, -1}; /*!< Avisa al ciclo de eventos que hay respuestas */
+            std::atomic<bool> parar{false}; /*!< Terminar el ciclo de eventos */
+            size_t en_curso = 0; /*!< Peticiones en cola o en proceso, solo del hilo de eventos */
+
+            std::unordered_map<uint64_t, conexion> conexiones; /*!< Conexiones abiertas, solo del hilo de eventos */
+            uint64_t siguiente_conexion = 1; /*!< Identificador de la proxima conexion */
+
+            vector<std::thread> hilos; /*!< Trabajadores */
+            std::mutex mutex_tareas;
+            std::condition_variable hay_tareas;
+            std::deque<tarea> tareas; /*!< Peticiones pendientes */
+            bool terminar = false; /*!< Los trabajadores deben salir */
+
+            std::mutex mutex_respuestas;
+            vector<respuesta> respuestas; /*!< Respuestas que el ciclo de eventos aun no ha tomado */
+
+            std::shared_mutex mutex_cache;
+            std::unordered_map<uint64_t, std::shared_ptr<const modelo_cargado>> cache; /*!< Modelos por clave */
+            util::cache_modelos ajustes; /*!< Estados ajustados por contenido, para no reajustar datos repetidos */
+
+            std::mutex mutex_latencias;
+            registro_latencias latencias[N_OPERACIONES]; /*!< Latencias por operacion */
+
+            static void no_bloqueante(int fd){
+                ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+            }
+
+            void cerrar_descriptores(){
+                for (int *fd : {&escucha, &tuberia[0], &tuberia[1]}){
+                    if (*fd >= 0){
+                        ::close(*fd);
+                        *fd = -1;
+                    }
+                }
+            }
+
+            void despertar(){
+                char c = 1;
+                ssize_t r = ::write(tuberia[1], &c, 1); // Si la tuberia esta llena ya hay un aviso pendiente
+                (void)r;
+            }
+
+            void aceptar(){
+                while (true){
+                    int fd = ::accept(escucha, nullptr, nullptr);
+                    if (fd < 0){
+                        return;
+                    }
+                    no_bloqueante(fd);
+                    conexiones.emplace(siguiente_conexion++, conexion{fd, {}, {}, 0});
+                }
+            }
+
+            /**
+             * @brief Lee lo disponible y encola las peticiones completas
+             * @return false si la conexion se debe cerrar
+            */
+            bool leer(uint64_t id, conexion &c){
+                char buffer[1 << 16];
+                while (true){
+                    ssize_t n = ::read(c.fd, buffer, sizeof(buffer));
+                    if (n > 0){
+                        c.entrada.insert(c.entrada.end(), buffer, buffer + n);
+                        continue;
+                    }
+                    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)){
+                        break;
+                    }
+                    if (n < 0 && errno == EINTR){
+                        continue;
+                    }
+                    return false; // Fin de la conexion o error
+                }
+
+                size_t pos = 0;
+                while (c.entrada.size() - pos >= sizeof(encabezado)){
+                    encabezado enc;
+                    std::memcpy(&enc, c.entrada.data() + pos, sizeof(enc));
+                    if (enc.magia != MAGIA || enc.version != VERSION || enc.longitud > LONGITUD_MAXIMA){
+                        return false; // Trama invalida: no se puede resincronizar
+                    }
+                    if (c.entrada.size() - pos - sizeof(enc) < enc.longitud){
+                        break;
+                    }
+                    const char *cuerpo = c.entrada.data() + pos + sizeof(enc);
+                    tarea t{id, enc, vector<char>(cuerpo, cuerpo + enc.longitud), reloj::now()};
+                    pos += sizeof(enc) + enc.longitud;
+
+                    if ((operacion)enc.op == operacion::detener){
+                        responder_en_linea(c, t);
+                        parar.store(true);
+                        continue;
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_tareas);
+                        tareas.push_back(std::move(t));
+                    }
+                    en_curso++;
+                    hay_tareas.notify_one();
+                }
+                c.entrada.erase(c.entrada.begin(), c.entrada.begin() + pos);
+                return true;
+            }
+
+            /**
+             * @brief Envia lo que se pueda de la salida
+             * @return false si la conexion se debe cerrar
+            */
+            bool escribir(conexion &c){
+                while (c.enviado < c.salida.size()){
+                    ssize_t n = ::send(c.fd, c.salida.data() + c.enviado, c.salida.size() - c.enviado, SIN_SENAL);
+                    if (n > 0){
+                        c.enviado += n;
+                    } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)){
+                        return true;
+                    } else if (n < 0 && errno == EINTR){
+                        continue;
+                    } else {
+                        return false;
+                    }
+                }
+                c.salida.clear();
+                c.enviado = 0;
+                return true;
+            }
+
+            /**
+             * @brief Envia lo pendiente antes de salir (por ejemplo, la respuesta a detener)
+             *
+             * Los sockets siguen sin bloquear: un cliente que no lee no demora
+             * el cierre mas de PLAZO_ENVIO.
+            */
+            void enviar_pendiente(vector<pollfd> &fds, vector<uint64_t> &ids){
+                const reloj::time_point limite = reloj::now() + PLAZO_ENVIO;
+                while (true){
+                    fds.clear();
+                    ids.clear();
+                    for (auto &[id, c] : conexiones){
+                        if (c.enviado < c.salida.size()){
+                            fds.push_back({c.fd, POLLOUT, 0});
+                            ids.push_back(id);
+                        }
+                    }
+                    auto resto = std::chrono::ceil<std::chrono::milliseconds>(limite - reloj::now()).count();
+                    if (fds.empty() || resto <= 0){
+                        return;
+                    }
+                    if (::poll(fds.data(), fds.size(), (int)resto) < 0 && errno != EINTR){
+                        return;
+                    }
+                    for (size_t k = 0; k < fds.size(); k++){
+                        if (fds[k].revents == 0){
+                            continue;
+                        }
+                        auto it = conexiones.find(ids[k]);
+                        if (!escribir(it->second)){
+                            ::close(it->second.fd);
+                            conexiones.erase(it);
+                        }
+                    }
+                }
+            }
+
+            /** @brief Pasa las respuestas de los trabajadores a las conexiones */
+            void recibir_respuestas(){
+                char buffer[256];
+                while (::read(tuberia[0], buffer, sizeof(buffer)) > 0){
+                }
+                vector<respuesta> listas;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_respuestas);
+                    listas.swap(respuestas);
+                }
+                en_curso -= listas.size();
+                for (respuesta &r : listas){
+                    auto it = conexiones.find(r.conexion);
+                    if (it != conexiones.end()){
+                        it->second.salida.insert(it->second.salida.end(), r.trama.begin(), r.trama.end());
+                    }
+                    registrar(r.op, r.llegada);
+                }
+            }
+
+            void registrar(uint16_t op, reloj::time_point llegada){
+                uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(reloj::now() - llegada).count();
+                std::lock_guard<std::mutex> lock(mutex_latencias);
+                latencias[op < N_OPERACIONES ? op : 0].agregar(ns);
+            }
+
+            void responder_en_linea(conexion &c, const tarea &t){
+                encabezado enc = t.enc;
+                enc.resultado = (uint32_t)estado::ok;
+                enc.longitud = 0;
+                agregar(c.salida, enc);
+                registrar(t.enc.op, t.llegada);
+            }
+
+            /** @brief Ciclo de cada trabajador */
+            void trabajar(){
+                // Los temporales de los ajustes de este trabajador; se reutilizan entre peticiones
+                util::arena arena;
+                while (true){
+                    tarea t;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex_tareas);
+                        hay_tareas.wait(lock, [this]{ return terminar || !tareas.empty(); });
+                        if (terminar){
+                            return;
+                        }
+                        t = std::move(tareas.front());
+                        tareas.pop_front();
+                    }
+
+                    respuesta r{t.conexion, t.enc.op, {}, t.llegada};
+                    encabezado enc = t.enc;
+                    vector<char> cuerpo;
+                    try {
+                        util::usar_temporales uso(arena);
+                        enc.resultado = (uint32_t)atender((operacion)t.enc.op, t.cuerpo, cuerpo);
+                    } catch (const std::exception &e) {
+                        enc.resultado = (uint32_t)estado::error;
+                        cuerpo.assign(e.what(), e.what() + std::strlen(e.what()));
+                    }
+                    arena.reiniciar();
+                    enc.longitud = cuerpo.size();
+                    r.trama.reserve(sizeof(enc) + cuerpo.size());
+                    agregar(r.trama, enc);
+                    r.trama.insert(r.trama.end(), cuerpo.begin(), cuerpo.end());
+
+                    {
+                        std::lock_guard<std::mutex> lock(mutex_respuestas);
+                        respuestas.push_back(std::move(r));
+                    }
+                    despertar();
+                }
+            }
+
+            /**
+             * @brief Atiende una peticion
+             * @param op Operacion
+             * @param peticion Cuerpo de la peticion
+             * @param cuerpo Salida: cuerpo de la respuesta
+            */
+            estado atender(operacion op, const vector<char> &peticion, vector<char> &cuerpo){
+                cursor cur(peticion);
+                switch (op){
+                    case operacion::cargar: {
+                        uint64_t clave = cur.leer<uint64_t>();
+                        metodo m = (metodo)cur.leer<uint32_t>();
+                        cur.leer<uint32_t>();
+                        uint64_t n = cur.leer<uint64_t>();
+                        if (n > cur.resto().size() / (2 * sizeof(double))){
+                            throw invalid_argument("Cuerpo de la trama demasiado corto");
+                        }
+                        vector<double> x(n), y(n);
+                        cur.leer(x);
+                        cur.leer(y);
+                        guardar(clave, m, std::move(x), std::move(y));
+                        return estado::ok;
+                    }
+                    case operacion::cargar_archivo: {
+                        uint64_t clave = cur.leer<uint64_t>();
+                        metodo m = (metodo)cur.leer<uint32_t>();
+                        cur.leer<uint32_t>();
+                        span<const char> resto = cur.resto();
+                        vector<double> x, y;
+                        lote::leer_datos(string(resto.begin(), resto.end()), x, y);
+                        guardar(clave, m, std::move(x), std::move(y));
+                        return estado::ok;
+                    }
+                    case operacion::evaluar: {
+                        uint64_t clave = cur.leer<uint64_t>();
+                        uint64_t m = cur.leer<uint64_t>();
+                        if (m != cur.resto().size() / sizeof(double)){
+                            throw invalid_argument("La cantidad de valores no coincide con el cuerpo");
+                        }
+                        std::shared_ptr<const modelo_cargado> modelo = buscar(clave);
+                        if (!modelo){
+                            return estado::no_encontrado;
+                        }
+                        vector<double> q(m), r(m);
+                        cur.leer(q);
+                        modelo->evaluar(q, r);
+                        agregar(cuerpo, span<const double>(r));
+                        return estado::ok;
+                    }
+                    case operacion::descartar: {
+                        uint64_t clave = cur.leer<uint64_t>();
+                        std::unique_lock<std::shared_mutex> lock(mutex_cache);
+                        return cache.erase(clave) > 0 ? estado::ok : estado::no_encontrado;
+                    }
+                    case operacion::estadisticas: {
+                        std::lock_guard<std::mutex> lock(mutex_latencias);
+                        for (uint16_t o = 1; o < N_OPERACIONES; o++){
+                            agregar(cuerpo, latencias[o].resumen(o));
+                        }
+                        return estado::ok;
+                    }
+                    default:
+                        throw invalid_argument("Operacion desconocida");
+                }
+            }
+
+            void guardar(uint64_t clave, metodo m, vector<double> &&x, vector<double> &&y){
+                size_t n = x.size();
+                auto modelo = std::make_shared<const modelo_cargado>(
+                    modelo_cargado{m, n, lote::crear_evaluador(nombre_metodo(m), std::move(x), std::move(y), &ajustes)});
+                std::unique_lock<std::shared_mutex> lock(mutex_cache);
+                cache[clave] = std::move(modelo);
+            }
+
+            std::shared_ptr<const modelo_cargado> buscar(uint64_t clave){
+                std::shared_lock<std::shared_mutex> lock(mutex_cache);
+                auto it = cache.find(clave);
+                return it == cache.end() ? nullptr : it->second;
+            }
+    };
+
+    /**
+     * @brief Cliente bloqueante del servidor local
+    */
+    class cliente_local {
+        public:
+            /**
+             * @brief Se conecta al servidor
+             * @param ruta Ruta del socket
+            */
+            explicit cliente_local(const string &ruta){
+                sockaddr_un dir{};
+                if (ruta.size() >= sizeof(dir.sun_path)){
+                    throw invalid_argument("Ruta del socket demasiado larga: " + ruta);
+                }
+                fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+                dir.sun_family = AF_UNIX;
+                std::memcpy(dir.sun_path, ruta.c_str(), ruta.size() + 1);
+                if (fd < 0 || ::connect(fd, (sockaddr *)&dir, sizeof(dir)) != 0){
+                    if (fd >= 0){
+                        ::close(fd);
+                    }
+                    throw runtime_error("No se pudo conectar a " + ruta);
+                }
+            }
+
+            cliente_local(const cliente_local &) = delete;
+            cliente_local &operator=(const cliente_local &) = delete;
+
+            ~cliente_local(){
+                ::close(fd);
+            }
+
+            /**
+             * @brief Envia una peticion sin esperar la respuesta
+             * @return Identificador de la peticion
+            */
+            uint32_t enviar(operacion op, span<const char> cuerpo){
+                encabezado enc;
+                enc.op = (uint16_t)op;
+                enc.id = siguiente_id++;
+                enc.longitud = cuerpo.size();
+                escribir_todo(&enc, sizeof(enc));
+                escribir_todo(cuerpo.data(), cuerpo.size());
+                return enc.id;
+            }
+
+            /**
+             * @brief Espera la siguiente respuesta
+             * @param cuerpo Salida: cuerpo de la respuesta
+             * @return Encabezado de la respuesta
+            */
+            encabezado recibir(vector<char> &cuerpo){
+                encabezado enc;
+                leer_todo(&enc, sizeof(enc));
+                if (enc.magia != MAGIA || enc.longitud > LONGITUD_MAXIMA){
+                    throw runtime_error("Respuesta invalida del servidor");
+                }
+                cuerpo.resize(enc.longitud);
+                leer_todo(cuerpo.data(), cuerpo.size());
+                return enc;
+            }
+
+            /**
+             * @brief Ajusta un modelo en el servidor y lo guarda con la clave dada
+            */
+            void cargar(uint64_t clave, metodo m, span<const double> x, span<const double> y){
+                if (x.size() != y.size()){
+                    throw invalid_argument("x e y deben tener el mismo tamano");
+                }
+                vector<char> cuerpo;
+                agregar(cuerpo, clave);
+                agregar(cuerpo, (uint32_t)m);
+                agregar(cuerpo, (uint32_t)0);
+                agregar(cuerpo, (uint64_t)x.size());
+                agregar(cuerpo, x);
+                agregar(cuerpo, y);
+                esperar(enviar(operacion::cargar, cuerpo));
+            }
+
+            /**
+             * @brief Ajusta en el servidor un modelo leido de un archivo del servidor
+            */
+            void cargar_archivo(uint64_t clave, metodo m, const string &ruta){
+                vector<char> cuerpo;
+                agregar(cuerpo, clave);
+                agregar(cuerpo, (uint32_t)m);
+                agregar(cuerpo, (uint32_t)0);
+                cuerpo.insert(cuerpo.end(), ruta.begin(), ruta.end());
+                esperar(enviar(operacion::cargar_archivo, cuerpo));
+            }
+
+            /**
+             * @brief Cuerpo de una peticion de evaluacion
+            */
+            static vector<char> peticion_evaluar(uint64_t clave, span<const double> x){
+                vector<char> cuerpo;
+                cuerpo.reserve(16 + x.size_bytes());
+                agregar(cuerpo, clave);
+                agregar(cuerpo, (uint64_t)x.size());
+                agregar(cuerpo, x);
+                return cuerpo;
+            }
+
+            /**
+             * @brief Evalua el modelo de la clave en x
+             * @param y Salida, del mismo tamaño que x
+            */
+            void evaluar(uint64_t clave, span<const double> x, span<double> y){
+                vector<char> cuerpo = esperar(enviar(operacion::evaluar, peticion_evaluar(clave, x)));
+                if (cuerpo.size() != y.size_bytes()){
+                    throw runtime_error("Respuesta de evaluacion con tamano inesperado");
+                }
+                std::memcpy(y.data(), cuerpo.data(), cuerpo.size());
+            }
+
+            /**
+             * @brief Latencias del servidor por operacion
+            */
+            vector<estadistica> estadisticas(){
+                vector<char> cuerpo = esperar(enviar(operacion::estadisticas, {}));
+                vector<estadistica> res(cuerpo.size() / sizeof(estadistica));
+                std::memcpy(res.data(), cuerpo.data(), res.size() * sizeof(estadistica));
+                return res;
+            }
+
+            /**
+             * @brief Pide al servidor que termine
+            */
+            void detener(){
+                esperar(enviar(operacion::detener, {}));
+            }
+
+        private:
+            int fd = -1; /*!< Socket conectado */
+            uint32_t siguiente_id = 1; /*!< Identificador de la proxima peticion */
+
+            vector<char> esperar(uint32_t id){
+                vector<char> cuerpo;
+                encabezado enc = recibir(cuerpo);
+                if (enc.id != id){
+                    throw runtime_error("Respuesta fuera de orden");
+                }
+                if (enc.resultado != (uint32_t)estado::ok){
+                    string mensaje = (enc.resultado == (uint32_t)estado::no_encontrado)
+                                         ? "Clave no encontrada" : string(cuerpo.begin(), cuerpo.end());
+                    throw runtime_error(mensaje);
+                }
+                return cuerpo;
+            }
+
+            void escribir_todo(const void *datos, size_t n){
+                const char *p = (const char *)datos;
+                while (n > 0){
+                    ssize_t r = ::send(fd, p, n, SIN_SENAL);
+                    if (r < 0 && errno == EINTR){
+                        continue;
+                    }
+                    if (r <= 0){
+                        throw runtime_error("Se perdio la conexion con el servidor");
+                    }
+                    p += r;
+                    n -= r;
+                }
+            }
+
+            void leer_todo(void *datos, size_t n){
+                char *p = (char *)datos;
+                while (n > 0){
+                    ssize_t r = ::read(fd, p, n);
+                    if (r < 0 && errno == EINTR){
+                        continue;
+                    }
+                    if (r <= 0){
+                        throw runtime_error("Se perdio la conexion con el servidor");
+                    }
+                    p += r;
+                    n -= r;
+                }
+            }
+    };
+}
+
+#endif
+
+#endif
@@ -0,0 +1,175 @@
+/**
+ * @file
+ * @brief Solucion en lote de muchos sistemas lineales pequeños
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Los N sistemas de k x k se almacenan intercalados (estructura de
+ * arreglos): el elemento (i, j) del sistema s esta en a[(i * k + j) * N + s]
+ * y el lado derecho i en b[i * N + s]. Asi cada operacion de la eliminacion
+ * se aplica a posiciones contiguas de muchos sistemas a la vez, y el
+ * compilador la convierte en instrucciones SIMD (un sistema por carril).
+ * El pivoteo parcial tambien se hace por carril, con selecciones en lugar
+ * de saltos. Compilar con -O3 -fno-trapping-math, como vectorial.h.
+*/
+
+#ifndef SISTEMAS_H
+#define SISTEMAS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+using std::size_t;
+using std::span;
+using std::vector;
+using std::invalid_argument;
+
+namespace util {
+
+    /**
+     * @brief Resuelve N sistemas de k x k intercalados con eliminacion de Gauss y pivoteo parcial
+     * @param k Orden de cada sistema
+     * @param n_sistemas Cantidad de sistemas N
+     * @param a Matrices intercaladas, k * k * N elementos; se sobrescriben
+     * @param b Lados derechos intercalados, k * N elementos; al terminar contienen las soluciones
+     *
+     * Un sistema singular produce inf o NaN solo en su propio carril.
+    */
+    inline void resolver_lote(size_t k, size_t n_sistemas, span<double> a, span<double> b){
+        if (a.size() != k * k * n_sistemas || b.size() != k * n_sistemas){
+            throw invalid_argument("Tamano invalido de los sistemas intercalados");
+        }
+        const size_t N = n_sistemas;
+        const size_t CARRILES = 64; // Sistemas por bloque, para que el bloque quede en cache L1
+        double *pa = a.data();
+        double *pb = b.data();
+
+        for (size_t s0 = 0; s0 < N; s0 += CARRILES){
+            const size_t s1 = std::min(N, s0 + CARRILES);
+            double pivote[CARRILES]; // Fila del pivote de cada carril, como double
+            double maximo[CARRILES];
+
+            for (size_t c = 0; c < k; c++){
+                // Buscar en cada carril la fila con el mayor |a(r, c)|, r >= c
+                const double *columna_c = pa + (c * k + c) * N;
+                for (size_t s = s0; s < s1; s++){
+                    pivote[s - s0] = (double)c;
+                    maximo[s - s0] = std::fabs(columna_c[s]);
+                }
+                for (size_t r = c + 1; r < k; r++){
+                    const double *fila_r = pa + (r * k + c) * N;
+                    const double fila = (double)r;
+                    for (size_t s = s0; s < s1; s++){
+                        double v = std::fabs(fila_r[s]);
+                        bool mayor = v > maximo[s - s0];
+                        maximo[s - s0] = mayor ? v : maximo[s - s0];
+                        pivote[s - s0] = mayor ? fila : pivote[s - s0];
+                    }
+                }
+
+                // Intercambiar la fila c con la fila del pivote en cada carril
+                for (size_t r = c + 1; r < k; r++){
+                    const double fila = (double)r;
+                    for (size_t j = c; j < k; j++){
+                        double *ac = pa + (c * k + j) * N;
+                        double *ar = pa + (r * k + j) * N;
+                        for (size_t s = s0; s < s1; s++){
+                            bool cambiar = pivote[s - s0] == fila;
+                            double vc = ac[s];
+                            double vr = ar[s];
+                            ac[s] = cambiar ? vr : vc;
+                            ar[s] = cambiar ? vc : vr;
+                        }
+                    }
+                    double *bc = pb + c * N;
+                    double *br = pb + r * N;
+                    for (size_t s = s0; s < s1; s++){
+                        bool cambiar = pivote[s - s0] == fila;
+                        double vc = bc[s];
+                        double vr = br[s];
+                        bc[s] = cambiar ? vr : vc;
+                        br[s] = cambiar ? vc : vr;
+                    }
+                }
+
+                // Eliminar la columna c en las filas inferiores
+                const double *diagonal = pa + (c * k + c) * N;
+                for (size_t r = c + 1; r < k; r++){
+                    double factor[CARRILES];
+                    double *ar_c = pa + (r * k + c) * N;
+                    for (size_t s = s0; s < s1; s++){
+                        factor[s - s0] = ar_c[s] / diagonal[s];
+                        ar_c[s] = 0.0;
+                    }
+                    for (size_t j = c + 1; j < k; j++){
+                        const double *ac = pa + (c * k + j) * N;
+                        double *ar = pa + (r * k + j) * N;
+                        for (size_t s = s0; s < s1; s++){
+                            ar[s] -= factor[s - s0] * ac[s];
+                        }
+                    }
+                    const double *bc = pb + c * N;
+                    double *br = pb + r * N;
+                    for (size_t s = s0; s < s1; s++){
+                        br[s] -= factor[s - s0] * bc[s];
+                    }
+                }
+            }
+
+            // Sustitucion hacia atras
+            for (size_t i = k; i-- > 0;){
+                double *bi = pb + i * N;
+                for (size_t j = i + 1; j < k; j++){
+                    const double *aij = pa + (i * k + j) * N;
+                    const double *bj = pb + j * N;
+                    for (size_t s = s0; s < s1; s++){
+                        bi[s] -= aij[s] * bj[s];
+                    }
+                }
+                const double *aii = pa + (i * k + i) * N;
+                for (size_t s = s0; s < s1; s++){
+                    bi[s] /= aii[s];
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Conjunto de N sistemas de k x k almacenados intercalados
+    */
+    struct sistemas_lote {
+        size_t k; /*!< Orden de cada sistema */
+        size_t n; /*!< Cantidad de sistemas */
+        vector<double> a; /*!< Matrices intercaladas */
+        vector<double> b; /*!< Lados derechos intercalados; soluciones despues de resolver */
+
+        /**
+         * @brief Reserva N sistemas de k x k en cero
+         * @param p_k Orden de cada sistema
+         * @param p_n Cantidad de sistemas
+         */
+        sistemas_lote(size_t p_k, size_t p_n) : k(p_k), n(p_n), a(p_k * p_k * p_n, 0.0), b(p_k * p_n, 0.0){
+        }
+
+        /** @brief Elemento (i, j) de la matriz del sistema s */
+        double &matriz(size_t s, size_t i, size_t j){
+            return a[(i * k + j) * n + s];
+        }
+
+        /** @brief Elemento i del lado derecho (o de la solucion) del sistema s */
+        double &derecho(size_t s, size_t i){
+            return b[i * n + s];
+        }
+
+        /** @brief Resuelve todos los sistemas */
+        void resolver(){
+            resolver_lote(k, n, a, b);
+        }
+    };
+}
+
+#endif
@@ -2,70 +2,353 @@
 #define SPLINE3_H
 
 #include "util.h"
+#include "datos.h"
+#include "instrumentacion.h"
 
+#include <algorithm>
 #include <cmath>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 using std::vector;
-using util::gauss;
+using std::span;
+using std::invalid_argument;
 
 namespace interpolacion {
-    class spline3 {
+
+    namespace detalle {
+
+        /**
+         * @brief Intervalo de xk a partir del intervalo de un valor anterior
+         * @param x Variable independiente, creciente, con al menos 2 datos
+         * @param xk Valor dentro del rango de los datos
+         * @param i Intervalo anterior, en [1, n - 1]
+         * @return Primer i >= 1 con xk <= x[i], como en spline3::interpolar
+        */
+        template <typename T>
+        size_t ubicar(span<const T> x, T xk, size_t i){
+            const size_t PASOS = 4; // Intervalos que se recorren uno a uno antes de galopar
+            const size_t n = x.size();
+            const T *px = x.data();
+
+            if (xk > px[i]){
+                for (size_t p = 0; p < PASOS && i < n - 1 && xk > px[i]; p++){
+                    i++;
+                }
+                if (xk <= px[i]){
+                    return i;
+                }
+                // xk > x[bajo]: duplicar el salto hasta un alto con xk <= x[alto]
+                CONTAR("interpolacion::ubicar::galopes", 1);
+                size_t bajo = i, alto, salto = 1;
+                while (true){
+                    alto = bajo + salto;
+                    if (alto >= n - 1){
+                        alto = n - 1;
+                        break;
+                    }
+                    if (xk <= px[alto]){
+                        break;
+                    }
+                    bajo = alto;
+                    salto *= 2;
+                }
+                return std::lower_bound(px + bajo + 1, px + alto, xk) - px;
+            }
+
+            if (i > 1 && xk <= px[i - 1]){
+                for (size_t p = 0; p < PASOS && i > 1 && xk <= px[i - 1]; p++){
+                    i--;
+                }
+                if (i == 1 || xk > px[i - 1]){
+                    return i;
+                }
+                // xk <= x[alto]: duplicar el salto hasta un bajo con xk > x[bajo], o el inicio
+                CONTAR("interpolacion::ubicar::galopes", 1);
+                size_t alto = i - 1, bajo, salto = 1;
+                while (true){
+                    if (salto >= alto){
+                        bajo = 0;
+                        break;
+                    }
+                    bajo = alto - salto;
+                    if (xk > px[bajo]){
+                        break;
+                    }
+                    alto = bajo;
+                    salto *= 2;
+                }
+                return std::lower_bound(px + bajo + 1, px + alto, xk) - px;
+            }
+            return i;
+        }
+    }
+
+    /**
+     * @brief Interpolacion mediante trazadores cubicos
+     *
+     * Las segundas derivadas siempre se calculan en double; T es el tipo en
+     * que se guardan los datos y se evalua. Con float se lee la mitad de
+     * memoria por valor y el compilador procesa el doble de valores por
+     * instruccion SIMD. Un trazador en float tambien se puede crear a partir
+     * de uno ajustado en double (ajustar en double, evaluar en float).
+     *
+     * @tparam T double o float
+    */
+    template <typename T>
+    class basic_spline3 {
         public: 
+            using datos = util::basic_datos<T>; /*!< Arreglo de T propio o prestado */
 
             /**
              * @brief Crea una instancia de interpolacion mediante trazadores cubicos
              * @param p_x Variable independiente
              * @param p_y Variable dependiente
-             */
-            spline3(vector <double> p_x,
-                    vector <double> p_y): x(p_x), y(p_y){
-                    // Calcular las segundas derivadas
-                    f2 = calcular_f2(); 
+             * @note Copia x e y (una asignacion de memoria por arreglo)
+            */
+            basic_spline3(span<const T> p_x, span<const T> p_y):x(p_x), y(p_y){
+                // Calcular las segundas derivadas
+                f2 = datos(util::convertir<T>(calcular_f2()));
+            }
+
+            /**
+             * @brief Crea una instancia de interpolacion mediante trazadores cubicos, moviendo los vectores sin copiarlos
+             * @param p_x Variable independiente
+             * @param p_y Variable dependiente
+             * @note No asigna memoria para x e y
+            */
+            basic_spline3(vector<T> &&p_x, vector<T> &&p_y):x(std::move(p_x)), y(std::move(p_y)){
+                // Calcular las segundas derivadas
+                f2 = datos(util::convertir<T>(calcular_f2()));
+            }
+
+            /**
+             * @brief Crea una instancia de interpolacion mediante trazadores cubicos, tomando prestados los datos
+             * @param p_x Variable independiente; debe existir mientras exista la instancia
+             * @param p_y Variable dependiente; debe existir mientras exista la instancia
+             * @note No copia x ni y ni asigna memoria para ellos
+            */
+            basic_spline3(util::prestado_t, span<const T> p_x, span<const T> p_y):x(util::prestado, p_x), y(util::prestado, p_y){
+                // Calcular las segundas derivadas
+                f2 = datos(util::convertir<T>(calcular_f2()));
+            }
+
+            /**
+             * @brief Crea una instancia con las segundas derivadas ya calculadas, sin resolver el sistema
+             * @param p_x Variable independiente
+             * @param p_y Variable dependiente
+             * @param p_f2 Segundas derivadas en cada dato (ver segundas_derivadas()), propias o prestadas
+            */
+            basic_spline3(vector<T> &&p_x, vector<T> &&p_y, datos p_f2):x(std::move(p_x)), y(std::move(p_y)), f2(std::move(p_f2)){
+                validar_f2();
+            }
+
+            /**
+             * @brief Crea una instancia con las segundas derivadas ya calculadas, tomando prestados los datos
+             * @param p_x Variable independiente; debe existir mientras exista la instancia
+             * @param p_y Variable dependiente; debe existir mientras exista la instancia
+             * @param p_f2 Segundas derivadas en cada dato (ver segundas_derivadas()), propias o prestadas
+             *
+             * Con f2 tambien prestado, por ejemplo de un archivo mapeado en memoria
+             * (ver binario.h), crear el trazador no copia nada.
+            */
+            basic_spline3(util::prestado_t, span<const T> p_x, span<const T> p_y, datos p_f2):x(util::prestado, p_x), y(util::prestado, p_y), f2(std::move(p_f2)){
+                validar_f2();
+            }
+
+            /**
+             * @brief Copia un trazador ya ajustado convirtiendo sus datos a T, sin volver a ajustarlo
+             * @param otro Trazador ajustado, por ejemplo en double para evaluarlo en float
+            */
+            template <typename U>
+            explicit basic_spline3(const basic_spline3<U> &otro)
+                : x(util::convertir<T>(otro.datos_x())), y(util::convertir<T>(otro.datos_y())),
+                  f2(util::convertir<T>(otro.segundas_derivadas())){
+            }
+
+            /**
+             * @brief Segundas derivadas del trazador en cada dato: el estado ajustado
+            */
+            span<const T> segundas_derivadas() const {
+                return f2;
+            }
+
+            /** @brief Variable independiente */
+            span<const T> datos_x() const {
+                return x;
+            }
+
+            /** @brief Variable dependiente */
+            span<const T> datos_y() const {
+                return y;
+            }
+
+            /**
+             * @brief Coeficientes c0..c3 del polinomio de cada intervalo en t = x - x[i - 1], en double
+             * @return 4 (n - 1) coeficientes; los del intervalo [x[i - 1], x[i]] empiezan en 4 (i - 1)
+            */
+            vector<double> coeficientes() const {
+                vector<double> c(4 * (x.size() - 1));
+                coeficientes(c);
+                return c;
+            }
+
+            /**
+             * @brief Escribe los coeficientes de cada intervalo (ver coeficientes()) sobre un arreglo dado
+             * @param c Salida de 4 (n - 1) elementos
+            */
+            void coeficientes(span<double> c) const {
+                const size_t n = x.size();
+                if (c.size() != 4 * (n - 1)){
+                    throw invalid_argument("Se necesitan 4 coeficientes por intervalo");
+                }
+                for (size_t i = 1; i < n; i++){
+                    coeficientes_intervalo(x[i] - x[i - 1], y[i - 1], y[i], f2[i - 1], f2[i], c.data() + 4 * (i - 1));
+                }
+            }
+
+            /**
+             * @brief Coeficientes c0..c3 de un intervalo en t = x - x[i - 1], a partir de (18.36)
+             * @param h Ancho del intervalo
+             * @param y0 Valor en el extremo izquierdo
+             * @param y1 Valor en el extremo derecho
+             * @param f0 Segunda derivada en el extremo izquierdo
+             * @param f1 Segunda derivada en el extremo derecho
+             * @param c Salida: 4 coeficientes
+            */
+            static void coeficientes_intervalo(double h, double y0, double y1, double f0, double f1, double *c){
+                c[0] = y0;
+                c[1] = (y1 - y0) / h - h * (2.0 * f0 + f1) / 6.0;
+                c[2] = f0 / 2.0;
+                c[3] = (f1 - f0) / (6.0 * h);
+            }
+
+            /**
+             * @brief Arma el sistema tridiagonal de las segundas derivadas interiores del trazador natural
+             * @param nodos Variable independiente, con al menos 3 datos
+             * @param inferior Salida: subdiagonal, n - 2 elementos; inferior[0] no se usa
+             * @param diagonal Salida: diagonal, n - 2 elementos
+             * @param superior Salida: superdiagonal, n - 2 elementos; el ultimo no se usa
+             *
+             * Solo depende de x: con la malla fija el sistema se puede factorizar
+             * una vez (util::factorizacion_tridiagonal) para varios y.
+            */
+            static void sistema_f2(span<const T> nodos, span<double> inferior, span<double> diagonal, span<double> superior){
+                for (size_t i = 1; i + 1 < nodos.size(); i++){
+                    const double x_ant = nodos[i - 1], x_i = nodos[i], x_sig = nodos[i + 1];
+                    inferior[i - 1] = (x_i - x_ant);
+                    diagonal[i - 1] = 2.0 * (x_sig - x_ant);
+                    superior[i - 1] = (x_sig - x_i);
+                }
+            }
+
+            /**
+             * @brief Lado derecho de la ecuacion del punto interior i del sistema de las segundas derivadas
+            */
+            static double lado_derecho_f2(double x_ant, double x_i, double x_sig, double y_ant, double y_i, double y_sig){
+                double ci_1 = (6/(x_sig - x_i)) * (y_sig - y_i);
+                double ci_2 = (6/(x_i - x_ant)) * (y_ant - y_i);
+                return ci_1 + ci_2;
             }
             
             /**
              * @brief Evaluar el polinomio del trazador cúbico en x_int
              * @param x_int Punto a evaluar
              * @return Valor interpolado en x_int
+             *
+             * El intervalo se busca por biseccion, O(log n); para muchas
+             * consultas seguidas conviene evaluar() o un cursor.
             */
-            double interpolar(double x_int){
-                
-                int i = 0; 
-                int n = x.size(); /*!< Numero de datos*/
-                int intervalos = n - 1; /*!< Numero de intervalos*/
+            T interpolar(T x_int) const {
+                const size_t n = x.size(); /*!< Numero de datos*/
+                const T *px = x.data();
 
                 // Verificar que x_int esté dentro del rango de los datos
-                if (x_int < x[0]) {
-                    // x_int está por debajo del rango de los datos
-                    return NAN;
-                }
-                if (x_int > x[n-1]) {
-                    // x_int está por encima del rango de los datos
+                if (!(x_int >= px[0] && x_int <= px[n - 1])) {
                     return NAN;
                 }
 
-                // Determinar el intervalo i en donde se encuentra x_int
-                for (i = 1; i < intervalos; i++){
-                    if (x_int >= x[i - 1] && x_int <= x[i]){
-                        break;
-                    }
-                }
-
-                // Evaluar el polinomio del trazador en x_int (18.36)
+                // Determinar el intervalo i en donde se encuentra x_int: primer i >= 1 con x_int <= x[i]
+                size_t i = std::max<size_t>(1, std::lower_bound(px + 1, px + n - 1, x_int) - px);
 
-                double h = x[i] - x[i - 1];
+                return polinomio(i, x_int);
+            }
 
-                double a = ((f2[i - 1] / (6.0f * h)) * (pow(x[i] - x_int, 3.0f))) + ((f2[i] / (6.0f * h)) * (pow(x_int - x[i - 1], 3.0f)));
+            /**
+             * @brief Interpola un lote de valores, NaN fuera del rango de los datos
+             * @param x_int Valores de x a interpolar
+             * @param y_int Salida: valores interpolados, del mismo tamaño que x_int
+             *
+             * El intervalo de cada valor se busca a partir del intervalo del valor
+             * anterior (ver cursor). Con x_int ordenado el costo por valor es O(1)
+             * amortizado.
+            */
+            void evaluar(span<const T> x_int, span<T> y_int) const {
+                MEDIR("spline3::evaluar");
+                CONTAR("spline3::evaluar::valores", x_int.size());
+                if (x_int.size() != y_int.size()){
+                    throw invalid_argument("x_int e y_int deben tener el mismo tamano");
+                }
+                cursor c(*this);
+                for (size_t k = 0; k < x_int.size(); k++){
+                    y_int[k] = c(x_int[k]);
+                }
+            }
 
-                double b = ((y[i - 1] / h) - ((f2[i - 1] * h) / 6.0f)) * (x[i] - x_int);
+            /**
+             * @brief Evalua el trazador en una secuencia de valores recordando el ultimo intervalo
+             *
+             * interpolar() busca el intervalo por biseccion en cada llamada. El
+             * cursor parte del intervalo del valor anterior: avanza o retrocede unos
+             * pocos intervalos y, si el salto es mayor, duplica el paso (busqueda
+             * galopante) y termina con una busqueda binaria. Un recorrido ordenado o
+             * casi ordenado (graficar, remuestrear, integrar) cuesta O(1) amortizado
+             * por valor, y un salto de d intervalos O(log d).
+             *
+             * El trazador debe existir mientras exista el cursor. Cada hilo usa su
+             * propio cursor.
+            */
+            class cursor {
+                public:
+                    /**
+                     * @brief Crea un cursor en el primer intervalo
+                     * @param p_trazador Trazador a evaluar
+                    */
+                    explicit cursor(const basic_spline3 &p_trazador) : trazador(&p_trazador){
+                    }
 
-                double c = ((y[i] / h) - ((f2[i] * h) / 6.0f)) * (x_int - x[i - 1]);
+                    /**
+                     * @brief Valor del trazador en x_int
+                     * @param x_int Punto a evaluar
+                     * @return Valor interpolado, NaN fuera del rango de los datos
+                    */
+                    T operator()(T x_int){
+                        const size_t n = trazador->x.size();
+                        if (n < 2 || !(x_int >= trazador->x[0] && x_int <= trazador->x[n - 1])){
+                            return NAN;
+                        }
+                        i = trazador->ubicar(x_int, i);
+                        return trazador->polinomio(i, x_int);
+                    }
 
-                double resultado = a + b + c;
+                    /** @brief Intervalo [x[i - 1], x[i]] del ultimo valor dentro del rango */
+                    size_t intervalo() const {
+                        return i;
+                    }
 
-                return resultado;
+                private:
+                    const basic_spline3 *trazador; /*!< Trazador que se evalua */
+                    size_t i = 1; /*!< Ultimo intervalo */
+            };
 
+            /**
+             * @brief Crea un cursor para evaluar el trazador en una secuencia de valores
+            */
+            cursor crear_cursor() const {
+                return cursor(*this);
             }
 
             /**
@@ -73,7 +356,7 @@ namespace interpolacion {
              * @param x_int Punto a evaluar
              * @return Vector de coeficientes del polinomio
             */
-            vector <double> interpolar_trazador(double x_int){
+            vector <T> interpolar_trazador(T x_int){
                 
                 int i = 0;
                 int n = x.size(); /*!< Numero de datos*/
@@ -88,17 +371,17 @@ namespace interpolacion {
 
                 // Evaluar el polinomio del trazador en x_int (18.36)
 
-                double h = x[i] - x[i - 1];
+                T h = x[i] - x[i - 1];
 
-                double a1 = ((f2[i - 1] / (6.0f * h)));
+                T a1 = ((f2[i - 1] / (T(6) * h)));
 
-                double a2 = ((f2[i] / (6.0f * h)));
+                T a2 = ((f2[i] / (T(6) * h)));
 
-                double b = ((y[i - 1] / h) - ((f2[i - 1] * h) / 6.0f));
+                T b = ((y[i - 1] / h) - ((f2[i - 1] * h) / T(6)));
 
-                double c = ((y[i] / h) - ((f2[i] * h) / 6.0f));
+                T c = ((y[i] / h) - ((f2[i] * h) / T(6)));
 
-                vector <double> coeficientes;
+                vector <T> coeficientes;
 
                 coeficientes.push_back(a1);
                 coeficientes.push_back(a2);
@@ -108,10 +391,10 @@ namespace interpolacion {
                 cout << "\nEcuacion del Trazador Cubico en el intervalo [" << x[i - 1] << ", " << x[i] << "]" << endl
                      << "f" << i << "(x) = ";
                   
-                if (a1 != 0.0f){
+                if (a1 != T(0)){
                     cout << ((a1 < 0) ? " - " : "") << fabs(a1) << "*(" << x[i] << " - x)^3";
                 }
-                if (a2 != 0.0f){
+                if (a2 != T(0)){
                     cout << ((a2 < 0) ? " - " : " + ") << fabs(a2) << "*(x - " << x[i - 1] << ")^3";
                 }
 
@@ -127,10 +410,10 @@ namespace interpolacion {
              * @param x_inicial Punto inicial del intervalo
              * @param x_final Punto final del intervalo
             */
-            void trazadores(double x_inicial, double x_final){
+            void trazadores(T x_inicial, T x_final){
 
                 int n = x.size(); /*!< Numero de datos*/
-                vector <double> coeficientes;
+                vector <T> coeficientes;
                 int intervalos = n - 1; /*!< Numero de intervalos*/
 
                 cout << "\nSegundas Derivadas: " << endl;
@@ -153,68 +436,70 @@ namespace interpolacion {
             }
                             
         private:
-            vector <double> x; /*!< Variable independiente */
-            vector <double> y; /*!< Variable dependiente */
-            vector <double> f2; /*!< Vector de coeficientes */
-            vector <double> calcular_f2(){
-            
-            vector <double> resultado;
-
-            size_t n = x.size();
-            size_t intervalos = n - 1;
-            size_t i;
+            datos x; /*!< Variable independiente */
+            datos y; /*!< Variable dependiente */
+            datos f2; /*!< Segundas derivadas en cada dato */
 
-            vector <vector <double>> m(intervalos - 1);
-            for (i = 0; i < intervalos - 1; i++){
-                m[i].resize(n);
+            /**
+             * @brief Intervalo de xk a partir del intervalo de un valor anterior (ver detalle::ubicar)
+            */
+            size_t ubicar(T xk, size_t i) const {
+                return detalle::ubicar(span<const T>(x), xk, i);
             }
 
-            for ( i = 1; i < intervalos; i++ ){
+            /**
+             * @brief Evalua el polinomio del intervalo [x[i - 1], x[i]] en xk, por Horner en t = xk - x[i - 1]
+            */
+            T polinomio(size_t i, T xk) const {
+                double c[4];
+                coeficientes_intervalo((double)x[i] - (double)x[i - 1], y[i - 1], y[i], f2[i - 1], f2[i], c);
+                double t = (double)xk - (double)x[i - 1];
+                return (T)(c[0] + t * (c[1] + t * (c[2] + t * c[3])));
+            }
 
-                size_t fila = i - 1;
+            /** @brief Verifica que las segundas derivadas recibidas correspondan a los datos */
+            void validar_f2() const {
+                if (x.size() != y.size() || f2.size() != x.size()){
+                    throw invalid_argument("Se necesita una segunda derivada por dato");
+                }
+            }
 
-                // * Primer coeficiente
-                if (i > 1) {
-                    // Los puntos interiores tienen f''(xi-1)
-                    m[fila][i - 1] = (x[i] - x[i - 1]);
-                };
-                
-                // * Segundo coeficiente
-                m[fila][i] = 2.0f * (x[i + 1] - x[i - 1]);
-
-                // * Tercer coeficiente
-                if (i < intervalos - 1){
-                    // Los puntos interiores tienen f''(xi+1)
-                    m[fila][i + 1] = (x[i + 1] - x[i]);
-                };
-                
-                double ci_1 = (6/(x[i + 1] - x[i])) * (y[i + 1] - y[i]);
-                double ci_2 = (6/(x[i] - x[i - 1])) * (y[i - 1] - y[i]);
-                double ci = ci_1 + ci_2;
-                m[fila][intervalos] = ci;
-                
-            };
+            vector <double> calcular_f2(){
+            MEDIR("spline3::calcular_f2");
 
-            // Eliminar los 0 al comienzo de las filas de la matriz
-            for (i = 0; i < intervalos - 1; i++){
-                m[i].erase(m[i].begin());
+            size_t n = x.size();
+            if (n < 2){
+                throw invalid_argument("Se necesitan al menos dos datos");
             }
+            size_t intervalos = n - 1;
+            size_t incognitas = intervalos - 1; // f'' en los puntos interiores
+            size_t i;
 
-            resultado = gauss(m);
+            // Segundas derivadas: 0 en los extremos; el sistema se resuelve sobre los puntos interiores
+            vector <double> c(n, 0.0);
 
-            vector <double> c;
+            // El sistema es tridiagonal: solo sus tres diagonales, tomadas de los temporales del hilo.
+            // Se arma y se resuelve en double aunque los datos sean float
+            std::pmr::vector <double> inferior(incognitas, 0.0, util::temporales());
+            std::pmr::vector <double> diagonal(incognitas, 0.0, util::temporales());
+            std::pmr::vector <double> superior(incognitas, 0.0, util::temporales());
+            sistema_f2(x, inferior, diagonal, superior);
 
-            c.push_back(0);
+            for ( i = 1; i < intervalos; i++ ){
+                c[i] = lado_derecho_f2(x[i - 1], x[i], x[i + 1], y[i - 1], y[i], y[i + 1]);
+            };
 
-            for (i = 0; i < resultado.size(); i++){
-                c.push_back(resultado[i]);
+            {
+                MEDIR("spline3::calcular_f2::tridiagonal");
+                util::resolver_tridiagonal(inferior, diagonal, superior, span<double>(c.data() + 1, incognitas));
             }
 
-            c.push_back(0);
-
             return c;
         };
     };
+
+    using spline3 = basic_spline3<double>; /*!< Trazador cubico en double */
+    using spline3_f = basic_spline3<float>; /*!< Trazador cubico en float, ajustado en double */
 }
 
 #endif
\ No newline at end of file
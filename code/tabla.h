@@ -0,0 +1,341 @@
+/**
+ * @file
+ * @brief Escritura de tablas y reportes en texto, CSV o JSON por bloques
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * El texto se arma en un bloque que se reutiliza y se escribe al archivo
+ * cuando se llena, en lugar de una escritura por celda. Los reales se
+ * convierten con std::to_chars, sin crear cadenas ni depender del locale.
+*/
+
+#ifndef TABLA_H
+#define TABLA_H
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using std::size_t;
+using std::span;
+using std::string;
+using std::string_view;
+using std::vector;
+using std::invalid_argument;
+
+namespace util {
+
+    /**
+     * @brief Formato de salida de tablas y reportes
+    */
+    enum class formato {
+        texto, /*!< Tabla alineada para leerla en la consola */
+        csv, /*!< Valores separados por comas, con encabezado */
+        json /*!< Objeto JSON; NaN e infinito se escriben como null */
+    };
+
+    /**
+     * @brief Interpreta el nombre de un formato
+     * @param nombre texto, csv o json
+    */
+    inline formato formato_desde(string_view nombre){
+        if (nombre == "texto"){
+            return formato::texto;
+        }
+        if (nombre == "csv"){
+            return formato::csv;
+        }
+        if (nombre == "json"){
+            return formato::json;
+        }
+        throw invalid_argument("Formato desconocido: " + string(nombre));
+    }
+
+    /**
+     * @brief Escritor de texto con un bloque reutilizable
+    */
+    class escritor_texto {
+        public:
+            /**
+             * @brief Crea un escritor sobre un archivo abierto; no lo cierra
+             * @param p_archivo Archivo de salida
+             * @param capacidad Tamaño del bloque de escritura en bytes
+            */
+            explicit escritor_texto(FILE *p_archivo = stdout, size_t capacidad = 1 << 20)
+                : archivo(p_archivo), bloque(std::max<size_t>(capacidad, 64)){
+            }
+
+            escritor_texto(const escritor_texto &) = delete;
+            escritor_texto &operator=(const escritor_texto &) = delete;
+
+            ~escritor_texto(){
+                vaciar();
+            }
+
+            /**
+             * @brief Escribe texto
+            */
+            escritor_texto &texto(string_view s){
+                if (s.size() > bloque.size() - usado){
+                    vaciar();
+                    if (s.size() > bloque.size()){
+                        std::fwrite(s.data(), 1, s.size(), archivo);
+                        return *this;
+                    }
+                }
+                std::memcpy(bloque.data() + usado, s.data(), s.size());
+                usado += s.size();
+                return *this;
+            }
+
+            /**
+             * @brief Escribe un caracter repetido
+            */
+            escritor_texto &caracter(char c, size_t veces = 1){
+                while (veces > 0){
+                    size_t k = std::min(veces, bloque.size() - usado);
+                    std::memset(bloque.data() + usado, c, k);
+                    usado += k;
+                    veces -= k;
+                    if (usado == bloque.size()){
+                        vaciar();
+                    }
+                }
+                return *this;
+            }
+
+            /**
+             * @brief Escribe un real en la representacion mas corta que se lee de vuelta igual
+            */
+            escritor_texto &real(double v){
+                char *inicio = reservar(32);
+                usado += std::to_chars(inicio, inicio + 32, v).ptr - inicio;
+                return *this;
+            }
+
+            /**
+             * @brief Escribe un real con la precision dada, como printf("%g")
+            */
+            escritor_texto &real(double v, int precision){
+                char *inicio = reservar(32 + (size_t)precision);
+                usado += std::to_chars(inicio, inicio + 32 + precision, v, std::chars_format::general, precision).ptr - inicio;
+                return *this;
+            }
+
+            /**
+             * @brief Escribe un entero sin signo
+            */
+            escritor_texto &entero(std::uint64_t v){
+                char *inicio = reservar(24);
+                usado += std::to_chars(inicio, inicio + 24, v).ptr - inicio;
+                return *this;
+            }
+
+            /**
+             * @brief Escribe un real para JSON: la representacion mas corta, o null si no es finito
+            */
+            escritor_texto &real_json(double v){
+                return std::isfinite(v) ? real(v) : texto("null");
+            }
+
+            /**
+             * @brief Escribe una cadena JSON entre comillas, escapando los caracteres especiales
+            */
+            escritor_texto &cadena_json(string_view s){
+                caracter('"');
+                for (char c : s){
+                    if (c == '"' || c == '\\'){
+                        caracter('\\').caracter(c);
+                    } else if ((unsigned char)c < 0x20){
+                        char codigo[7];
+                        std::snprintf(codigo, sizeof(codigo), "\\u%04x", (unsigned)c);
+                        texto(codigo);
+                    } else {
+                        caracter(c);
+                    }
+                }
+                return caracter('"');
+            }
+
+            /**
+             * @brief Escribe un campo CSV (RFC 4180): entre comillas, con las comillas duplicadas, si
+             *        contiene una coma, comillas o un salto de linea; si no, tal cual
+            */
+            escritor_texto &cadena_csv(string_view s){
+                if (s.find_first_of(",\"\r\n") == string_view::npos){
+                    return texto(s);
+                }
+                caracter('"');
+                for (char c : s){
+                    if (c == '"'){
+                        caracter('"');
+                    }
+                    caracter(c);
+                }
+                return caracter('"');
+            }
+
+            /**
+             * @brief Escribe texto completado con espacios hasta el ancho dado
+             * @param s Texto
+             * @param ancho Ancho minimo
+             * @param derecha true para alinear a la derecha
+            */
+            escritor_texto &alineado(string_view s, size_t ancho, bool derecha){
+                size_t relleno = (s.size() < ancho) ? ancho - s.size() : 0;
+                if (derecha){
+                    caracter(' ', relleno);
+                }
+                texto(s);
+                if (!derecha){
+                    caracter(' ', relleno);
+                }
+                return *this;
+            }
+
+            /**
+             * @brief Escribe en el archivo lo que haya en el bloque
+            */
+            void vaciar(){
+                if (usado > 0){
+                    std::fwrite(bloque.data(), 1, usado, archivo);
+                    usado = 0;
+                }
+            }
+
+        private:
+            FILE *archivo; /*!< Archivo de salida */
+            vector<char> bloque; /*!< Texto pendiente de escribir */
+            size_t usado = 0; /*!< Bytes ocupados del bloque */
+
+            /** @brief Garantiza n bytes libres en el bloque y retorna el primero */
+            char *reservar(size_t n){
+                if (bloque.size() - usado < n){
+                    vaciar();
+                    if (bloque.size() < n){
+                        bloque.resize(n);
+                    }
+                }
+                return bloque.data() + usado;
+            }
+    };
+
+    /**
+     * @brief Formatea un real como lo hace cout por defecto (precision 6)
+     * @param v Valor
+     * @param buffer Espacio para el texto
+     * @return Texto formateado, dentro de buffer
+    */
+    inline string_view formatear_corto(double v, char (&buffer)[32]){
+        auto [ptr, ec] = std::to_chars(buffer, buffer + sizeof(buffer), v, std::chars_format::general, 6);
+        return string_view(buffer, ptr - buffer);
+    }
+
+    /**
+     * @brief Escribe una tabla de dos columnas
+     * @param salida Escritor
+     * @param x Variable independiente
+     * @param y Variable dependiente
+     * @param x_label Etiqueta de la variable independiente; X si esta vacia
+     * @param y_label Etiqueta de la variable dependiente; Y si esta vacia
+     * @param f Formato. En texto los valores se escriben con 6 cifras y centrados
+     *          bajo su etiqueta; en CSV y JSON, en la representacion mas corta
+     *          que se lee de vuelta igual y con las etiquetas sin espacios alrededor;
+     *          en CSV las etiquetas se citan como indica RFC 4180 (ver cadena_csv)
+    */
+    inline void escribir_tabla(escritor_texto &salida, span<const double> x, span<const double> y,
+                               string_view x_label = "", string_view y_label = "", formato f = formato::texto){
+        if (x.size() != y.size()){
+            throw invalid_argument("x e y deben tener el mismo tamano");
+        }
+        if (x_label.empty()){
+            x_label = "X";
+        }
+        if (y_label.empty()){
+            y_label = "Y";
+        }
+
+        if (f != formato::texto){
+            auto recortar = [](string_view s){
+                size_t a = s.find_first_not_of(' ');
+                return (a == string_view::npos) ? string_view() : s.substr(a, s.find_last_not_of(' ') - a + 1);
+            };
+            x_label = recortar(x_label);
+            y_label = recortar(y_label);
+        }
+
+        if (f == formato::csv){
+            salida.cadena_csv(x_label).caracter(',').cadena_csv(y_label).caracter('\n');
+            for (size_t i = 0; i < x.size(); i++){
+                salida.real(x[i]).caracter(',').real(y[i]).caracter('\n');
+            }
+            return;
+        }
+        if (f == formato::json){
+            salida.caracter('{').cadena_json(x_label).texto(": [");
+            for (size_t i = 0; i < x.size(); i++){
+                (i > 0 ? salida.texto(", ") : salida).real_json(x[i]);
+            }
+            salida.texto("], ").cadena_json(y_label).texto(": [");
+            for (size_t i = 0; i < y.size(); i++){
+                (i > 0 ? salida.texto(", ") : salida).real_json(y[i]);
+            }
+            salida.texto("]}\n");
+            return;
+        }
+
+        const size_t x_width = x_label.size() + 4;
+        const size_t y_width = y_label.size() + 4;
+        const size_t total = x_width + y_width + 2;
+
+        // Ancho para centrar un valor bajo la etiqueta segun las cifras de su parte entera
+        auto centrado = [](size_t ancho, double v){
+            char cifras[320];
+            double t = std::trunc(v);
+            auto [ptr, ec] = (std::fabs(t) < 1e18)
+                           ? std::to_chars(cifras, cifras + sizeof(cifras), (long long)t)
+                           : std::to_chars(cifras, cifras + sizeof(cifras), t, std::chars_format::fixed, 0);
+            size_t largo = (ec == std::errc()) ? (size_t)(ptr - cifras) : ancho;
+            return (largo < ancho) ? (ancho - largo) / 2 + largo : largo;
+        };
+
+        salida.caracter('\n').caracter('=', total).caracter('\n');
+        salida.texto("  ").alineado(x_label, x_width, false).alineado(y_label, y_width / 4, true).caracter('\n');
+        salida.caracter('=', total).caracter('\n');
+        char bx[32], by[32];
+        for (size_t i = 0; i < x.size(); i++){
+            size_t x_space = centrado(x_width, x[i]);
+            size_t y_space = centrado(y_width, y[i]);
+            string_view sx = formatear_corto(x[i], bx);
+            string_view sy = formatear_corto(y[i], by);
+            // y termina en la misma columna aunque x no quepa en su ancho, con al menos un espacio entre ambos
+            size_t ocupado = std::max(sx.size(), x_space + 1);
+            size_t fin_y = x_width + y_space + 3;
+            salida.alineado(sx, x_space + 1, true);
+            salida.alineado(sy, std::max(fin_y > ocupado ? fin_y - ocupado : 0, sy.size() + 1), true);
+            salida.caracter('\n');
+        }
+        salida.caracter('=', total).texto("\n\n");
+    }
+
+    /**
+     * @brief Escribe una tabla de dos columnas en un archivo
+     * @param archivo Archivo de salida; por defecto la salida estandar
+     * @see escribir_tabla(escritor_texto &, span<const double>, span<const double>, string_view, string_view, formato)
+    */
+    inline void escribir_tabla(span<const double> x, span<const double> y, string_view x_label = "",
+                               string_view y_label = "", formato f = formato::texto, FILE *archivo = stdout){
+        escritor_texto salida(archivo);
+        escribir_tabla(salida, x, y, x_label, y_label, f);
+    }
+}
+
+#endif
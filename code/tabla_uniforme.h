@@ -0,0 +1,253 @@
+/**
+ * @file
+ * @brief Trazador cubico compilado en una tabla de malla uniforme con cota de error
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Evaluar un trazador exige buscar el intervalo de cada valor. La tabla
+ * divide el rango de los datos en celdas iguales de ancho H y guarda en
+ * cada una el polinomio de Hermite cubico con los valores y las primeras
+ * derivadas del trazador en sus extremos. Evaluar es calcular el indice de
+ * la celda y un Horner de grado 3, sin busqueda ni saltos.
+ *
+ * El trazador es un polinomio cubico en cada intervalo, que Hermite
+ * reproduce exactamente; el error solo aparece en las celdas que contienen
+ * un dato interior x_j, donde la tercera derivada salta J_j. Hermite de
+ * (J/6) (x - x_j)^3_+ sobre una celda de ancho H se aleja a lo sumo
+ * (J/6) H^3 / 32 (en el centro, con x_j en el centro), de modo que
+ *
+ *     |tabla - trazador| <= H^3 / 192 * max_celda (suma de |J_j| de la celda)
+ *
+ * sin contar el redondeo, del orden de 1e-16 veces los valores de y.
+*/
+
+#ifndef TABLA_UNIFORME_H
+#define TABLA_UNIFORME_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "instrumentacion.h"
+#include "spline3.h"
+
+using std::size_t;
+using std::span;
+using std::vector;
+using std::invalid_argument;
+
+namespace interpolacion {
+
+    /**
+     * @brief Tamaño y error de una tabla con cierta cantidad de celdas
+    */
+    struct costo_tabla {
+        size_t celdas = 0; /*!< Celdas de la malla uniforme */
+        size_t bytes = 0; /*!< Memoria de los coeficientes */
+        double cota_error = NAN; /*!< Cota del error respecto al trazador */
+    };
+
+    /**
+     * @brief Trazador cubico evaluado por celdas de una malla uniforme
+    */
+    class tabla_uniforme {
+        public:
+            /**
+             * @brief Tabla con la cantidad de celdas dada
+             * @param s Trazador ajustado, con al menos 2 datos
+             * @param p_celdas Celdas de la malla uniforme
+            */
+            tabla_uniforme(const spline3 &s, size_t p_celdas){
+                construir(s, p_celdas);
+            }
+
+            /**
+             * @brief Valor de la tabla en x_int
+             * @param x_int Punto a evaluar
+             * @return Valor interpolado, NaN fuera del rango de los datos
+            */
+            double interpolar(double x_int) const {
+                bool dentro = (x_int >= x_min) && (x_int <= x_max);
+                double u = dentro ? (x_int - x_min) * inverso_h : 0.0;
+                double k = std::min(std::floor(u), (double)(n_celdas - 1));
+                double t = u - k;
+                const double *c = coef.data() + 4 * (size_t)k;
+                double v = c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+                return dentro ? v : NAN;
+            }
+
+            /**
+             * @brief Interpola un lote de valores, NaN fuera del rango de los datos
+             * @param x_int Valores de x a interpolar
+             * @param y_int Salida: valores interpolados, del mismo tamaño que x_int
+            */
+            void evaluar(span<const double> x_int, span<double> y_int) const {
+                MEDIR("tabla_uniforme::evaluar");
+                if (x_int.size() != y_int.size()){
+                    throw invalid_argument("x_int e y_int deben tener el mismo tamano");
+                }
+                for (size_t k = 0; k < x_int.size(); k++){
+                    y_int[k] = interpolar(x_int[k]);
+                }
+            }
+
+            /** @brief Celdas de la malla */
+            size_t celdas() const {
+                return n_celdas;
+            }
+
+            /** @brief Memoria de los coeficientes */
+            size_t bytes() const {
+                return coef.size() * sizeof(double);
+            }
+
+            /** @brief Cota del error respecto al trazador del que se compilo */
+            double cota_error() const {
+                return cota;
+            }
+
+            /**
+             * @brief Cota del error de una tabla de celdas celdas, sin construirla, en O(n)
+             * @param s Trazador ajustado, con al menos 2 datos
+             * @param celdas Celdas de la malla uniforme
+            */
+            static double cota_error(const spline3 &s, size_t celdas){
+                span<const double> x = s.datos_x();
+                span<const double> f2 = s.segundas_derivadas();
+                const size_t n = x.size();
+                validar(n, celdas);
+                const double h = (x[n - 1] - x[0]) / (double)celdas;
+
+                // Suma de los saltos de la tercera derivada por celda; los datos estan ordenados
+                double maximo = 0.0, suma = 0.0;
+                size_t celda_actual = 0;
+                for (size_t j = 1; j + 1 < n; j++){
+                    double salto = std::fabs((f2[j + 1] - f2[j]) / (x[j + 1] - x[j]) - (f2[j] - f2[j - 1]) / (x[j] - x[j - 1]));
+                    size_t celda = std::min((size_t)((x[j] - x[0]) / h), celdas - 1);
+                    if (celda != celda_actual){
+                        suma = 0.0;
+                        celda_actual = celda;
+                    }
+                    suma += salto;
+                    maximo = std::max(maximo, suma);
+                }
+                return maximo * h * h * h / 192.0;
+            }
+
+            /**
+             * @brief Tamaño y cota de error de tablas de 1, 2, 4, ... celdas hasta celdas_max
+             * @param s Trazador ajustado, con al menos 2 datos
+             * @param celdas_max Celdas de la tabla mas grande
+            */
+            static vector<costo_tabla> compromiso(const spline3 &s, size_t celdas_max = 1 << 20){
+                vector<costo_tabla> resultado;
+                for (size_t celdas = 1; celdas <= celdas_max; celdas *= 2){
+                    resultado.push_back(costo_tabla{celdas, 4 * celdas * sizeof(double), cota_error(s, celdas)});
+                }
+                return resultado;
+            }
+
+        private:
+            double x_min = 0.0; /*!< Primer dato */
+            double x_max = 0.0; /*!< Ultimo dato */
+            double inverso_h = 0.0; /*!< 1 / ancho de celda */
+            size_t n_celdas = 0; /*!< Celdas de la malla */
+            double cota = NAN; /*!< Cota del error */
+            vector<double> coef; /*!< a0..a3 de cada celda en t = (x - inicio de la celda) / H */
+
+            static void validar(size_t n, size_t celdas){
+                if (n < 2){
+                    throw invalid_argument("Se necesitan al menos 2 datos para compilar el trazador");
+                }
+                if (celdas == 0){
+                    throw invalid_argument("La tabla necesita al menos una celda");
+                }
+            }
+
+            void construir(const spline3 &s, size_t celdas){
+                MEDIR("tabla_uniforme::construir");
+                span<const double> x = s.datos_x();
+                const size_t n = x.size();
+                validar(n, celdas);
+                const vector<double> polinomios = s.coeficientes();
+
+                x_min = x[0];
+                x_max = x[n - 1];
+                n_celdas = celdas;
+                const double h = (x_max - x_min) / (double)celdas;
+                inverso_h = (double)celdas / (x_max - x_min);
+                cota = cota_error(s, celdas);
+                coef.assign(4 * celdas, 0.0);
+
+                // Valor y derivada del trazador en cada nodo, recorriendo los intervalos a la par
+                size_t i = 1;
+                double v_ant = 0.0, d_ant = 0.0;
+                for (size_t k = 0; k <= celdas; k++){
+                    double xk = (k == celdas) ? x_max : x_min + h * (double)k;
+                    while (i < n - 1 && xk > x[i]){
+                        i++;
+                    }
+                    double t = xk - x[i - 1];
+                    const double *p = polinomios.data() + 4 * (i - 1);
+                    double v = p[0] + t * (p[1] + t * (p[2] + t * p[3]));
+                    double d = (p[1] + t * (2.0 * p[2] + t * 3.0 * p[3])) * h; // Derivada respecto a t de la celda
+
+                    if (k > 0){
+                        double *c = coef.data() + 4 * (k - 1);
+                        c[0] = v_ant;
+                        c[1] = d_ant;
+                        c[2] = 3.0 * (v - v_ant) - 2.0 * d_ant - d;
+                        c[3] = 2.0 * (v_ant - v) + d_ant + d;
+                    }
+                    v_ant = v;
+                    d_ant = d;
+                }
+            }
+    };
+
+    /**
+     * @brief Compila un trazador en una tabla uniforme que cumple el error pedido
+     *
+     * La cantidad de celdas queda a menos de 1/64 de la menor que cumple la cota.
+     * @param s Trazador ajustado, con al menos 2 datos
+     * @param error_maximo Error maximo respecto al trazador, positivo
+     * @param celdas_max Celdas de la tabla mas grande que se acepta
+     * @return Tabla con cota_error() <= error_maximo
+    */
+    inline tabla_uniforme compilar(const spline3 &s, double error_maximo, size_t celdas_max = 1 << 24){
+        MEDIR("tabla_uniforme::compilar");
+        if (!(error_maximo > 0.0)){
+            throw invalid_argument("El error maximo debe ser positivo");
+        }
+        // La cota decrece al menos como H^3: se corrige la cantidad de celdas con la raiz
+        // cubica de la razon hasta cumplir, y luego se biseca entre la ultima que no cumplia y esta
+        size_t no_cumple = 0, celdas = 1;
+        while (true){
+            double cota = tabla_uniforme::cota_error(s, celdas);
+            if (cota <= error_maximo){
+                break;
+            }
+            if (celdas >= celdas_max){
+                throw invalid_argument("El error pedido necesita mas de " + std::to_string(celdas_max) + " celdas");
+            }
+            no_cumple = celdas;
+            double factor = std::max(1.25, std::cbrt(cota / error_maximo));
+            celdas = (size_t)std::min((double)celdas_max, std::ceil((double)celdas * factor));
+        }
+        while (celdas - no_cumple > std::max<size_t>(1, celdas / 64)){
+            size_t medio = no_cumple + (celdas - no_cumple) / 2;
+            if (tabla_uniforme::cota_error(s, medio) <= error_maximo){
+                celdas = medio;
+            } else {
+                no_cumple = medio;
+            }
+        }
+        return tabla_uniforme(s, celdas);
+    }
+}
+
+#endif
@@ -8,10 +8,18 @@
 #ifndef UTIL_H
 #define UTIL_H
 
+#include <algorithm>
 #include <iostream>
 #include <iomanip>
+#include <memory_resource>
 #include <string>
 #include <vector>
+#include <cmath>
+#include <span>
+
+#include "algebra.h"
+#include "instrumentacion.h"
+#include "tabla.h"
 
 using std::setprecision;
 using std::setw;
@@ -20,106 +28,92 @@ using std::right;
 using std::endl;
 using std::string;
 using std::vector;
+using std::span;
 using std::to_string;
 using std::cout;
 
 namespace util{
     /**
-     * @brief Repite una cadena de caracteres
-     * @param s Cadena a repetir
-     * @param n Cantidad de repeteciones
-     * @return Concatenacion de s n veces
-    */
-    string str_repeat(string s, int n){
-        string ret = "";
-        for(int i = 0; i < n; i++){
-            ret += s;
-        }
-        return ret;
-    }
-
-    int getCenteredWidth(size_t label_length, int value) {
-        size_t value_length = to_string(value).length();
-        return (label_length - value_length) / 2 + value_length;
-    }
-    /**
-     * Imprime una tabla de datos
-     * @param X  variable independiente
-     * @param y variable dependiente
+     * Imprime una tabla de datos en la salida estandar
+     * @param x Variable independiente
+     * @param y Variable dependiente
      * @param x_label Etiqueta de la variable independiente
      * @param y_label Etiqueta de la variable dependiente
+     * @see escribir_tabla, para escribirla en CSV o JSON o en otro archivo
      */
-    void imprimir_tabla(vector<double> x, vector<double> y, string x_label = "", string y_label = "") {
-
-        if (x_label.empty()) {
-            x_label = "X";
-        }
-
-        if (y_label.empty()) {
-            y_label = "Y";
-        }
-
-        size_t x_width = x_label.length() + 4;
-        size_t y_width = y_label.length() + 4;
-
-        cout << "\n";
-        cout << str_repeat("=", x_width + y_width + 2) << endl;
-
-        cout << "  " << setw(x_width) << left << x_label << setw(y_width/4) << right << y_label << endl;
-
-        cout << str_repeat("=", x_width + y_width + 2) << endl;
-
-        for (size_t i = 0; i < x.size(); i++) {
-            int x_space = getCenteredWidth(x_width, x[i]);
-            int y_space = getCenteredWidth(y_width, y[i]);
-
-            cout << setw(x_space + 1) << right << x[i] << setw(x_width - x_space + y_space + 2) << right << y[i] << endl;
-        }
-        cout << str_repeat("=", x_width + y_width + 2) << endl;
-        cout << "\n";
+    inline void imprimir_tabla(span<const double> x, span<const double> y, string_view x_label = "", string_view y_label = "") {
+        cout.flush();
+        escribir_tabla(x, y, x_label, y_label, formato::texto, stdout);
+    }
 
+        /**
+         * @brief Eliminacion de Gauss con pivoteo parcial para una matriz de reales
+         * @param m Matriz aumentada de reales [A | b]
+         * @return vector<double> Vector de coeficientes (NaN si A es singular)
+         * @note La copia de A se toma de util::temporales()
+        */
+        inline vector<double> gauss(const vector<vector<double>> &m) {
+            MEDIR("util::gauss");
+            size_t n = m.size();
+            std::pmr::vector<double> a(n * n, temporales());
+            vector<double> resultado(n);
+            for (size_t i = 0; i < n; i++) {
+                std::copy(m[i].begin(), m[i].begin() + n, a.begin() + i * n);
+                resultado[i] = m[i][n];
+            }
+
+            if (!resolver_en_sitio(a, n, resultado)) {
+                return vector<double>(n, NAN);
+            }
+            return resultado;
         }
 
         /**
-         * @brief Eliminacion de Gauss para una matriz de reales
-         * @param m Matriz de reales
-         * @return vector<double> Vector de coeficientes
+         * @brief Resuelve un sistema simetrico definido positivo mediante Cholesky (A = L * Lt)
+         * @param a Matriz n x n por filas; al terminar contiene L en su triangulo inferior
+         * @param b Lado derecho; al terminar contiene la solucion
+         * @param n Orden del sistema
+         * @return false si la matriz no es definida positiva
         */
-        vector<double> gauss(vector<vector<double>> m) {
-        int i, j, k;
-        int n = m.size();
-        vector<double> resultado(n);
-        //pivoteo: Para cada fila i, buscar en la columna i el valor mayor
-        //e intercambiar la fila i por la que contenga el valor mayor.
-        for (i = 0; i < n - 1; i++) {
-        for (j = i + 1; j < n; j++) {
-        if (m[i][j] > m[i][i]) {
-        std::swap(m[i], m[j]);
-        }
-        }
-        }
-        //Eliminacion gaussiana
-        for (i = 0; i < n; i++) {
-        for (j = i + 1; j < n; j++) {
-        double v = m[j][i] / m[i][i]; //Valor que anula el elemento en la columna
-        //Hacer la operacion fila[j] = fila[j] - v * fila[i]
-        for(k=0; k <= n; k++) {
-        m[j][k] -= v * m[i][k];
-        }
-        }
-        }
-        //Despejar las variables
-        for (i= n - 1; i >= 0; i--) {
-        resultado[i] = m[i][n];
-        //reemplazar las variables ya halladas
-        for (j = i + 1; j < n; j++) {
-        if (i != j) { //reeemplazar las variables, menos el coeficiente
-        resultado[i] = resultado[i] - m[i][j] * resultado[j];
-        }
-        }
-        resultado[i] = resultado[i] / m[i][i];
-        }
-        return resultado;
+        inline bool resolver_cholesky(vector<double> &a, vector<double> &b, size_t n) {
+            size_t i, j, k;
+
+            //Factorizar A = L * Lt
+            for (j = 0; j < n; j++) {
+                double d = a[j * n + j];
+                for (k = 0; k < j; k++) {
+                    d -= a[j * n + k] * a[j * n + k];
+                }
+                if (!(d > 0.0)) {
+                    return false;
+                }
+                d = sqrt(d);
+                a[j * n + j] = d;
+                for (i = j + 1; i < n; i++) {
+                    double v = a[i * n + j];
+                    for (k = 0; k < j; k++) {
+                        v -= a[i * n + k] * a[j * n + k];
+                    }
+                    a[i * n + j] = v / d;
+                }
+            }
+
+            //Sustitucion hacia adelante: L * z = b
+            for (i = 0; i < n; i++) {
+                for (k = 0; k < i; k++) {
+                    b[i] -= a[i * n + k] * b[k];
+                }
+                b[i] /= a[i * n + i];
+            }
+
+            //Sustitucion hacia atras: Lt * x = z
+            for (i = n; i-- > 0;) {
+                for (k = i + 1; k < n; k++) {
+                    b[i] -= a[k * n + i] * b[k];
+                }
+                b[i] /= a[i * n + i];
+            }
+            return true;
         }
 }
 
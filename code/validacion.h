@@ -0,0 +1,270 @@
+/**
+ * @file
+ * @brief Validacion cruzada dejando uno fuera (LOOCV) en forma cerrada
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Ninguna funcion reajusta el modelo n veces. Para los minimos cuadrados el
+ * residuo dejando fuera el dato i es e_i / (1 - h_ii), con h_ii la diagonal
+ * de la matriz sombrero. Para el trazador cubico natural el residuo es
+ * (K y)_i / K_ii, con K = Q R^-1 Qt la matriz de penalizacion de la
+ * curvatura (Green y Silverman): el trazador por los n - 1 datos restantes
+ * es el que minimiza yt K y dejando libre el valor en x_i.
+*/
+
+#ifndef VALIDACION_H
+#define VALIDACION_H
+
+#include <cmath>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "regresion.h"
+
+using std::cout;
+using std::endl;
+using std::span;
+using std::vector;
+using std::invalid_argument;
+
+namespace validacion {
+
+    /**
+     * @brief Resultado de la validacion cruzada dejando uno fuera
+    */
+    struct resultado_loocv{
+        vector<double> residuos; /*!< y_i menos la prediccion del modelo ajustado sin el dato i */
+        double press = 0.0; /*!< Suma de los residuos al cuadrado (PRESS) */
+        double rmse = 0.0; /*!< Raiz del error cuadratico medio */
+
+        /**
+         * @brief Imprimir el resultado
+         */
+        void imprimir(){
+            cout << "Validacion cruzada dejando uno fuera" << endl
+                 << "PRESS: " << press << endl
+                 << "RMSE: " << rmse << endl;
+        }
+    };
+
+    /**
+     * @brief Valida que x e y tengan el mismo tamaño y al menos minimo datos
+    */
+    inline void validar(span<const double> x, span<const double> y, size_t minimo){
+        if (x.size() != y.size()){
+            throw invalid_argument("x e y deben tener el mismo tamano");
+        }
+        if (x.size() < minimo){
+            throw invalid_argument("Datos insuficientes para la validacion cruzada");
+        }
+    }
+
+    /**
+     * @brief Calcula PRESS y RMSE a partir de los residuos
+    */
+    inline void resumir(resultado_loocv &res){
+        res.press = 0.0;
+        for (double e : res.residuos){
+            res.press += e * e;
+        }
+        res.rmse = sqrt(res.press / (double)res.residuos.size());
+    }
+
+    /**
+     * @brief LOOCV de la regresion lineal simple, h_ii = 1/n + (x_i - x_prom)^2 / Sxx
+     * @param x Variable independiente
+     * @param y Variable dependiente
+     * @return Residuos dejando uno fuera
+    */
+    inline resultado_loocv lineal(span<const double> x, span<const double> y){
+        validar(x, y, 3);
+        size_t n = x.size();
+
+        regresion::acumulador acc;
+        for (size_t i = 0; i < n; i++){
+            acc.agregar(x[i], y[i]);
+        }
+        regresion::solucion_lineal sol = acc.lineal();
+
+        double x_prom = acc.origen_x + acc.sum_x / acc.n;
+        double sxx = 0.0;
+        for (size_t i = 0; i < n; i++){
+            sxx += (x[i] - x_prom) * (x[i] - x_prom);
+        }
+
+        resultado_loocv res;
+        res.residuos.resize(n);
+        for (size_t i = 0; i < n; i++){
+            double h = 1.0 / (double)n + (x[i] - x_prom) * (x[i] - x_prom) / sxx;
+            double e = y[i] - (sol.b0 + sol.b1 * x[i]);
+            res.residuos[i] = e / (1.0 - h);
+        }
+        resumir(res);
+        return res;
+    }
+
+    /**
+     * @brief LOOCV de la regresion cuadratica, h_ii = zt (Zt Z)^-1 z con z = [1, u, u^2]
+     * @param x Variable independiente
+     * @param y Variable dependiente
+     * @return Residuos dejando uno fuera
+     *
+     * Se trabaja con u = x - x[0] y v = y - y[0], el origen del acumulador,
+     * que generan el mismo espacio de columnas y mejoran el condicionamiento
+     * de Zt Z.
+    */
+    inline resultado_loocv cuadratica(span<const double> x, span<const double> y){
+        validar(x, y, 4);
+        size_t n = x.size();
+
+        regresion::acumulador acc;
+        for (size_t i = 0; i < n; i++){
+            acc.agregar(x[i], y[i]);
+        }
+
+        // Inversa de la matriz simetrica Zt Z mediante cofactores
+        double a = acc.n, b = acc.sum_x, c = acc.sum_x2;
+        double d = acc.sum_x2, e = acc.sum_x3, f = acc.sum_x4;
+        // | a b c |
+        // | b d e |
+        // | c e f |
+        double c00 = d * f - e * e;
+        double c01 = c * e - b * f;
+        double c02 = b * e - c * d;
+        double c11 = a * f - c * c;
+        double c12 = b * c - a * e;
+        double c22 = a * d - b * b;
+        double det = a * c00 + b * c01 + c * c02;
+        if (det == 0.0){
+            throw invalid_argument("La matriz de la regresion cuadratica es singular");
+        }
+        double i00 = c00 / det, i01 = c01 / det, i02 = c02 / det;
+        double i11 = c11 / det, i12 = c12 / det, i22 = c22 / det;
+
+        double a0 = i00 * acc.sum_y + i01 * acc.sum_xy + i02 * acc.sum_x2y;
+        double a1 = i01 * acc.sum_y + i11 * acc.sum_xy + i12 * acc.sum_x2y;
+        double a2 = i02 * acc.sum_y + i12 * acc.sum_xy + i22 * acc.sum_x2y;
+
+        resultado_loocv res;
+        res.residuos.resize(n);
+        for (size_t i = 0; i < n; i++){
+            double u = x[i] - acc.origen_x;
+            double u2 = u * u;
+            double h = i00 + 2.0 * i01 * u + (2.0 * i02 + i11) * u2 + 2.0 * i12 * u2 * u + i22 * u2 * u2;
+            double r = (y[i] - acc.origen_y) - (a0 + a1 * u + a2 * u2);
+            res.residuos[i] = r / (1.0 - h);
+        }
+        resumir(res);
+        return res;
+    }
+
+    /**
+     * @brief LOOCV del trazador cubico natural, residuo (K y)_i / K_ii
+     * @param x Variable independiente, ordenada de forma creciente
+     * @param y Variable dependiente
+     * @return Residuos dejando uno fuera
+     *
+     * Para los extremos, el trazador sin el dato se extiende linealmente,
+     * como corresponde a un trazador natural. El costo es O(n): una
+     * factorizacion L D Lt del sistema tridiagonal R de las segundas
+     * derivadas, y la banda de R^-1 que se necesita para K_ii se obtiene
+     * con la recurrencia de Hutchinson y de Hoog.
+    */
+    inline resultado_loocv spline3(span<const double> x, span<const double> y){
+        validar(x, y, 3);
+        size_t n = x.size();
+        size_t m = n - 2; // Segundas derivadas interiores
+
+        vector<double> h(n - 1);
+        for (size_t j = 0; j < n - 1; j++){
+            h[j] = x[j + 1] - x[j];
+        }
+
+        // R (m x m tridiagonal) = L D Lt, L bidiagonal con subdiagonal l
+        vector<double> dd(m), l(m), z(m);
+        for (size_t r = 0; r < m; r++){
+            size_t k = r + 1;
+            double diagonal = (h[k - 1] + h[k]) / 3.0;
+            double qty = (y[k - 1] - y[k]) / h[k - 1] + (y[k + 1] - y[k]) / h[k];
+            if (r > 0){
+                double fuera = h[k - 1] / 6.0;
+                diagonal -= l[r - 1] * fuera;
+                qty -= l[r - 1] * z[r - 1];
+            }
+            dd[r] = diagonal;
+            z[r] = qty;
+            l[r] = (r + 1 < m) ? (h[k] / 6.0) / diagonal : 0.0;
+        }
+
+        // gamma = R^-1 Qt y: segundas derivadas en los nodos, 0 en los extremos
+        vector<double> gamma(n, 0.0);
+        for (size_t r = m; r-- > 0;){
+            double v = z[r] / dd[r];
+            if (r + 1 < m){
+                v -= l[r] * gamma[r + 2];
+            }
+            gamma[r + 1] = v;
+        }
+
+        // Banda de ancho 2 de S = R^-1, indices de nodo (1..n-2)
+        vector<double> s0(n, 0.0), s1(n, 0.0), s2(n, 0.0);
+        for (size_t r = m; r-- > 0;){
+            size_t k = r + 1;
+            if (r + 1 < m){
+                s1[k] = -l[r] * s0[k + 1];
+                s2[k] = (r + 2 < m) ? -l[r] * s1[k + 1] : 0.0;
+                s0[k] = 1.0 / dd[r] - l[r] * s1[k];
+            } else {
+                s0[k] = 1.0 / dd[r];
+            }
+        }
+
+        // S[j][k] para nodos interiores con |j - k| <= 2
+        auto sigma = [&](size_t j, size_t k) -> double {
+            if (j > k){
+                size_t t = j;
+                j = k;
+                k = t;
+            }
+            if (k - j == 0) return s0[j];
+            if (k - j == 1) return s1[j];
+            return s2[j];
+        };
+
+        resultado_loocv res;
+        res.residuos.resize(n);
+        for (size_t i = 0; i < n; i++){
+            // Fila i de Q: columnas (nodos interiores) i - 1, i, i + 1
+            size_t col[3];
+            double q[3];
+            size_t nq = 0;
+            if (i >= 2){
+                col[nq] = i - 1;
+                q[nq++] = 1.0 / h[i - 1];
+            }
+            if (i >= 1 && i + 1 < n){
+                col[nq] = i;
+                q[nq++] = -1.0 / h[i - 1] - 1.0 / h[i];
+            }
+            if (i + 2 < n){
+                col[nq] = i + 1;
+                q[nq++] = 1.0 / h[i];
+            }
+
+            double ky = 0.0, kii = 0.0;
+            for (size_t a = 0; a < nq; a++){
+                ky += q[a] * gamma[col[a]];
+                for (size_t b = 0; b < nq; b++){
+                    kii += q[a] * q[b] * sigma(col[a], col[b]);
+                }
+            }
+            res.residuos[i] = ky / kii;
+        }
+        resumir(res);
+        return res;
+    }
+}
+
+#endif
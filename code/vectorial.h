@@ -0,0 +1,292 @@
+/**
+ * @file
+ * @brief Kernels vectorizables para evaluar modelos sobre lotes de datos
+ * @author Carlos Mario Perdomo Ramos <cmperdomo@unicauca.edu.co>
+ * @author Daniel Fernando Solarte Ortega <dfsolarte@unicauca.edu.co>
+ *
+ * Los kernels procesan los datos en bloques de ANCHO_BLOQUE elementos con
+ * ciclos sin saltos (solo selecciones), de forma que el compilador los
+ * convierta en instrucciones SIMD. Compilar con -O3 -fno-trapping-math
+ * (idealmente con -march=native): sin -fno-trapping-math GCC no convierte en
+ * selecciones las comparaciones de punto flotante de exp y log.
+ * exp y log se calculan con reduccion de rango y polinomios, sin llamar a
+ * la biblioteca matematica, con un error del orden de 1-2 ulp.
+*/
+
+#ifndef VECTORIAL_H
+#define VECTORIAL_H
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+using std::span;
+using std::size_t;
+using std::uint64_t;
+using std::int64_t;
+using std::invalid_argument;
+
+namespace vectorial {
+
+    /** @brief Cantidad de elementos que se procesan por bloque */
+    const size_t ANCHO_BLOQUE = 256;
+
+    /**
+     * @brief Calcula e^x sin saltos
+     * @param x Exponente
+     * @return e^x
+    */
+    inline double exp_kernel(double x){
+        const double LOG2E = 1.4426950408889634;
+        const double LN2_ALTO = 6.93147180369123816490e-01;
+        const double LN2_BAJO = 1.90821492927058770002e-10;
+        const double REDONDEO = 6755399441055744.0; // 1.5 * 2^52
+
+        // Fuera de este rango el resultado se desborda a 0 o a inf de forma natural
+        double xc = std::min(std::max(x, -746.0), 710.0);
+
+        // x = k ln2 + r, |r| <= ln2 / 2
+        double t = xc * LOG2E + REDONDEO;
+        double k = t - REDONDEO;
+        double r = (xc - k * LN2_ALTO) - k * LN2_BAJO;
+
+        // Serie de Taylor de grado 13 evaluada con Horner
+        double p = 1.0 / 6227020800.0;
+        p = p * r + 1.0 / 479001600.0;
+        p = p * r + 1.0 / 39916800.0;
+        p = p * r + 1.0 / 3628800.0;
+        p = p * r + 1.0 / 362880.0;
+        p = p * r + 1.0 / 40320.0;
+        p = p * r + 1.0 / 5040.0;
+        p = p * r + 1.0 / 720.0;
+        p = p * r + 1.0 / 120.0;
+        p = p * r + 1.0 / 24.0;
+        p = p * r + 1.0 / 6.0;
+        p = p * r + 0.5;
+        p = p * r + 1.0;
+        p = p * r + 1.0;
+
+        // 2^k a partir de los bits de t (la mantisa de t contiene a k).
+        // Se aplica en dos mitades para no salirse del rango del exponente.
+        int64_t e = std::bit_cast<int64_t>(t) - std::bit_cast<int64_t>(REDONDEO);
+        int64_t e1 = e >> 1;
+        int64_t e2 = e - e1;
+        double escala1 = std::bit_cast<double>(static_cast<uint64_t>(e1 + 1023) << 52);
+        double escala2 = std::bit_cast<double>(static_cast<uint64_t>(e2 + 1023) << 52);
+
+        double resultado = (p * escala1) * escala2;
+        return (x != x) ? x : resultado;
+    }
+
+    /**
+     * @brief Calcula el logaritmo natural de x sin saltos
+     * @param x Valor positivo
+     * @return ln(x) (-inf para 0, NaN para valores negativos)
+    */
+    inline double log_kernel(double x){
+        const double LN2_ALTO = 6.93147180369123816490e-01;
+        const double LN2_BAJO = 1.90821492927058770002e-10;
+        const double DOS_52 = 4503599627370496.0;
+
+        // Normalizar los subnormales multiplicando por 2^54
+        bool subnormal = x < std::numeric_limits<double>::min();
+        double x_escalado = x * 18014398509481984.0;
+        double xn = subnormal ? x_escalado : x;
+
+        uint64_t bits = std::bit_cast<uint64_t>(xn);
+
+        // Exponente como double sin conversion entera
+        double e = std::bit_cast<double>((bits >> 52) | 0x4330000000000000ULL) - DOS_52 - 1023.0;
+        double e_subnormal = e - 54.0;
+        e = subnormal ? e_subnormal : e;
+
+        // Mantisa en [1, 2), llevada a [sqrt(2)/2, sqrt(2))
+        double m = std::bit_cast<double>((bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL);
+        bool grande = m > 1.4142135623730951;
+        double m_medio = m * 0.5;
+        double e_siguiente = e + 1.0;
+        m = grande ? m_medio : m;
+        e = grande ? e_siguiente : e;
+
+        // ln(m) = 2 atanh(s), s = (m - 1) / (m + 1)
+        double s = (m - 1.0) / (m + 1.0);
+        double s2 = s * s;
+        double p = 1.0 / 21.0;
+        p = p * s2 + 1.0 / 19.0;
+        p = p * s2 + 1.0 / 17.0;
+        p = p * s2 + 1.0 / 15.0;
+        p = p * s2 + 1.0 / 13.0;
+        p = p * s2 + 1.0 / 11.0;
+        p = p * s2 + 1.0 / 9.0;
+        p = p * s2 + 1.0 / 7.0;
+        p = p * s2 + 1.0 / 5.0;
+        p = p * s2 + 1.0 / 3.0;
+        double ln_m = 2.0 * s + 2.0 * s * s2 * p;
+
+        double resultado = e * LN2_ALTO + (ln_m + e * LN2_BAJO);
+        resultado = (x == std::numeric_limits<double>::infinity()) ? x : resultado;
+        resultado = (x == 0.0) ? -std::numeric_limits<double>::infinity() : resultado;
+        return ((x < 0.0) | (x != x)) ? std::numeric_limits<double>::quiet_NaN() : resultado;
+    }
+
+    /**
+     * @brief Valida que la entrada y la salida tengan el mismo tamaño
+    */
+    inline void validar_tamanos(size_t n_entrada, size_t n_salida){
+        if (n_entrada != n_salida){
+            throw invalid_argument("La entrada y la salida deben tener el mismo tamano");
+        }
+    }
+
+    namespace detalle {
+
+        /**
+         * @brief Horner por bloques en el tipo de los datos
+         * @tparam T double o float; en float los coeficientes se redondean a float
+        */
+        template <typename T>
+        void horner(span<const double> coef, span<const T> x, span<T> y){
+            validar_tamanos(x.size(), y.size());
+            if (coef.empty()){
+                for (size_t i = 0; i < y.size(); i++){
+                    y[i] = T(0);
+                }
+                return;
+            }
+            const double *pc = coef.data();
+            const size_t grado = coef.size() - 1;
+            const T *px = x.data();
+            T *py = y.data();
+
+            for (size_t inicio = 0; inicio < x.size(); inicio += ANCHO_BLOQUE){
+                size_t fin = std::min(inicio + ANCHO_BLOQUE, x.size());
+                T bloque[ANCHO_BLOQUE];
+
+                for (size_t i = inicio; i < fin; i++){
+                    bloque[i - inicio] = (T)pc[grado];
+                }
+                for (size_t k = grado; k-- > 0;){
+                    T a = (T)pc[k];
+                    for (size_t i = inicio; i < fin; i++){
+                        bloque[i - inicio] = bloque[i - inicio] * px[i] + a;
+                    }
+                }
+                for (size_t i = inicio; i < fin; i++){
+                    py[i] = bloque[i - inicio];
+                }
+            }
+        }
+
+        /** @brief escala * e^(b0 + b1 * x), calculado en double y guardado en T */
+        template <typename T>
+        void exp_lineal(double b0, double b1, double escala, span<const T> x, span<T> y){
+            validar_tamanos(x.size(), y.size());
+            const T *px = x.data();
+            T *py = y.data();
+            for (size_t i = 0; i < x.size(); i++){
+                py[i] = (T)(escala * exp_kernel(b0 + b1 * (double)px[i]));
+            }
+        }
+
+        /** @brief c * x^a, calculado en double y guardado en T */
+        template <typename T>
+        void potencia(double c, double a, span<const T> x, span<T> y){
+            validar_tamanos(x.size(), y.size());
+            const T *px = x.data();
+            T *py = y.data();
+            for (size_t i = 0; i < x.size(); i++){
+                py[i] = (T)(c * exp_kernel(a * log_kernel((double)px[i])));
+            }
+        }
+
+        /** @brief r = y - r en T */
+        template <typename T>
+        void restar_de(span<const T> y, span<T> r){
+            validar_tamanos(y.size(), r.size());
+            const T *py = y.data();
+            T *pr = r.data();
+            for (size_t i = 0; i < y.size(); i++){
+                pr[i] = py[i] - pr[i];
+            }
+        }
+    }
+
+    /**
+     * @brief Evalua un polinomio con el metodo de Horner sobre un lote
+     * @param coef Coeficientes en orden ascendente a0, a1, ..., ak
+     * @param x Valores de x
+     * @param y Salida, puede ser el mismo arreglo que x
+    */
+    inline void horner(span<const double> coef, span<const double> x, span<double> y){
+        detalle::horner<double>(coef, x, y);
+    }
+
+    /**
+     * @brief Evalua un polinomio con el metodo de Horner sobre un lote en float
+     *
+     * Los coeficientes se redondean a float y el polinomio se evalua en float:
+     * cada bloque procesa el doble de elementos por instruccion SIMD.
+     * @see horner(span<const double>, span<const double>, span<double>)
+    */
+    inline void horner(span<const double> coef, span<const float> x, span<float> y){
+        detalle::horner<float>(coef, x, y);
+    }
+
+    /**
+     * @brief Calcula escala * e^(b0 + b1 * x) sobre un lote
+     * @param b0 Termino independiente del exponente
+     * @param b1 Coeficiente de x en el exponente
+     * @param escala Factor que multiplica el resultado
+     * @param x Valores de x
+     * @param y Salida, puede ser el mismo arreglo que x
+    */
+    inline void exp_lineal(double b0, double b1, double escala, span<const double> x, span<double> y){
+        detalle::exp_lineal<double>(b0, b1, escala, x, y);
+    }
+
+    /**
+     * @brief Calcula escala * e^(b0 + b1 * x) sobre un lote en float; cada elemento se calcula en double
+    */
+    inline void exp_lineal(double b0, double b1, double escala, span<const float> x, span<float> y){
+        detalle::exp_lineal<float>(b0, b1, escala, x, y);
+    }
+
+    /**
+     * @brief Calcula c * x^a sobre un lote, para x > 0
+     * @param c Coeficiente de la potencia
+     * @param a Exponente
+     * @param x Valores de x
+     * @param y Salida, puede ser el mismo arreglo que x
+    */
+    inline void potencia(double c, double a, span<const double> x, span<double> y){
+        detalle::potencia<double>(c, a, x, y);
+    }
+
+    /**
+     * @brief Calcula c * x^a sobre un lote en float; cada elemento se calcula en double
+    */
+    inline void potencia(double c, double a, span<const float> x, span<float> y){
+        detalle::potencia<float>(c, a, x, y);
+    }
+
+    /**
+     * @brief Convierte una prediccion en residuos: r = y - y_estimado
+     * @param y Valores medidos
+     * @param r Entrada con los valores estimados, salida con los residuos
+    */
+    inline void restar_de(span<const double> y, span<double> r){
+        detalle::restar_de<double>(y, r);
+    }
+
+    /** @brief Convierte una prediccion en float en residuos: r = y - y_estimado */
+    inline void restar_de(span<const float> y, span<float> r){
+        detalle::restar_de<float>(y, r);
+    }
+}
+
+#endif